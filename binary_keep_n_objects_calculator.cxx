@@ -0,0 +1,141 @@
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkShapeLabelObject.h"
+#include "itkLabelMap.h"
+#include "itkBinaryKeepNObjectsCalculator.h"
+#include "itkBinaryImageToShapeLabelMapFilter.h"
+#include "itkShapeKeepNObjectsLabelMapFilter.h"
+#include "itkLabelMapToBinaryImageFilter.h"
+
+const int dim = 2;
+typedef unsigned char PixelType;
+typedef itk::Image< PixelType, dim > ImageType;
+typedef itk::ShapeLabelObject< unsigned long, dim > LabelObjectType;
+typedef itk::LabelMap< LabelObjectType > LabelMapType;
+typedef LabelObjectType::AttributeType AttributeType;
+
+// the objects kept by the calculator must be the ones kept by the label map
+// filters, including when several objects have the same value as the last one kept
+bool Compare( const ImageType * input, PixelType foreground, PixelType background,
+              bool fullyConnected, bool reverseOrdering, unsigned long numberOfObjects, AttributeType attribute )
+{
+  typedef itk::BinaryKeepNObjectsCalculator< ImageType, LabelMapType > CalculatorType;
+  CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetInput( input );
+  calculator->SetForegroundValue( foreground );
+  calculator->SetBackgroundValue( background );
+  calculator->SetFullyConnected( fullyConnected );
+  calculator->SetNumberOfObjects( numberOfObjects );
+  calculator->SetReverseOrdering( reverseOrdering );
+  calculator->SetAttribute( attribute );
+  ImageType::Pointer output = ImageType::New();
+  output->CopyInformation( input );
+  output->SetRegions( input->GetLargestPossibleRegion() );
+  output->Allocate();
+  calculator->Compute( output );
+
+  typedef itk::BinaryImageToShapeLabelMapFilter< ImageType, LabelMapType > LabelizerType;
+  LabelizerType::Pointer labelizer = LabelizerType::New();
+  labelizer->SetInput( input );
+  labelizer->SetForegroundValue( foreground );
+  labelizer->SetBackgroundValue( background );
+  labelizer->SetFullyConnected( fullyConnected );
+
+  typedef itk::ShapeKeepNObjectsLabelMapFilter< LabelMapType > KeepNObjectsType;
+  KeepNObjectsType::Pointer keep = KeepNObjectsType::New();
+  keep->SetInput( labelizer->GetOutput() );
+  keep->SetNumberOfObjects( numberOfObjects );
+  keep->SetReverseOrdering( reverseOrdering );
+  keep->SetAttribute( attribute );
+
+  typedef itk::LabelMapToBinaryImageFilter< LabelMapType, ImageType > BinarizerType;
+  BinarizerType::Pointer binarizer = BinarizerType::New();
+  binarizer->SetInput( keep->GetOutput() );
+  binarizer->SetForegroundValue( foreground );
+  binarizer->SetBackgroundValue( background );
+  binarizer->SetBackgroundImage( input );
+  binarizer->Update();
+
+  unsigned long differences = 0;
+  itk::ImageRegionConstIterator< ImageType > cit( output, output->GetLargestPossibleRegion() );
+  itk::ImageRegionConstIterator< ImageType > lit( binarizer->GetOutput(), output->GetLargestPossibleRegion() );
+  for( cit.GoToBegin(), lit.GoToBegin(); !cit.IsAtEnd(); ++cit, ++lit )
+    {
+    if( cit.Get() != lit.Get() )
+      {
+      differences++;
+      }
+    }
+
+  if( differences != 0 )
+    {
+    std::cerr << LabelObjectType::GetNameFromAttribute( attribute )
+              << ", foreground " << (int)foreground << ", background " << (int)background
+              << ", fully connected " << fullyConnected << ", reverse ordering " << reverseOrdering
+              << ", " << numberOfObjects << " objects: " << differences << " pixels differ" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+int main(int argc, char * argv[])
+{
+  if( argc != 2 )
+    {
+    std::cerr << "usage: " << argv[0] << " input" << std::endl;
+    // std::cerr << "  : " << std::endl;
+    exit(1);
+    }
+
+  // read the input image
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  reader->Update();
+
+  const PixelType foregrounds[] = { 100, 200 };
+  const PixelType backgrounds[] = { 0, 150 };
+  const unsigned long numbersOfObjects[] = { 0, 1, 3, 10, 100000 };
+
+  bool ok = true;
+  unsigned int numberOfAttributes = 0;
+  for( AttributeType attribute=LabelObjectType::SIZE; attribute<=LabelObjectType::BINARY_FLATNESS; attribute++ )
+    {
+    typedef itk::BinaryKeepNObjectsCalculator< ImageType, LabelMapType > CalculatorType;
+    if( !CalculatorType::IsAttributeSupported( attribute ) )
+      {
+      continue;
+      }
+    numberOfAttributes++;
+    for( unsigned int f=0; f<2; f++ )
+      {
+      for( unsigned int b=0; b<2; b++ )
+        {
+        for( int fullyConnected=0; fullyConnected<2; fullyConnected++ )
+          {
+          for( int reverseOrdering=0; reverseOrdering<2; reverseOrdering++ )
+            {
+            for( unsigned int n=0; n<5; n++ )
+              {
+              ok = Compare( reader->GetOutput(), foregrounds[f], backgrounds[b], fullyConnected,
+                            reverseOrdering, numbersOfObjects[n], attribute ) && ok;
+              }
+            }
+          }
+        }
+      }
+    }
+
+  // the size, border and moments groups
+  if( numberOfAttributes != 10 )
+    {
+    std::cerr << numberOfAttributes << " attributes supported by the calculator instead of 10" << std::endl;
+    ok = false;
+    }
+
+  if( !ok )
+    {
+    return 1;
+    }
+  return 0;
+}
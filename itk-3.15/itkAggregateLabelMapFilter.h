@@ -21,7 +21,16 @@
 
 namespace itk {
 /** \class AggregateLabelMapFilter
- * \brief TODO
+ * \brief Collapses all the objects of a LabelMap in a single object
+ *
+ * The attributes of the objects are merged with LabelObject::MergeAttributesFrom(),
+ * so the attributes which can be merged, like the size, the moments or the
+ * histogram, don't have to be computed again by a valuator. The attributes which
+ * can't be merged are marked as not evaluated in the label object, and evaluated
+ * again on demand when the label object can do it. * The statistics of StatisticsLabelObject can't be evaluated
+ * on demand: their getters throw an exception until they are computed again with
+ * StatisticsLabelMapFilter, which only processes the merged objects when
+ * ReuseEvaluatedAttributes is on.
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
@@ -33,7 +33,11 @@ BinaryImageToStatisticsLabelMapFilter<TInputImage, TFeatureImage, TOutputImage>
   m_ComputeFeretDiameter = false;
   m_ComputePerimeter = false;
   m_NumberOfBins = 128;
-  m_ComputeHistogram = true;
+  m_ComputeFeatureRange = true;
+  m_FeatureMinimum = NumericTraits< FeatureImagePixelType >::NonpositiveMin();
+  m_FeatureMaximum = NumericTraits< FeatureImagePixelType >::max();
+  m_ComputeHistogram = false;
+  m_ComputeMedian = false;
   this->SetNumberOfRequiredInputs(2);
 }
 
@@ -91,7 +95,12 @@ BinaryImageToStatisticsLabelMapFilter<TInputImage, TFeatureImage, TOutputImage>
   valuator->SetComputePerimeter( m_ComputePerimeter );
   valuator->SetComputeFeretDiameter( m_ComputeFeretDiameter );
   valuator->SetComputeHistogram( m_ComputeHistogram );
+  valuator->SetComputeMedian( m_ComputeMedian );
   valuator->SetNumberOfBins( m_NumberOfBins );
+  valuator->SetComputeFeatureRange( m_ComputeFeatureRange );
+  valuator->SetFeatureMinimum( m_FeatureMinimum );
+  valuator->SetFeatureMaximum( m_FeatureMaximum );
+  valuator->SetQuantiles( m_Quantiles );
   progress->RegisterInternalFilter(valuator, .5f);
 
   valuator->GraftOutput( this->GetOutput() );
@@ -113,7 +122,19 @@ BinaryImageToStatisticsLabelMapFilter<TInputImage, TFeatureImage, TOutputImage>
   os << indent << "ComputeFeretDiameter: " << m_ComputeFeretDiameter << std::endl;
   os << indent << "ComputePerimeter: " << m_ComputePerimeter << std::endl;
   os << indent << "ComputeHistogram: " << m_ComputeHistogram << std::endl;
+  os << indent << "ComputeMedian: " << m_ComputeMedian << std::endl;
   os << indent << "NumberOfBins: " << m_NumberOfBins << std::endl;
+  os << indent << "ComputeFeatureRange: " << m_ComputeFeatureRange << std::endl;
+  os << indent << "FeatureMinimum: "
+     << static_cast<typename NumericTraits<FeatureImagePixelType>::PrintType>(m_FeatureMinimum) << std::endl;
+  os << indent << "FeatureMaximum: "
+     << static_cast<typename NumericTraits<FeatureImagePixelType>::PrintType>(m_FeatureMaximum) << std::endl;
+  os << indent << "Quantiles:";
+  for( unsigned int i=0; i<m_Quantiles.size(); i++ )
+    {
+    os << " " << m_Quantiles[i];
+    }
+  os << std::endl;
 }
   
 }// end namespace itk
@@ -0,0 +1,310 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkBinaryKeepNObjectsCalculator.h,v $
+  Language:  C++
+  Date:      $Date: 2006/03/28 19:59:05 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBinaryKeepNObjectsCalculator_h
+#define __itkBinaryKeepNObjectsCalculator_h
+
+#include "itkObject.h"
+#include "itkMultiThreader.h"
+#include "itkShapeLabelObjectAttributesEvaluator.h"
+#include <vector>
+
+namespace itk {
+
+/** \class BinaryKeepNObjectsCalculator
+ * \brief Keep the N best objects of a binary image, selected during the labeling
+ *
+ * The image is labeled in a single pass, in the order of its lines, with the runs
+ * of the foreground and a union-find. The size, border and moments groups of
+ * attributes of the ShapeLabelObject are accumulated on the runs of each
+ * connected component, and merged when the components are linked, with the same
+ * sums than the ones of ShapeLabelObjectAttributesEvaluator.
+ *
+ * A component is complete as soon as the last line where it has a run can't be
+ * the neighbor of the next lines. Its attribute is then computed, and the component
+ * is compared to the N best complete components, kept in a bounded heap: either it
+ * replaces the worst one, or it is dropped. The components with the same attribute
+ * value are ordered by the raster order of their first pixel, the earliest being the
+ * best: it is the order of the labels of BinaryImageToLabelMapFilter, so the objects
+ * kept are the ones kept by ShapeKeepNObjectsLabelMapFilter. The runs of a dropped component are
+ * released immediately, and its labels are reused by the next components: no line
+ * still in the neighborhood can have one of its runs. The memory is thus bounded by
+ * the components still open and the N best ones, instead of the full label map.
+ *
+ * The output is then written in parallel: the pixels of the foreground not in a kept
+ * component are set to BackgroundValue, and the other pixels are copied from the
+ * input.
+ *
+ * Only the attributes of the size, border and moments groups can be used - see
+ * IsAttributeSupported().
+ *
+ * The input and the output must have the same largest possible region, and must
+ * be fully buffered.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa BinaryShapeKeepNObjectsImageFilter, BinaryStatisticsKeepNObjectsImageFilter,
+ * ShapeLabelObjectAttributesEvaluator
+ */
+template<class TImage, class TLabelMap>
+class ITK_EXPORT BinaryKeepNObjectsCalculator :
+    public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef BinaryKeepNObjectsCalculator Self;
+  typedef Object                       Superclass;
+  typedef SmartPointer<Self>           Pointer;
+  typedef SmartPointer<const Self>     ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TImage                           ImageType;
+  typedef typename ImageType::ConstPointer ImageConstPointer;
+  typedef typename ImageType::PixelType    PixelType;
+  typedef typename ImageType::IndexType    IndexType;
+  typedef typename ImageType::SizeType     SizeType;
+  typedef typename ImageType::RegionType   RegionType;
+
+  typedef TLabelMap                                           LabelMapType;
+  typedef typename LabelMapType::LabelObjectType              LabelObjectType;
+  typedef typename LabelObjectType::AttributeType             AttributeType;
+  typedef typename LabelObjectType::AttributeGroupMaskType    AttributeGroupMaskType;
+  typedef ShapeLabelObjectAttributesEvaluator< LabelMapType > EvaluatorType;
+  typedef typename EvaluatorType::LineAccumulatorType         LineAccumulatorType;
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(BinaryKeepNObjectsCalculator,
+               Object);
+
+  /**
+   * Set/Get the number of threads used to write the output.
+   * It defaults to the global default number of threads.
+   */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstReferenceMacro(NumberOfThreads, int);
+
+  /** Set/Get the input image */
+  itkSetConstObjectMacro(Input, ImageType);
+  itkGetConstObjectMacro(Input, ImageType);
+
+  /**
+   * Set/Get whether the connected components are defined strictly by
+   * face connectivity or by face+edge+vertex connectivity.  Default is
+   * FullyConnectedOff.
+   */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstReferenceMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /**
+   * Set/Get the value of the objects in the input image.
+   * Defaults to NumericTraits<PixelType>::max().
+   */
+  itkSetMacro(ForegroundValue, PixelType);
+  itkGetConstMacro(ForegroundValue, PixelType);
+
+  /**
+   * Set/Get the value written in the output in place of the objects removed.
+   * Defaults to NumericTraits<PixelType>::NonpositiveMin().
+   */
+  itkSetMacro(BackgroundValue, PixelType);
+  itkGetConstMacro(BackgroundValue, PixelType);
+
+  /** Set/Get the number of objects to keep */
+  itkSetMacro(NumberOfObjects, unsigned long);
+  itkGetConstMacro(NumberOfObjects, unsigned long);
+
+  /**
+   * Set/Get the ordering of the objects. By default, the ones with the
+   * highest value are kept. Turning ReverseOrdering to true keeps the objects
+   * with the smallest values.
+   */
+  itkSetMacro(ReverseOrdering, bool);
+  itkGetConstReferenceMacro(ReverseOrdering, bool);
+  itkBooleanMacro(ReverseOrdering);
+
+  /** Set/Get the attribute used to select the objects. Defaults to SIZE. */
+  itkSetMacro(Attribute, AttributeType);
+  itkGetConstMacro(Attribute, AttributeType);
+
+  /** Return true if the attribute can be computed during the labeling */
+  static bool IsAttributeSupported( const AttributeType & attribute );
+
+  /** Select the objects and write the output, which must be allocated */
+  void Compute( ImageType * output );
+
+protected:
+  BinaryKeepNObjectsCalculator();
+  ~BinaryKeepNObjectsCalculator() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Label the image and select the objects, with the given attribute accessor */
+  template <class TAttributeAccessor> void TemplatedSelectObjects();
+
+  /** Write the output in a range of lines */
+  void ThreadedWriteOutput( unsigned long beginLine, unsigned long endLine );
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+private:
+  BinaryKeepNObjectsCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** The label of the runs not labeled yet, and of the roots without component */
+  static const unsigned long NoLabel = static_cast< unsigned long >( -1 );
+
+  /** A run of the foreground in a line - the position of its first and last pixels in
+   * the dimension 0, and its label in the union-find */
+  struct RunType
+    {
+    long          First;
+    long          Last;
+    unsigned long Label;
+    };
+  typedef std::vector< RunType > LineType;
+
+  /** A run of a component - its line, and the position of its first and last pixels */
+  struct ComponentRunType
+    {
+    unsigned long Line;
+    long          First;
+    long          Last;
+    };
+  typedef std::vector< ComponentRunType > ComponentRunVectorType;
+
+  /** Sort the runs of the components by line */
+  class ComponentRunComparator
+    {
+    public:
+      bool operator()( const ComponentRunType & a, const ComponentRunType & b ) const
+        {
+        return a.Line < b.Line;
+        }
+    };
+
+  /** A complete component candidate to be kept - its attribute value, its
+   * creation order, and the root of its labels */
+  template< class TValue >
+  struct KeptComponentType
+    {
+    TValue        Value;
+    unsigned long Order;
+    unsigned long Label;
+    };
+
+  /** Sort the kept components by value, the best first, and then by creation order */
+  template< class TKept >
+  class BetterComparator
+    {
+    public:
+      BetterComparator( bool reverseOrdering ) : m_ReverseOrdering( reverseOrdering ) {}
+      bool operator()( const TKept & a, const TKept & b ) const
+        {
+        if( a.Value < b.Value )
+          {
+          return m_ReverseOrdering;
+          }
+        if( b.Value < a.Value )
+          {
+          return !m_ReverseOrdering;
+          }
+        return a.Order < b.Order;
+        }
+      bool m_ReverseOrdering;
+    };
+
+  typedef std::vector< unsigned long > LabelVectorType;
+
+  /** The data of a component, only stored for the roots of the union-find. The
+   * order is the number of components created before it - the raster order of its
+   * first pixel. */
+  struct ComponentType
+    {
+    LineAccumulatorType    Sums;
+    unsigned long          Order;
+    unsigned long          LastLine;
+    bool                   Complete;
+    ComponentRunVectorType Runs;
+    LabelVectorType        Labels;
+    };
+
+  /** Return the index of the first pixel of a line of the region */
+  IndexType GetLineIndex( unsigned long line ) const;
+
+  /** Find the runs of a line */
+  void FindRuns( unsigned long line, LineType & runs ) const;
+
+  /** Link the runs of a line to the runs of a neighbor line which are touching. The
+   * runs of the line without label yet get the label of the first run they touch. */
+  void LinkLines( LineType & line, const LineType & neighbor, long offset );
+
+  /** Create a new component, with a new or a reused label */
+  unsigned long CreateComponent();
+
+  /** Release the data of the component of a root of the union-find. The labels of
+   * a complete component are reused. */
+  void ReleaseComponent( unsigned long label );
+
+  unsigned long LookupSet( unsigned long label );
+
+  void LinkLabels( unsigned long label1, unsigned long label2 );
+
+  int           m_NumberOfThreads;
+  bool          m_FullyConnected;
+  PixelType     m_ForegroundValue;
+  PixelType     m_BackgroundValue;
+  unsigned long m_NumberOfObjects;
+  bool          m_ReverseOrdering;
+  AttributeType m_Attribute;
+
+  ImageConstPointer m_Input;
+  ImageType *       m_Output;
+  RegionType        m_Region;
+
+  typename EvaluatorType::Pointer m_Evaluator;
+  AttributeGroupMaskType          m_AttributeGroups;
+
+  /** The union-find, the component of the roots, and the labels to reuse */
+  LabelVectorType m_UnionFind;
+  LabelVectorType m_ComponentOfLabel;
+  LabelVectorType m_FreeLabels;
+
+  /** The data of the components, reused once released, and the number of
+   * components created */
+  std::vector< ComponentType > m_Components;
+  std::vector< unsigned long > m_FreeComponents;
+  unsigned long                m_NumberOfComponents;
+
+  /** The runs of the kept components, sorted by line */
+  ComponentRunVectorType m_KeptRuns;
+
+}; // end of class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBinaryKeepNObjectsCalculator.txx"
+#endif
+
+#endif
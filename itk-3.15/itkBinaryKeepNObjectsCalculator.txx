@@ -0,0 +1,626 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkBinaryKeepNObjectsCalculator.txx,v $
+  Language:  C++
+  Date:      $Date: 2005/08/23 15:09:03 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBinaryKeepNObjectsCalculator_txx
+#define __itkBinaryKeepNObjectsCalculator_txx
+
+#include "itkBinaryKeepNObjectsCalculator.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+
+namespace itk {
+
+template <class TImage, class TLabelMap>
+const unsigned long
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::NoLabel;
+
+
+template <class TImage, class TLabelMap>
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::BinaryKeepNObjectsCalculator()
+{
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_FullyConnected = false;
+  m_ForegroundValue = NumericTraits< PixelType >::max();
+  m_BackgroundValue = NumericTraits< PixelType >::NonpositiveMin();
+  m_NumberOfObjects = 0;
+  m_ReverseOrdering = false;
+  m_Attribute = LabelObjectType::SIZE;
+  m_Input = NULL;
+  m_Output = NULL;
+  m_AttributeGroups = 0;
+  m_NumberOfComponents = 0;
+}
+
+
+template <class TImage, class TLabelMap>
+bool
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::IsAttributeSupported( const AttributeType & attribute )
+{
+  switch( attribute )
+    {
+    case LabelObjectType::SIZE:
+    case LabelObjectType::PHYSICAL_SIZE:
+    case LabelObjectType::SIZE_REGION_RATIO:
+    case LabelObjectType::REGION_ELONGATION:
+    case LabelObjectType::SIZE_ON_BORDER:
+    case LabelObjectType::PHYSICAL_SIZE_ON_BORDER:
+    case LabelObjectType::BINARY_ELONGATION:
+    case LabelObjectType::EQUIVALENT_RADIUS:
+    case LabelObjectType::EQUIVALENT_PERIMETER:
+    case LabelObjectType::BINARY_FLATNESS:
+      return true;
+      break;
+    }
+  return false;
+}
+
+
+template <class TImage, class TLabelMap>
+void
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::Compute( ImageType * output )
+{
+  if( m_Input.IsNull() )
+    {
+    itkExceptionMacro( << "The input image is required." );
+    }
+
+  m_Output = output;
+  m_Region = m_Input->GetLargestPossibleRegion();
+  if( m_Region.GetNumberOfPixels() == 0 )
+    {
+    m_Output = NULL;
+    return;
+    }
+
+  // the evaluator only needs the geometry of the image
+  typename LabelMapType::Pointer labelMap = LabelMapType::New();
+  labelMap->CopyInformation( m_Input );
+  m_Evaluator = EvaluatorType::New();
+  m_Evaluator->SetImage( labelMap );
+  m_AttributeGroups = EvaluatorType::GetRequiredGroups( LabelObjectType::GetAttributeGroup( m_Attribute ) );
+
+  switch( m_Attribute )
+    {
+    case LabelObjectType::SIZE:
+      TemplatedSelectObjects< typename Functor::SizeLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::PHYSICAL_SIZE:
+      TemplatedSelectObjects< typename Functor::PhysicalSizeLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::SIZE_REGION_RATIO:
+      TemplatedSelectObjects< typename Functor::SizeRegionRatioLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::REGION_ELONGATION:
+      TemplatedSelectObjects< typename Functor::RegionElongationLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::SIZE_ON_BORDER:
+      TemplatedSelectObjects< typename Functor::SizeOnBorderLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::PHYSICAL_SIZE_ON_BORDER:
+      TemplatedSelectObjects< typename Functor::PhysicalSizeOnBorderLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::BINARY_ELONGATION:
+      TemplatedSelectObjects< typename Functor::BinaryElongationLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::EQUIVALENT_RADIUS:
+      TemplatedSelectObjects< typename Functor::EquivalentRadiusLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::EQUIVALENT_PERIMETER:
+      TemplatedSelectObjects< typename Functor::EquivalentPerimeterLabelObjectAccessor< LabelObjectType > >();
+      break;
+    case LabelObjectType::BINARY_FLATNESS:
+      TemplatedSelectObjects< typename Functor::BinaryFlatnessLabelObjectAccessor< LabelObjectType > >();
+      break;
+    default:
+      m_Output = NULL;
+      m_Evaluator = NULL;
+      itkExceptionMacro(<< "The attribute " << LabelObjectType::GetNameFromAttribute( m_Attribute )
+                        << " can't be computed during the labeling.");
+      break;
+    }
+  m_Evaluator = NULL;
+
+  // write the output
+  const unsigned long numberOfLines = m_Region.GetNumberOfPixels() / m_Region.GetSize()[0];
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( std::max( 1, (int)std::min( (unsigned long)m_NumberOfThreads, numberOfLines ) ) );
+  threader->SetSingleMethod( this->ThreaderCallback, this );
+  threader->SingleMethodExecute();
+
+  m_KeptRuns.clear();
+  m_Output = NULL;
+}
+
+
+template <class TImage, class TLabelMap>
+template <class TAttributeAccessor>
+void
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::TemplatedSelectObjects()
+{
+  typedef typename TAttributeAccessor::AttributeValueType AttributeValueType;
+  typedef KeptComponentType< AttributeValueType >         KeptType;
+  typedef std::vector< KeptType >                         KeptVectorType;
+  TAttributeAccessor accessor;
+  BetterComparator< KeptType > better( m_ReverseOrdering );
+
+  // the N best complete components, in a heap with the worst one on top
+  KeptVectorType kept;
+  kept.reserve( m_NumberOfObjects );
+
+  // the label object used to compute the attribute of the complete components
+  typename LabelObjectType::Pointer labelObject = LabelObjectType::New();
+  m_NumberOfComponents = 0;
+
+  // the offsets to the "previous" neighbor lines, in the dimensions 1 to ImageDimension-1:
+  // the highest non zero dimension of the offset is -1. With the face connectivity, only
+  // one dimension can be non zero. The window is the greatest distance between a line
+  // and its neighbors in the order of the lines.
+  const SizeType & size = m_Region.GetSize();
+  const unsigned long numberOfLines = m_Region.GetNumberOfPixels() / size[0];
+  typedef std::vector< long > LineOffsetType;
+  std::vector< LineOffsetType > neighborOffsets;
+  unsigned long window = 0;
+  LineOffsetType offset( ImageDimension, -1 );
+  offset[0] = 0;
+  bool done = ( ImageDimension < 2 );
+  while( !done )
+    {
+    int highest = 0;
+    int nonZero = 0;
+    long distance = 0;
+    long stride = 1;
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      if( offset[i] != 0 )
+        {
+        highest = i;
+        nonZero++;
+        }
+      distance -= offset[i] * stride;
+      stride *= size[i];
+      }
+    if( highest > 0 && offset[highest] == -1 && ( m_FullyConnected || nonZero == 1 ) )
+      {
+      neighborOffsets.push_back( offset );
+      window = std::max( window, (unsigned long)distance );
+      }
+    // next offset
+    done = true;
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      if( offset[i] < 1 )
+        {
+        offset[i]++;
+        done = false;
+        break;
+        }
+      offset[i] = -1;
+      }
+    }
+
+  // only the lines of the window are kept, in a circular buffer
+  std::vector< LineType > lines( window + 1 );
+
+  // label the lines one by one. Once the lines of the window are linked to the
+  // line l, the components of the line l-window can't grow anymore: they are
+  // complete if they have no run in the next lines.
+  const long dim0Offset = m_FullyConnected ? 1 : 0;
+  LineOffsetType position( ImageDimension, 0 );
+  for( unsigned long l=0; l<numberOfLines+window; l++ )
+    {
+    LineType & line = lines[ l % ( window + 1 ) ];
+    line.clear();
+    if( l < numberOfLines )
+      {
+      this->FindRuns( l, line );
+      if( !line.empty() )
+        {
+        for( typename std::vector< LineOffsetType >::const_iterator oit = neighborOffsets.begin();
+          oit != neighborOffsets.end();
+          oit++ )
+          {
+          long neighbor = 0;
+          long stride = 1;
+          bool inside = true;
+          for( int i=1; i<ImageDimension; i++ )
+            {
+            const long p = position[i] + (*oit)[i];
+            inside = inside && p >= 0 && p < (long)size[i];
+            neighbor += p * stride;
+            stride *= size[i];
+            }
+          if( inside && !lines[ neighbor % ( window + 1 ) ].empty() )
+            {
+            this->LinkLines( line, lines[ neighbor % ( window + 1 ) ], dim0Offset );
+            }
+          }
+
+        // the runs not touching a previous run start a new component, and the runs
+        // are accumulated in the component of their root
+        IndexType idx = this->GetLineIndex( l );
+        for( typename LineType::iterator it = line.begin(); it != line.end(); it++ )
+          {
+          if( it->Label == NoLabel )
+            {
+            it->Label = this->CreateComponent();
+            }
+          ComponentType & component = m_Components[ m_ComponentOfLabel[ this->LookupSet( it->Label ) ] ];
+          idx[0] = it->First;
+          m_Evaluator->AccumulateLine( component.Sums, idx, it->Last - it->First + 1 );
+          component.LastLine = l;
+          ComponentRunType run;
+          run.Line = l;
+          run.First = it->First;
+          run.Last = it->Last;
+          component.Runs.push_back( run );
+          }
+        }
+      // next line
+      for( int i=1; i<ImageDimension; i++ )
+        {
+        position[i]++;
+        if( position[i] < (long)size[i] )
+          {
+          break;
+          }
+        position[i] = 0;
+        }
+      }
+
+    if( l < window )
+      {
+      continue;
+      }
+
+    // select the components completed with the line l-window - it is the next
+    // line in the circular buffer
+    const unsigned long completedLine = l - window;
+    const LineType & completed = lines[ ( l + 1 ) % ( window + 1 ) ];
+    for( typename LineType::const_iterator it = completed.begin(); it != completed.end(); it++ )
+      {
+      const unsigned long root = this->LookupSet( it->Label );
+      if( m_ComponentOfLabel[root] == NoLabel )
+        {
+        continue;
+        }
+      ComponentType & component = m_Components[ m_ComponentOfLabel[root] ];
+      if( component.Complete || component.LastLine != completedLine )
+        {
+        continue;
+        }
+      component.Complete = true;
+
+      if( m_NumberOfObjects == 0 )
+        {
+        this->ReleaseComponent( root );
+        continue;
+        }
+      m_Evaluator->SetAccumulatedAttributes( labelObject, component.Sums );
+      KeptType candidate;
+      candidate.Value = accessor( labelObject );
+      candidate.Order = component.Order;
+      candidate.Label = root;
+      if( kept.size() < m_NumberOfObjects )
+        {
+        kept.push_back( candidate );
+        std::push_heap( kept.begin(), kept.end(), better );
+        }
+      else if( better( candidate, kept.front() ) )
+        {
+        // the worst kept component is replaced
+        std::pop_heap( kept.begin(), kept.end(), better );
+        this->ReleaseComponent( kept.back().Label );
+        kept.back() = candidate;
+        std::push_heap( kept.begin(), kept.end(), better );
+        }
+      else
+        {
+        this->ReleaseComponent( root );
+        }
+      }
+    }
+
+  // keep the runs of the selected components, sorted by line for the threads
+  m_KeptRuns.clear();
+  for( typename KeptVectorType::const_iterator it = kept.begin(); it != kept.end(); it++ )
+    {
+    const ComponentRunVectorType & runs = m_Components[ m_ComponentOfLabel[ it->Label ] ].Runs;
+    m_KeptRuns.insert( m_KeptRuns.end(), runs.begin(), runs.end() );
+    }
+  std::sort( m_KeptRuns.begin(), m_KeptRuns.end(), ComponentRunComparator() );
+
+  m_UnionFind.clear();
+  m_ComponentOfLabel.clear();
+  m_FreeLabels.clear();
+  m_Components.clear();
+  m_FreeComponents.clear();
+}
+
+
+template <class TImage, class TLabelMap>
+typename BinaryKeepNObjectsCalculator<TImage, TLabelMap>::IndexType
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::GetLineIndex( unsigned long line ) const
+{
+  IndexType idx = m_Region.GetIndex();
+  for( int i=1; i<ImageDimension; i++ )
+    {
+    idx[i] += line % m_Region.GetSize()[i];
+    line /= m_Region.GetSize()[i];
+    }
+  return idx;
+}
+
+
+template <class TImage, class TLabelMap>
+void
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::FindRuns( unsigned long line, LineType & runs ) const
+{
+  const long length = m_Region.GetSize()[0];
+  const IndexType idx = this->GetLineIndex( line );
+  const PixelType * in = m_Input->GetBufferPointer() + m_Input->ComputeOffset( idx );
+
+  long i = 0;
+  while( i < length )
+    {
+    if( in[i] != m_ForegroundValue )
+      {
+      i++;
+      continue;
+      }
+    RunType run;
+    run.First = idx[0] + i;
+    run.Label = NoLabel;
+    while( i < length && in[i] == m_ForegroundValue )
+      {
+      i++;
+      }
+    run.Last = idx[0] + i - 1;
+    runs.push_back( run );
+    }
+}
+
+
+template <class TImage, class TLabelMap>
+void
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::ThreadedWriteOutput( unsigned long beginLine, unsigned long endLine )
+{
+  const long length = m_Region.GetSize()[0];
+
+  // the first kept run of the lines of the thread
+  ComponentRunType first;
+  first.Line = beginLine;
+  typename ComponentRunVectorType::const_iterator it =
+    std::lower_bound( m_KeptRuns.begin(), m_KeptRuns.end(), first, ComponentRunComparator() );
+
+  for( unsigned long l=beginLine; l<endLine; l++ )
+    {
+    const IndexType idx = this->GetLineIndex( l );
+    const PixelType * in = m_Input->GetBufferPointer() + m_Input->ComputeOffset( idx );
+    PixelType * out = m_Output->GetBufferPointer() + m_Output->ComputeOffset( idx );
+
+    // remove all the objects, and put back the kept ones
+    for( long i=0; i<length; i++ )
+      {
+      out[i] = in[i] == m_ForegroundValue ? m_BackgroundValue : in[i];
+      }
+    for( ; it != m_KeptRuns.end() && it->Line == l; it++ )
+      {
+      std::fill( out + ( it->First - idx[0] ), out + ( it->Last - idx[0] + 1 ), m_ForegroundValue );
+      }
+    }
+}
+
+
+template <class TImage, class TLabelMap>
+void
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::LinkLines( LineType & line, const LineType & neighbor, long offset )
+{
+  // both lines are sorted - move the run which ends first
+  typename LineType::iterator lit = line.begin();
+  typename LineType::const_iterator nit = neighbor.begin();
+  while( lit != line.end() && nit != neighbor.end() )
+    {
+    if( nit->First - offset <= lit->Last && nit->Last + offset >= lit->First )
+      {
+      if( lit->Label == NoLabel )
+        {
+        lit->Label = nit->Label;
+        }
+      else
+        {
+        this->LinkLabels( lit->Label, nit->Label );
+        }
+      }
+    if( lit->Last < nit->Last )
+      {
+      lit++;
+      }
+    else
+      {
+      nit++;
+      }
+    }
+}
+
+
+template <class TImage, class TLabelMap>
+unsigned long
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::CreateComponent()
+{
+  unsigned long slot;
+  if( m_FreeComponents.empty() )
+    {
+    slot = m_Components.size();
+    m_Components.push_back( ComponentType() );
+    }
+  else
+    {
+    slot = m_FreeComponents.back();
+    m_FreeComponents.pop_back();
+    }
+  ComponentType & component = m_Components[slot];
+  m_Evaluator->InitializeLineAccumulator( component.Sums, m_AttributeGroups );
+  component.Order = m_NumberOfComponents++;
+  component.LastLine = 0;
+  component.Complete = false;
+
+  unsigned long label;
+  if( m_FreeLabels.empty() )
+    {
+    label = m_UnionFind.size();
+    m_UnionFind.push_back( label );
+    m_ComponentOfLabel.push_back( slot );
+    }
+  else
+    {
+    label = m_FreeLabels.back();
+    m_FreeLabels.pop_back();
+    m_UnionFind[label] = label;
+    m_ComponentOfLabel[label] = slot;
+    }
+  component.Labels.push_back( label );
+  return label;
+}
+
+
+template <class TImage, class TLabelMap>
+void
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::ReleaseComponent( unsigned long label )
+{
+  const unsigned long slot = m_ComponentOfLabel[label];
+  ComponentType & component = m_Components[slot];
+  if( component.Complete )
+    {
+    // the runs of a complete component are all in lines out of the window, so
+    // its labels can be reused. The union-find is only updated when a label is
+    // reused, so the runs of the completed line can still be looked up.
+    m_FreeLabels.insert( m_FreeLabels.end(), component.Labels.begin(), component.Labels.end() );
+    }
+  // swap, to really free the memory of the runs and of the labels
+  ComponentRunVectorType().swap( component.Runs );
+  LabelVectorType().swap( component.Labels );
+  m_FreeComponents.push_back( slot );
+  m_ComponentOfLabel[label] = NoLabel;
+}
+
+
+template <class TImage, class TLabelMap>
+unsigned long
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::LookupSet( unsigned long label )
+{
+  // find the root, and then compress the path
+  unsigned long root = label;
+  while( m_UnionFind[root] != root )
+    {
+    root = m_UnionFind[root];
+    }
+  while( m_UnionFind[label] != root )
+    {
+    const unsigned long next = m_UnionFind[label];
+    m_UnionFind[label] = root;
+    label = next;
+    }
+  return root;
+}
+
+
+template <class TImage, class TLabelMap>
+void
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::LinkLabels( unsigned long label1, unsigned long label2 )
+{
+  const unsigned long root1 = this->LookupSet( label1 );
+  const unsigned long root2 = this->LookupSet( label2 );
+  if( root1 == root2 )
+    {
+    return;
+    }
+  // the data of the component follows the root - the runs of the smallest
+  // component are appended to the ones of the largest
+  const unsigned long root = std::min( root1, root2 );
+  const unsigned long child = std::max( root1, root2 );
+  m_UnionFind[child] = root;
+  ComponentType & component = m_Components[ m_ComponentOfLabel[root] ];
+  ComponentType & childComponent = m_Components[ m_ComponentOfLabel[child] ];
+  component.Sums.Merge( childComponent.Sums );
+  component.Order = std::min( component.Order, childComponent.Order );
+  component.LastLine = std::max( component.LastLine, childComponent.LastLine );
+  if( component.Runs.size() < childComponent.Runs.size() )
+    {
+    component.Runs.swap( childComponent.Runs );
+    }
+  component.Runs.insert( component.Runs.end(), childComponent.Runs.begin(), childComponent.Runs.end() );
+  if( component.Labels.size() < childComponent.Labels.size() )
+    {
+    component.Labels.swap( childComponent.Labels );
+    }
+  component.Labels.insert( component.Labels.end(), childComponent.Labels.begin(), childComponent.Labels.end() );
+  this->ReleaseComponent( child );
+}
+
+
+template <class TImage, class TLabelMap>
+ITK_THREAD_RETURN_TYPE
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::ThreaderCallback( void * arg )
+{
+  int threadId = ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  int threadCount = ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+  Self * self = (Self *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  // split the lines in contiguous parts of the same size
+  const unsigned long numberOfLines = self->m_Region.GetNumberOfPixels() / self->m_Region.GetSize()[0];
+  const unsigned long begin = numberOfLines * threadId / threadCount;
+  const unsigned long end = numberOfLines * ( threadId + 1 ) / threadCount;
+  self->ThreadedWriteOutput( begin, end );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TImage, class TLabelMap>
+void
+BinaryKeepNObjectsCalculator<TImage, TLabelMap>
+::PrintSelf(std::ostream &os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfThreads: "  << m_NumberOfThreads << std::endl;
+  os << indent << "FullyConnected: "  << m_FullyConnected << std::endl;
+  os << indent << "ForegroundValue: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>(m_ForegroundValue) << std::endl;
+  os << indent << "BackgroundValue: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "NumberOfObjects: "  << m_NumberOfObjects << std::endl;
+  os << indent << "ReverseOrdering: "  << m_ReverseOrdering << std::endl;
+  os << indent << "Attribute: "  << LabelObjectType::GetNameFromAttribute(m_Attribute) << " (" << m_Attribute << ")" << std::endl;
+  os << indent << "Input: "  << m_Input.GetPointer() << std::endl;
+}
+
+}// end namespace itk
+#endif
@@ -24,6 +24,7 @@
 #include "itkShapeLabelMapFilter.h"
 #include "itkShapeKeepNObjectsLabelMapFilter.h"
 #include "itkLabelMapToBinaryImageFilter.h"
+#include "itkBinaryKeepNObjectsCalculator.h"
 
 
 namespace itk {
@@ -35,6 +36,10 @@ namespace itk {
  * with the highest (or lowest) attribute value. The attributes are the ones
  * of the ShapeLabelObject.
  *
+ * When the attribute can be computed during the labeling - see
+ * BinaryKeepNObjectsCalculator::IsAttributeSupported() - the objects are selected
+ * while the image is labeled, and the label map is never produced.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * \sa ShapeLabelObject, LabelShapeKeepNObjectsImageFilter, BinaryStatisticsKeepNObjectsImageFilter
@@ -78,6 +83,7 @@ public:
   typedef typename LabelObjectType::AttributeType                                    AttributeType;
   typedef typename itk::ShapeKeepNObjectsLabelMapFilter< LabelMapType >              KeepNObjectsType;
   typedef typename itk::LabelMapToBinaryImageFilter< LabelMapType, OutputImageType > BinarizerType;
+  typedef typename itk::BinaryKeepNObjectsCalculator< InputImageType, LabelMapType > CalculatorType;
 
   /** Standard New method. */
   itkNewMacro(Self);  
@@ -19,6 +19,7 @@
 
 #include "itkBinaryShapeKeepNObjectsImageFilter.h"
 #include "itkProgressAccumulator.h"
+#include "itkProgressReporter.h"
 
 
 namespace itk {
@@ -66,13 +67,32 @@ void
 BinaryShapeKeepNObjectsImageFilter<TInputImage>
 ::GenerateData()
 {
+  // Allocate the output
+  this->AllocateOutputs();
+
+  // the attributes of the size, border and moments groups are computed during
+  // the labeling: only the N best objects are kept in memory
+  if( CalculatorType::IsAttributeSupported( m_Attribute ) )
+    {
+    ProgressReporter progress( this, 0, 1 );
+    typename CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetInput( this->GetInput() );
+    calculator->SetForegroundValue( m_ForegroundValue );
+    calculator->SetBackgroundValue( m_BackgroundValue );
+    calculator->SetFullyConnected( m_FullyConnected );
+    calculator->SetNumberOfObjects( m_NumberOfObjects );
+    calculator->SetReverseOrdering( m_ReverseOrdering );
+    calculator->SetAttribute( m_Attribute );
+    calculator->SetNumberOfThreads( this->GetNumberOfThreads() );
+    calculator->Compute( this->GetOutput() );
+    progress.CompletedPixel();
+    return;
+    }
+
   // Create a process accumulator for tracking the progress of this minipipeline
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
   progress->SetMiniPipelineFilter(this);
 
-  // Allocate the output
-  this->AllocateOutputs();
-  
   typename LabelizerType::Pointer labelizer = LabelizerType::New();
   labelizer->SetInput( this->GetInput() );
   labelizer->SetForegroundValue( m_ForegroundValue );
@@ -92,6 +112,8 @@ BinaryShapeKeepNObjectsImageFilter<TInputImage>
     {
     valuator->SetComputeFeretDiameter( true );
     }
+  // only compute the group of attributes which contains the attribute
+  valuator->SetComputedAttributes( LabelObjectType::GetAttributeGroup( m_Attribute ) );
   progress->RegisterInternalFilter(valuator, .3f);
   
   typename KeepNObjectsType::Pointer opening = KeepNObjectsType::New();
@@ -100,6 +122,8 @@ BinaryShapeKeepNObjectsImageFilter<TInputImage>
   opening->SetReverseOrdering( m_ReverseOrdering );
   opening->SetAttribute( m_Attribute );
   opening->SetNumberOfThreads( this->GetNumberOfThreads() );
+  // only the kept objects are used
+  opening->SetStoreRemovedObjects( false );
   progress->RegisterInternalFilter(opening, .2f);
   
   typename BinarizerType::Pointer binarizer = BinarizerType::New();
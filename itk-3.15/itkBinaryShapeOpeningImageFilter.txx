@@ -92,6 +92,8 @@ BinaryShapeOpeningImageFilter<TInputImage>
     {
     valuator->SetComputeFeretDiameter( true );
     }
+  // only compute the group of attributes which contains the attribute
+  valuator->SetComputedAttributes( LabelObjectType::GetAttributeGroup( m_Attribute ) );
   progress->RegisterInternalFilter(valuator, .3f);
   
   typename OpeningType::Pointer opening = OpeningType::New();
@@ -100,6 +102,8 @@ BinaryShapeOpeningImageFilter<TInputImage>
   opening->SetReverseOrdering( m_ReverseOrdering );
   opening->SetAttribute( m_Attribute );
   opening->SetNumberOfThreads( this->GetNumberOfThreads() );
+  // only the kept objects are used
+  opening->SetStoreRemovedObjects( false );
   progress->RegisterInternalFilter(opening, .2f);
   
   typename BinarizerType::Pointer binarizer = BinarizerType::New();
@@ -95,6 +95,8 @@ BinaryStatisticsOpeningImageFilter<TInputImage, TFeatureImage>
     {
     valuator->SetComputeFeretDiameter( true );
     }
+  // only compute the group of attributes which contains the attribute
+  valuator->SetComputedAttributes( LabelObjectType::GetAttributeGroup( m_Attribute ) );
   progress->RegisterInternalFilter(valuator, .3f);
   
   typename OpeningType::Pointer opening = OpeningType::New();
@@ -103,6 +105,8 @@ BinaryStatisticsOpeningImageFilter<TInputImage, TFeatureImage>
   opening->SetReverseOrdering( m_ReverseOrdering );
   opening->SetAttribute( m_Attribute );
   opening->SetNumberOfThreads( this->GetNumberOfThreads() );
+  // only the kept objects are used
+  opening->SetStoreRemovedObjects( false );
   progress->RegisterInternalFilter(opening, .2f);
   
   typename BinarizerType::Pointer binarizer = BinarizerType::New();
@@ -23,7 +23,17 @@
 
 namespace itk {
 /** \class ChangeLabelLabelMapFilter
- * \brief TODO
+ * \brief Changes the labels of the objects of a LabelMap
+ *
+ * The objects which get the same label are merged. Their attributes are merged
+ * with LabelObject::MergeAttributesFrom(), so the attributes which can be merged,
+ * like the size, the moments or the histogram, don't have to be computed again
+ * by a valuator. The attributes which can't be merged are marked as not evaluated
+ * in the label objects, and evaluated again on demand when the label objects can
+ * do it. * The statistics of StatisticsLabelObject can't be evaluated
+ * on demand: their getters throw an exception until they are computed again with
+ * StatisticsLabelMapFilter, which only processes the merged objects when
+ * ReuseEvaluatedAttributes is on.
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
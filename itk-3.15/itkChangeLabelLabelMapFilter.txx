@@ -97,6 +97,10 @@ ChangeLabelLabelMapFilter<TImage>
         }
       // be sure to have the lines well organized
       mainLo->Optimize();
+      // the objects of a label map are disjoint, so the attributes which can be
+      // merged don't have to be computed again. The other ones are marked as
+      // not evaluated by the label object.
+      mainLo->MergeAttributesFrom( lo );
       }
     else
       {
@@ -96,6 +96,8 @@ public:
   typedef typename InputImageType::IndexType       IndexType;
   typedef typename InputImageType::RegionType      RegionType;
 
+  typedef typename InputImageType::LabelObjectVectorType LabelObjectVectorType;
+
   typedef TInputImage TOutputImage;
   
   /** ImageDimension constants */
@@ -162,6 +164,23 @@ protected:
     return this->GetOutput();
     }
 
+  /**
+   * Keep only the given label objects in the output, which must be sorted by label.
+   * The label object container is rebuilt once, instead of erasing the other objects
+   * one by one. If removedOutput is not NULL, the other objects are moved to it.
+   */
+  void KeepLabelObjects( const LabelObjectVectorType & keptObjects, OutputImageType * removedOutput );
+
+  /** Sort the label objects by label, as expected by KeepLabelObjects() */
+  class LabelComparator
+    {
+    public:
+      bool operator()( const typename LabelObjectType::Pointer & a, const typename LabelObjectType::Pointer & b ) const
+        {
+        return a->GetLabel() < b->GetLabel();
+        }
+    };
+
 private:
   InPlaceLabelMapFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
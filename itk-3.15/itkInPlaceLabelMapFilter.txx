@@ -150,6 +150,48 @@ InPlaceLabelMapFilter<TInputImage>
     }
 }
 
+template<class TInputImage>
+void
+InPlaceLabelMapFilter<TInputImage>
+::KeepLabelObjects( const LabelObjectVectorType & keptObjects, OutputImageType * removedOutput )
+{
+  typedef typename OutputImageType::LabelObjectContainerType LabelObjectContainerType;
+  LabelObjectContainerType & labelObjectContainer = this->GetOutput()->GetLabelObjectContainer();
+
+  // the objects are sorted by label: they are inserted at the end of the new
+  // container, in constant time
+  LabelObjectContainerType keptContainer;
+  for( typename LabelObjectVectorType::const_iterator it = keptObjects.begin();
+    it != keptObjects.end();
+    it++ )
+    {
+    keptContainer.insert( keptContainer.end(), typename LabelObjectContainerType::value_type( (*it)->GetLabel(), *it ) );
+    }
+
+  if( removedOutput != NULL )
+    {
+    // the removed objects are the ones of the old container not in the kept ones -
+    // both are sorted by label
+    LabelObjectContainerType & removedContainer = removedOutput->GetLabelObjectContainer();
+    typename LabelObjectContainerType::const_iterator kit = keptContainer.begin();
+    for( typename LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+      it != labelObjectContainer.end();
+      it++ )
+      {
+      while( kit != keptContainer.end() && kit->first < it->first )
+        {
+        kit++;
+        }
+      if( kit == keptContainer.end() || kit->first != it->first )
+        {
+        removedContainer.insert( removedContainer.end(), *it );
+        }
+      }
+    }
+
+  labelObjectContainer.swap( keptContainer );
+}
+
 
 } // end namespace itk
 
@@ -142,23 +142,52 @@ public:
     }
 
   /**
-   * Set/Get whether the histogram should be attached to the label object or not.
-   * This option defaults to `true`, but because the histogram may take a lot of memory
-   * compared to the other attributes, this option is useful to reduce the memory usage
-   * when the histogram is not required.
+   * Set/Get whether the histogram should be computed and attached to the label
+   * object or not. This option defaults to `false`, because the histogram may take
+   * a lot of memory compared to the other attributes. The median doesn't depend
+   * on the histogram.
    */
   itkSetMacro(ComputeHistogram, bool);
   itkGetConstReferenceMacro(ComputeHistogram, bool);
   itkBooleanMacro(ComputeHistogram);
 
   /**
-   * Set/Get the number of bins in the histogram. Note that the histogram is used
-   * to compute the median value, and that this option may have an effect on the
-   * value of the median.
+   * Set/Get the number of bins in the histogram.
    */
   itkSetMacro(NumberOfBins, unsigned int);
   itkGetConstReferenceMacro(NumberOfBins, unsigned int);
 
+  /**
+   * Set/Get whether the range of the histograms is computed from the feature image,
+   * or given with SetFeatureMinimum() and SetFeatureMaximum().
+   * See StatisticsLabelMapFilter::SetComputeFeatureRange().
+   */
+  itkSetMacro(ComputeFeatureRange, bool);
+  itkGetConstReferenceMacro(ComputeFeatureRange, bool);
+  itkBooleanMacro(ComputeFeatureRange);
+
+  itkSetMacro(FeatureMinimum, FeatureImagePixelType);
+  itkGetConstReferenceMacro(FeatureMinimum, FeatureImagePixelType);
+  itkSetMacro(FeatureMaximum, FeatureImagePixelType);
+  itkGetConstReferenceMacro(FeatureMaximum, FeatureImagePixelType);
+
+  /**
+   * Set/Get whether the median should be computed or not.
+   * See StatisticsLabelMapFilter::SetComputeMedian().
+   */
+  itkSetMacro(ComputeMedian, bool);
+  itkGetConstReferenceMacro(ComputeMedian, bool);
+  itkBooleanMacro(ComputeMedian);
+
+  typedef typename LabelObjectType::QuantilesType QuantilesType;
+
+  /**
+   * Set/Get the probabilities of the quantiles to compute in addition to the median.
+   * See StatisticsLabelMapFilter::SetQuantiles().
+   */
+  itkSetMacro(Quantiles, QuantilesType);
+  itkGetConstReferenceMacro(Quantiles, QuantilesType);
+
 
 protected:
   LabelImageToStatisticsLabelMapFilter();
@@ -186,7 +215,12 @@ private:
   bool                  m_ComputeFeretDiameter;
   bool                  m_ComputePerimeter;
   unsigned int          m_NumberOfBins;
+  bool                  m_ComputeFeatureRange;
+  FeatureImagePixelType m_FeatureMinimum;
+  FeatureImagePixelType m_FeatureMaximum;
   bool                  m_ComputeHistogram;
+  bool                  m_ComputeMedian;
+  QuantilesType         m_Quantiles;
 
 }; // end of class
 
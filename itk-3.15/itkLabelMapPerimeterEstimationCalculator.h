@@ -0,0 +1,164 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkLabelMapPerimeterEstimationCalculator.h,v $
+  Language:  C++
+  Date:      $Date: 2005/01/21 20:13:31 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even 
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR 
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkLabelMapPerimeterEstimationCalculator_h
+#define __itkLabelMapPerimeterEstimationCalculator_h
+
+#include "itkObject.h"
+#include "itkImage.h"
+#include "itkLabelPerimeterEstimationCalculator.h"
+#include "itkLabelMapUtilities.h"
+#include <map>
+#include <vector>
+
+namespace itk {
+
+/** \class LabelMapPerimeterEstimationCalculator
+ * \brief Estimate the perimeter of the objects of a label map, directly from their lines
+ *
+ * This calculator gives the same estimation of the perimeter than
+ * LabelPerimeterEstimationCalculator, but works on a LabelMap instead of
+ * a label image. The configurations of the 2x2 (2x2x2 in 3D) neighborhoods are
+ * counted from the lines of each object and of its neighbor lines, only where the
+ * neighborhoods contain some pixels of the object: the background is never scanned,
+ * and the computation time is proportional to the number of lines on the contour of
+ * the objects rather than to the size of the image.
+ *
+ * The perimeter of a single object can be computed with ComputePerimeter(), once
+ * Initialize() has been called. This method is thread safe, and can be called from the
+ * ThreadedGenerateData() method of a LabelMapFilter.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa LabelPerimeterEstimationCalculator
+ */
+template<class TInputImage>
+class ITK_EXPORT LabelMapPerimeterEstimationCalculator : 
+    public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef LabelMapPerimeterEstimationCalculator Self;
+  typedef Object                                Superclass;
+  typedef SmartPointer<Self>                    Pointer;
+  typedef SmartPointer<const Self>              ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage                             InputImageType;
+  typedef typename InputImageType::Pointer        InputImagePointer;
+  typedef typename InputImageType::ConstPointer   InputImageConstPointer;
+  typedef typename InputImageType::PixelType      InputImagePixelType;
+  typedef typename InputImageType::LabelObjectType LabelObjectType;
+  
+  typedef typename InputImageType::RegionType     RegionType;
+  typedef typename InputImageType::SizeType       SizeType;
+  typedef typename InputImageType::IndexType      IndexType;
+  typedef typename InputImageType::SpacingType    SpacingType;
+  
+  typedef typename std::map< InputImagePixelType, double > PerimetersType;
+
+  typedef LabelMapUtilities::LabelObjectRowIndex< LabelObjectType > RowIndexType;
+  
+  /** ImageDimension constants */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+
+  /** The image calculator - used to share the contributions of the configurations */
+  typedef LabelPerimeterEstimationCalculator< Image< InputImagePixelType, ImageDimension > > ImageCalculatorType;
+  typedef typename ImageCalculatorType::ContributionsType ContributionsType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);  
+
+  /** Runtime information support. */
+  itkTypeMacro(LabelMapPerimeterEstimationCalculator, 
+               Object);
+  
+  void SetImage( const InputImageType * img )
+    {
+    m_Image = img;
+    }
+
+  const InputImageType * GetImage() const
+    {
+    return m_Image;
+    }
+
+  /** Compute the contributions of the configurations for the spacing of the image.
+   * It must be called before ComputePerimeter(). */
+  void Initialize();
+
+  /** Compute the perimeter of all the objects of the image */
+  void Compute();
+
+  /** Compute the perimeter of a single object. Return false if the object has no
+   * 2x2(x2) neighborhood fully in the image - the perimeter can't be estimated in
+   * that case. */
+  bool ComputePerimeter( const LabelObjectType * labelObject, double & perimeter ) const;
+
+  /** Same as above, but reuse the lines of the object already indexed by row */
+  bool ComputePerimeter( const RowIndexType & rowIndex, double & perimeter ) const;
+  
+  const PerimetersType & GetPerimeters() const
+    {
+    return m_Perimeters;
+    }
+    
+  const double & GetPerimeter( const InputImagePixelType & label ) const
+    {
+    if( m_Perimeters.find( label ) != m_Perimeters.end() )
+      {
+      return m_Perimeters.find( label )->second;
+      }
+    itkExceptionMacro( << "Unknown label: " << static_cast<typename NumericTraits<InputImagePixelType>::PrintType>(label) );
+    }
+
+  bool HasLabel( const InputImagePixelType & label ) const
+    {
+    if( m_Perimeters.find( label ) != m_Perimeters.end() )
+      {
+      return true;
+      }
+    return false;
+    }
+
+protected:
+  LabelMapPerimeterEstimationCalculator();
+  ~LabelMapPerimeterEstimationCalculator() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Return true if x is in one of the sorted and disjoint runs */
+  static bool IsInRuns( const typename RowIndexType::RunVectorType * runs, long x );
+
+private:
+  LabelMapPerimeterEstimationCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  const InputImageType * m_Image;
+  
+  PerimetersType m_Perimeters;
+
+  ContributionsType m_Contributions;
+
+}; // end of class
+
+} // end namespace itk
+  
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLabelMapPerimeterEstimationCalculator.txx"
+#endif
+
+#endif
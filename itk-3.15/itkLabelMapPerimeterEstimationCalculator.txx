@@ -0,0 +1,244 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkLabelMapPerimeterEstimationCalculator.txx,v $
+  Language:  C++
+  Date:      $Date: 2004/12/21 22:47:30 $
+  Version:   $Revision: 1.12 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+    This software is distributed WITHOUT ANY WARRANTY; without even 
+    the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR 
+    PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkLabelMapPerimeterEstimationCalculator_txx
+#define __itkLabelMapPerimeterEstimationCalculator_txx
+
+#include "itkLabelMapPerimeterEstimationCalculator.h"
+#include <set>
+#include <algorithm>
+
+namespace itk {
+
+template <class TInputImage>
+LabelMapPerimeterEstimationCalculator<TInputImage>
+::LabelMapPerimeterEstimationCalculator()
+{
+  m_Image = NULL;
+}
+
+
+template<class TInputImage>
+void
+LabelMapPerimeterEstimationCalculator<TInputImage>
+::Initialize()
+{
+  ImageCalculatorType::ComputeContributions( this->GetImage()->GetSpacing(), m_Contributions );
+}
+
+
+template<class TInputImage>
+void
+LabelMapPerimeterEstimationCalculator<TInputImage>
+::Compute()
+{
+  this->Initialize();
+
+  m_Perimeters.clear();
+
+  typedef typename InputImageType::LabelObjectContainerType LabelObjectContainerType;
+  const LabelObjectContainerType & labelObjects = this->GetImage()->GetLabelObjectContainer();
+  for( typename LabelObjectContainerType::const_iterator it = labelObjects.begin();
+    it != labelObjects.end();
+    it++ )
+    {
+    double perimeter = 0;
+    if( this->ComputePerimeter( it->second, perimeter ) )
+      {
+      m_Perimeters[ it->first ] = perimeter;
+      }
+    }
+}
+
+
+template<class TInputImage>
+bool
+LabelMapPerimeterEstimationCalculator<TInputImage>
+::ComputePerimeter( const LabelObjectType * labelObject, double & perimeter ) const
+{
+  RowIndexType rowIndex( labelObject );
+  return this->ComputePerimeter( rowIndex, perimeter );
+}
+
+
+template<class TInputImage>
+bool
+LabelMapPerimeterEstimationCalculator<TInputImage>
+::ComputePerimeter( const RowIndexType & rowIndex, double & perimeter ) const
+{
+  typedef typename RowIndexType::RowMapType    RowMapType;
+  typedef typename RowIndexType::RunVectorType RunVectorType;
+
+  perimeter = 0;
+
+  // the neighborhoods are anchored on their pixel with the smallest index, and
+  // must be fully in the image, as in LabelPerimeterEstimationCalculator
+  const RegionType & region = this->GetImage()->GetLargestPossibleRegion();
+  IndexType anchorMin = region.GetIndex();
+  IndexType anchorMax = anchorMin;
+  for( int i=0; i<ImageDimension; i++ )
+    {
+    if( region.GetSize()[i] < 2 )
+      {
+      return false;
+      }
+    anchorMax[i] += region.GetSize()[i] - 2;
+    }
+
+  // a neighborhood covers 2 pixels in each of the 2^(ImageDimension-1) rows of the
+  // neighborhood. The bit j of a configuration is set when the pixel at the offset o
+  // is in the object, with o[k] = ( j >> k ) & 1, so the 2 pixels of the row m of
+  // the neighborhood are stored in the bits 2m and 2m+1.
+  const unsigned int numberOfRows = 1 << ( ImageDimension - 1 );
+  const unsigned int numberOfConfigurations = 1 << ( 1 << ImageDimension );
+
+  // find the rows of the anchors of all the neighborhoods which contain a pixel of the
+  // object
+  typedef std::set< IndexType, typename RowIndexType::RowComparator > RowSetType;
+  RowSetType anchorRows;
+  const RowMapType & rows = rowIndex.GetRows();
+  for( typename RowMapType::const_iterator it = rows.begin(); it != rows.end(); it++ )
+    {
+    for( unsigned int m=0; m<numberOfRows; m++ )
+      {
+      IndexType anchor = it->first;
+      bool inside = true;
+      for( int k=1; k<ImageDimension; k++ )
+        {
+        anchor[k] -= ( m >> ( k - 1 ) ) & 1;
+        if( anchor[k] < anchorMin[k] || anchor[k] > anchorMax[k] )
+          {
+          inside = false;
+          }
+        }
+      if( inside )
+        {
+        anchorRows.insert( anchor );
+        }
+      }
+    }
+
+  // count the configurations, row of anchors by row of anchors
+  std::vector< unsigned long > counts( numberOfConfigurations, 0 );
+  std::vector< const RunVectorType * > neighborRuns( numberOfRows );
+  std::vector< long > breakpoints;
+  bool found = false;
+  for( typename RowSetType::const_iterator it = anchorRows.begin(); it != anchorRows.end(); it++ )
+    {
+    // the configuration can only change where a run of one of the rows begins or ends.
+    // For a run from a to b, the pixels at x and x+1 are read, so the configuration
+    // may change at a-1, a, b and b+1.
+    breakpoints.clear();
+    for( unsigned int m=0; m<numberOfRows; m++ )
+      {
+      IndexType idx = *it;
+      for( int k=1; k<ImageDimension; k++ )
+        {
+        idx[k] += ( m >> ( k - 1 ) ) & 1;
+        }
+      neighborRuns[m] = rowIndex.GetRuns( idx );
+      if( neighborRuns[m] != NULL )
+        {
+        for( typename RunVectorType::const_iterator rit = neighborRuns[m]->begin();
+          rit != neighborRuns[m]->end();
+          rit++ )
+          {
+          breakpoints.push_back( rit->first - 1 );
+          breakpoints.push_back( rit->first );
+          breakpoints.push_back( rit->second );
+          breakpoints.push_back( rit->second + 1 );
+          }
+        }
+      }
+    std::sort( breakpoints.begin(), breakpoints.end() );
+    breakpoints.erase( std::unique( breakpoints.begin(), breakpoints.end() ), breakpoints.end() );
+
+    // the configuration is constant between two breakpoints. There is nothing to
+    // count after the last one.
+    for( unsigned int i=0; i+1<breakpoints.size(); i++ )
+      {
+      long first = std::max( breakpoints[i], anchorMin[0] );
+      long last = std::min( breakpoints[i+1] - 1, anchorMax[0] );
+      if( first > last )
+        {
+        continue;
+        }
+      unsigned long conf = 0;
+      for( unsigned int m=0; m<numberOfRows; m++ )
+        {
+        if( IsInRuns( neighborRuns[m], first ) )
+          {
+          conf += 1 << ( 2 * m );
+          }
+        if( IsInRuns( neighborRuns[m], first + 1 ) )
+          {
+          conf += 1 << ( 2 * m + 1 );
+          }
+        }
+      if( conf != 0 )
+        {
+        counts[ conf ] += last - first + 1;
+        found = true;
+        }
+      }
+    }
+
+  // and use the contributions to find the perimeter
+  for( unsigned int i=0; i<numberOfConfigurations; i++ )
+    {
+    if( counts[i] != 0 )
+      {
+      perimeter += m_Contributions[i] * counts[i];
+      }
+    }
+
+  return found;
+}
+
+
+template<class TInputImage>
+bool
+LabelMapPerimeterEstimationCalculator<TInputImage>
+::IsInRuns( const typename RowIndexType::RunVectorType * runs, long x )
+{
+  typedef typename RowIndexType::RunVectorType RunVectorType;
+  typedef typename RowIndexType::RunType       RunType;
+  if( runs == NULL )
+    {
+    return false;
+    }
+  // search the first run which begins after x - x can only be in the run before
+  typename RunVectorType::const_iterator it = std::upper_bound( runs->begin(), runs->end(),
+    RunType( x, NumericTraits< long >::max() ) );
+  if( it == runs->begin() )
+    {
+    return false;
+    }
+  it--;
+  return x <= it->second;
+}
+
+
+template<class TInputImage>
+void
+LabelMapPerimeterEstimationCalculator<TInputImage>
+::PrintSelf(std::ostream &os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+}
+  
+}// end namespace itk
+#endif
@@ -55,6 +55,11 @@ public:
     }
 };
 
+/** Sort the label objects by decreasing attribute value. The objects with the
+ * same value are sorted by label, so the selection of the N first objects is
+ * deterministic: with the label maps produced by BinaryImageToLabelMapFilter, the
+ * label follows the raster order of the first pixel of the object, the order used
+ * by BinaryKeepNObjectsCalculator. */
 template< class TLabelObject, class TAttributeAccessor >
 class LabelObjectComparator
 {
@@ -63,12 +68,21 @@ public:
   typedef TAttributeAccessor AttributeAccessorType;
   bool operator()( const LabelObjectType * a, const LabelObjectType * b )
     {
-    return m_Accessor( a ) > m_Accessor( b );
+    if( m_Accessor( a ) > m_Accessor( b ) )
+      {
+      return true;
+      }
+    if( m_Accessor( a ) < m_Accessor( b ) )
+      {
+      return false;
+      }
+    return a->GetLabel() < b->GetLabel();
     }
 private:
   AttributeAccessorType m_Accessor;
 };
 
+/** Sort the label objects by increasing attribute value, and then by label */
 template< class TLabelObject, class TAttributeAccessor >
 class LabelObjectReverseComparator
 {
@@ -77,7 +91,15 @@ public:
   typedef TAttributeAccessor AttributeAccessorType;
   bool operator()( const LabelObjectType * a, const LabelObjectType * b )
     {
-    return m_Accessor( a ) < m_Accessor( b );
+    if( m_Accessor( a ) < m_Accessor( b ) )
+      {
+      return true;
+      }
+    if( m_Accessor( a ) > m_Accessor( b ) )
+      {
+      return false;
+      }
+    return a->GetLabel() < b->GetLabel();
     }
 private:
   AttributeAccessorType m_Accessor;
@@ -308,7 +330,32 @@ public:
     assert( src != NULL );
     // nothing to do here - this class has no attribute
     }
-   
+
+  /**
+   * Update the attributes after the lines of src, disjoint from the ones of this
+   * object, have been added to this object. The subclasses merge the attributes
+   * which can be merged, and return false if some attributes are not up to date
+   * anymore and must be computed again by a valuator.
+   */
+  virtual bool MergeAttributesFrom( const Self * src )
+    {
+    assert( src != NULL );
+    // nothing to do here - this class has no attribute
+    return true;
+    }
+
+  /**
+   * Mark the attributes as not up to date after the lines of this object have
+   * been modified in a way MergeAttributesFrom() can't handle - for example with
+   * lines overlapping the ones already there. The subclasses return false if
+   * some attributes can't be computed again by a valuator.
+   */
+  virtual bool InvalidateAttributes()
+    {
+    // nothing to do here - this class has no attribute
+    return true;
+    }
+
   /** Copy the lines, the label and the attributes from another node. */
   void CopyAllFrom( const Self * src )
     {
@@ -18,11 +18,22 @@
 #define __itkLabelPerimeterEstimationCalculator_h
 
 #include "itkObject.h"
+#include "itkMultiThreader.h"
+#include <map>
+#include <vector>
 
 namespace itk {
 
 /** \class LabelPerimeterEstimationCalculator
- * \brief TODO
+ * \brief Estimate the perimeter of all the labels of a label image
+ *
+ * The perimeter is estimated by counting the configurations of the 2x2 (2x2x2 in 3D)
+ * neighborhoods of all the pixels of the image, for all the labels found in those
+ * neighborhoods, and by summing the contribution of each configuration to the perimeter.
+ *
+ * The image is split in several regions which are processed in parallel. Each thread
+ * counts the configurations in a dense array indexed by a compact label id, and the
+ * counts are reduced once all the threads are done.
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
@@ -49,8 +60,13 @@ public:
   typedef typename InputImageType::RegionType     RegionType;
   typedef typename InputImageType::SizeType       SizeType;
   typedef typename InputImageType::IndexType      IndexType;
+  typedef typename InputImageType::SpacingType    SpacingType;
   
   typedef typename std::map< InputImagePixelType, double > PerimetersType;
+
+  /** The contributions to the perimeter of all the configurations of a 2x2(x2)
+   * neighborhood, indexed by configuration */
+  typedef std::vector< double > ContributionsType;
   
   /** ImageDimension constants */
   itkStaticConstMacro(ImageDimension, unsigned int,
@@ -73,6 +89,13 @@ public:
   itkGetConstReferenceMacro(FullyConnected, bool);
   itkBooleanMacro(FullyConnected);
 
+  /**
+   * Set/Get the number of threads used to compute the configuration counts.
+   * It defaults to the global default number of threads.
+   */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstReferenceMacro(NumberOfThreads, int);
+
   void SetImage( const InputImageType * img )
     {
     m_Image = img;
@@ -99,6 +122,13 @@ public:
     itkExceptionMacro( << "Unknown label: " << static_cast<typename NumericTraits<InputImagePixelType>::PrintType>(label) );
     }
 
+  /**
+   * Compute the contribution to the perimeter of all the configurations of a 2x2(x2)
+   * neighborhood. The bit j of a configuration is set when the pixel at the offset o
+   * in the neighborhood is in the object, with o[k] = ( j >> k ) & 1.
+   */
+  static void ComputeContributions( const SpacingType & spacing, ContributionsType & contributions );
+
   bool HasLabel( const InputImagePixelType & label ) const
     {
     if( m_Perimeters.find( label ) != m_Perimeters.end() )
@@ -113,6 +143,15 @@ protected:
   ~LabelPerimeterEstimationCalculator() {};
   void PrintSelf(std::ostream& os, Indent indent) const;
 
+  /** Count the configurations in the part of the region assigned to a thread */
+  void ThreadedCompute( const RegionType & region, int threadId );
+
+  /** Split the region to be processed by the threads. Return the number of
+   * pieces actually available. */
+  int SplitRegion( int i, int num, const RegionType & region, RegionType & splitRegion );
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
 
 private:
   LabelPerimeterEstimationCalculator(const Self&); //purposely not implemented
@@ -120,10 +159,26 @@ private:
 
   bool m_FullyConnected;
 
+  int m_NumberOfThreads;
+
   const InputImageType * m_Image;
   
   PerimetersType m_Perimeters;
 
+  /** The configuration counts of a thread. The labels are mapped to a compact id
+   * and the counts of the label with the id i are stored in
+   * Counts[ i * number of configurations ] to Counts[ ( i + 1 ) * number of configurations - 1 ] */
+  typedef std::map< InputImagePixelType, unsigned long > LabelIdMapType;
+  struct ThreadCountsType
+    {
+    LabelIdMapType               LabelIds;
+    std::vector< unsigned long > Counts;
+    };
+
+  std::vector< ThreadCountsType > m_ThreadCounts;
+
+  RegionType m_RegionToProcess;
+
 }; // end of class
 
 } // end namespace itk
@@ -18,15 +18,7 @@
 #define __itkLabelPerimeterEstimationCalculator_txx
 
 #include "itkLabelPerimeterEstimationCalculator.h"
-#include "itkProgressReporter.h"
-#include "itkImageRegionIterator.h"
-#include "itkImageRegionConstIteratorWithIndex.h"
-#include "itkShapedNeighborhoodIterator.h"
-#include "itkConstShapedNeighborhoodIterator.h"
-#include "itkConstantBoundaryCondition.h"
-#include "itkSize.h"
-#include "itkConnectedComponentAlgorithm.h"
-#include <set>
+#include "itkImageLinearConstIteratorWithIndex.h"
 
 namespace itk {
 
@@ -35,6 +27,8 @@ LabelPerimeterEstimationCalculator<TInputImage>
 ::LabelPerimeterEstimationCalculator()
 {
   m_FullyConnected = false;
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_Image = NULL;
 }
 
 
@@ -46,177 +40,275 @@ LabelPerimeterEstimationCalculator<TInputImage>
   
   m_Perimeters.clear();
   
-  // ProgressReporter progress( this, 0, this->GetImage()->GetRequestedRegion().GetNumberOfPixels() );
-  
   // reduce the region to avoid reading outside
   RegionType region = this->GetImage()->GetRequestedRegion();
   SizeType size = region.GetSize();
   for( int i=0; i<ImageDimension; i++ )
     {
+    if( size[i] < 2 )
+      {
+      // no 2x2 neighborhood fully in the image - nothing to count
+      return;
+      }
     size[i]--;
     }
   region.SetSize( size );
 
-  // the radius which will be used for all the shaped iterators
-  Size< ImageDimension > radius;
-  radius.Fill(1);
-
-  // set up the iterator
-  typedef ConstShapedNeighborhoodIterator<InputImageType> IteratorType;
-  typename IteratorType::ConstIterator nIt;
-  IteratorType iIt( radius, this->GetImage(), region );
-//   ConstantBoundaryCondition<InputImageType> lcbc;
-//   lcbc.SetConstant( NumericTraits<InputImagePixelType>::max() );
-//   iIt.OverrideBoundaryCondition(&lcbc);
-  // we want to search the neighbors with offset >= 0
-  // 2D -> 4 neighbors
-  // 3D -> 8 neighbors
-  typename IteratorType::OffsetType offset;
-  unsigned int centerIndex = iIt.GetCenterNeighborhoodIndex();
-  // store the offsets to reuse them to evaluate the contributions of the
-  // configurations
-  typename std::vector< IndexType > indexes;
-  IndexType idx0;
-  idx0.Fill( 0 );
-  for( unsigned int d=centerIndex; d < 2*centerIndex+1; d++ )
+  // count the configurations in parallel
+  m_RegionToProcess = region;
+  m_ThreadCounts.clear();
+  m_ThreadCounts.resize( m_NumberOfThreads );
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( m_NumberOfThreads );
+  threader->SetSingleMethod( this->ThreaderCallback, this );
+  threader->SingleMethodExecute();
+
+  // compute the participation to the perimeter for all the configurations
+  const unsigned int numberOfConfigurations = 1 << ( 1 << ImageDimension );
+  ContributionsType contributions;
+  ComputeContributions( this->GetImage()->GetSpacing(), contributions );
+
+  // reduce the counts of all the threads
+  typedef typename std::map< InputImagePixelType, std::vector< unsigned long > > LabelCountsType;
+  LabelCountsType confCount;
+  for( typename std::vector< ThreadCountsType >::const_iterator tit = m_ThreadCounts.begin();
+    tit != m_ThreadCounts.end();
+    tit++ )
     {
-    offset = iIt.GetOffset( d );
-    bool deactivate = false;
-    for ( int j=0; j<ImageDimension && !deactivate; j++ )
+    for( typename LabelIdMapType::const_iterator it = tit->LabelIds.begin();
+      it != tit->LabelIds.end();
+      it++ )
       {
-      if( offset[j] < 0 )
+      std::vector< unsigned long > & counts = confCount[ it->first ];
+      if( counts.empty() )
         {
-        deactivate = true;
+        counts.resize( numberOfConfigurations, 0 );
+        }
+      const unsigned long * threadCounts = &tit->Counts[ it->second * numberOfConfigurations ];
+      for( unsigned int i=0; i<numberOfConfigurations; i++ )
+        {
+        counts[i] += threadCounts[i];
         }
       }
-    if( deactivate )
-      {
-//       std::cout << "- " << offset << std::endl;
-      iIt.DeactivateOffset( offset );
-      }
-    else
-      {
-//       std::cout << "+ " << idx0 + offset << std::endl;
-      iIt.ActivateOffset( offset );
-      indexes.push_back( idx0 + offset );
-      }
-
     }
-  
-  // to store the configurations count for all the labels
-  typedef typename std::map< unsigned long, unsigned long > MapType;
-  typedef typename std::map< InputImagePixelType, MapType > LabelMapType;
-  LabelMapType confCount;
+  m_ThreadCounts.clear();
 
-  for( iIt.GoToBegin(); !iIt.IsAtEnd(); ++iIt )
+  // and use those contributions to found the perimeter
+  for( typename LabelCountsType::const_iterator it = confCount.begin();
+    it != confCount.end();
+    it++ )
     {
-    // 2 pass - find the labels in the neighborhood
-    //        - count the configurations for all the labels
-
-    typedef typename std::set< InputImagePixelType > LabelSetType;
-    LabelSetType labelSet;
-    for ( nIt= iIt.Begin();
-      nIt != iIt.End();
-      nIt++ )
+    double perimeter = 0;
+    for( unsigned int i=0; i<numberOfConfigurations; i++ )
       {
-      labelSet.insert( nIt.Get() );
+      perimeter += contributions[i] * it->second[i];
       }
+    m_Perimeters[ it->first ] = perimeter;
+    }
 
-    for( typename LabelSetType::const_iterator it = labelSet.begin();
-      it != labelSet.end();
-      it++ )
-      {
+}
 
-      unsigned long conf = 0;
-      int i=0;
 
-      for ( nIt= iIt.Begin();
-        nIt != iIt.End();
-        nIt++, i++ )
+template<class TInputImage>
+void
+LabelPerimeterEstimationCalculator<TInputImage>
+::ComputeContributions( const SpacingType & spacing, ContributionsType & contributions )
+{
+  double physicalSize = 1;
+  for( int i=0; i<ImageDimension; i++ )
+    {
+    physicalSize *= spacing[i];
+    }
+  const unsigned int numberOfNeighbors = 1 << ImageDimension;
+  const unsigned int numberOfConfigurations = 1 << numberOfNeighbors;
+  contributions.clear();
+  contributions.resize( numberOfConfigurations, 0.0 );
+  for( unsigned int i=0; i<numberOfConfigurations; i++ )
+    {
+    for( unsigned int j=0; j<numberOfNeighbors; j++ )
+      {
+      if( i & 1 << j )
         {
-        if( nIt.Get() == *it )
+        for( int k=0; k<ImageDimension; k++ )
           {
-          conf += 1 << i;
+          // the neighbor in the dimension k, in the 2x2 neighborhood
+          unsigned int n = j ^ ( 1 << k );
+          if( !( i & 1 << n ) )
+            {
+            contributions[i] += physicalSize / spacing[k] / 2.0;
+            }
           }
         }
-
-      confCount[ *it ][ conf ]++;
-
       }
+    contributions[i] /= ImageDimension;
+    }
+}
 
-    // progress.CompletedPixel();
 
-    }
+template<class TInputImage>
+void
+LabelPerimeterEstimationCalculator<TInputImage>
+::ThreadedCompute( const RegionType & region, int threadId )
+{
+  const InputImageType * image = this->GetImage();
+  ThreadCountsType & threadCounts = m_ThreadCounts[ threadId ];
 
-  // compute the participation to the perimeter for all the configurations
-//   std::cout << "spacing: " << this->GetImage()->GetSpacing() << std::endl;
-  double physicalSize = 1;
-  for( int i=0; i<ImageDimension; i++ )
-    {
-    physicalSize *= this->GetImage()->GetSpacing()[i];
-    }
-  typedef typename std::map< unsigned long, double > ContributionMapType;
-  ContributionMapType contributions;
-  int numberOfNeighbors = (int)vcl_pow( 2.0, ImageDimension );
-  int numberOfConfigurations = (int)vcl_pow( 2.0, numberOfNeighbors );
-  // create an image to store the neighbors
-  typedef typename itk::Image< bool, ImageDimension > ImageType;
-  typename ImageType::Pointer neighborsImage = ImageType::New();
-  // typename ImageType::SizeType size;
-  size.Fill( 2 );
-  neighborsImage->SetRegions( size );
-  neighborsImage->Allocate();
-  for( int i=0; i<numberOfConfigurations; i++ )
+  const unsigned int numberOfNeighbors = 1 << ImageDimension;
+  const unsigned int numberOfConfigurations = 1 << numberOfNeighbors;
+
+  // the offsets in the buffer of the pixels of the 2x2 neighborhood, with
+  // the same order than the bits of the configurations
+  const IndexType & regionIdx = region.GetIndex();
+  const long regionOffset = image->ComputeOffset( regionIdx );
+  std::vector< long > offsets( numberOfNeighbors, 0 );
+  for( unsigned int j=0; j<numberOfNeighbors; j++ )
     {
-    neighborsImage->FillBuffer( false );
-    for( int j=0; j<numberOfNeighbors; j++ )
+    IndexType idx = regionIdx;
+    for( int k=0; k<ImageDimension; k++ )
       {
-      if( i & 1 << j )
+      if( j & 1 << k )
         {
-        neighborsImage->SetPixel( indexes[ j ], true );
+        idx[k]++;
         }
       }
-    // the image is created - we can now compute the contributions of the pixels
-    // for that configuration
-    contributions[i] = 0;
-    for( int j=0; j<numberOfNeighbors; j++ )
+    offsets[j] = image->ComputeOffset( idx ) - regionOffset;
+    }
+
+  std::vector< InputImagePixelType > values( numberOfNeighbors );
+
+  // the last label seen and its id, to avoid most of the search in the label map
+  InputImagePixelType lastLabel = NumericTraits< InputImagePixelType >::Zero;
+  unsigned long lastId = 0;
+  bool hasLastLabel = false;
+
+  const InputImagePixelType * buffer = image->GetBufferPointer();
+  const long length0 = region.GetSize()[0];
+
+  typedef ImageLinearConstIteratorWithIndex< InputImageType > IteratorType;
+  IteratorType iIt( image, region );
+  iIt.SetDirection( 0 );
+  for( iIt.GoToBegin(); !iIt.IsAtEnd(); iIt.NextLine() )
+    {
+    const InputImagePixelType * p = buffer + image->ComputeOffset( iIt.GetIndex() );
+    for( long x=0; x<length0; x++, p++ )
       {
-      IndexType currentIdx = indexes[j];
-      if( neighborsImage->GetPixel( currentIdx ) )
+      for( unsigned int j=0; j<numberOfNeighbors; j++ )
         {
-        for( int k=0; k<ImageDimension; k++ )
+        values[j] = p[ offsets[j] ];
+        }
+
+      // count the configuration of all the labels found in the neighborhood, only
+      // once per label
+      for( unsigned int j=0; j<numberOfNeighbors; j++ )
+        {
+        const InputImagePixelType & label = values[j];
+        bool alreadyCounted = false;
+        for( unsigned int k=0; k<j && !alreadyCounted; k++ )
+          {
+          alreadyCounted = ( values[k] == label );
+          }
+        if( alreadyCounted )
+          {
+          continue;
+          }
+
+        unsigned long conf = 1 << j;
+        for( unsigned int k=j+1; k<numberOfNeighbors; k++ )
           {
-          IndexType idx = currentIdx;
-          idx[k] = vcl_abs( idx[k] - 1 );
-          if( !neighborsImage->GetPixel( idx ) )
+          if( values[k] == label )
             {
-            contributions[i] += physicalSize / this->GetImage()->GetSpacing()[k] / 2.0;
+            conf += 1 << k;
             }
           }
+
+        // get the compact id of the label
+        if( !hasLastLabel || label != lastLabel )
+          {
+          typename LabelIdMapType::iterator lit = threadCounts.LabelIds.find( label );
+          if( lit == threadCounts.LabelIds.end() )
+            {
+            lastId = threadCounts.LabelIds.size();
+            threadCounts.LabelIds[ label ] = lastId;
+            threadCounts.Counts.resize( ( lastId + 1 ) * numberOfConfigurations, 0 );
+            }
+          else
+            {
+            lastId = lit->second;
+            }
+          lastLabel = label;
+          hasLastLabel = true;
+          }
+
+        threadCounts.Counts[ lastId * numberOfConfigurations + conf ]++;
         }
       }
-    contributions[i] /= ImageDimension;
-//     std::cout << "configuration: " << i << "  contribution: " << contributions[i] << std::endl;
     }
+}
 
 
-  // and use those contributions to found the perimeter
-  m_Perimeters.clear();
-  for( typename LabelMapType::const_iterator it = confCount.begin();
-    it != confCount.end();
-    it++ )
+template<class TInputImage>
+int
+LabelPerimeterEstimationCalculator<TInputImage>
+::SplitRegion( int i, int num, const RegionType & region, RegionType & splitRegion )
+{
+  // split on the outermost dimension available
+  splitRegion = region;
+  const SizeType & requestedRegionSize = region.GetSize();
+  int splitAxis = ImageDimension - 1;
+  while( requestedRegionSize[splitAxis] == 1 )
     {
-    m_Perimeters[ it->first ] = 0;
-    for( typename MapType::const_iterator it2 = it->second.begin();
-      it2 != it->second.end();
-      it2++ )
+    --splitAxis;
+    if( splitAxis < 0 )
       {
-      m_Perimeters[ it->first ] += contributions[ it2->first ] * it2->second;
-//       std::cout << it->first+0.0 << "  "  << it2->first << "  " << it2->second << std::endl;
+      // cannot split
+      return 1;
       }
-//     std::cout << "label: " << it->first+0.0 << "  perimeter: " << m_Perimeters[ it->first ] << std::endl;
     }
 
+  // determine the actual number of pieces that will be generated
+  typename SizeType::SizeValueType range = requestedRegionSize[splitAxis];
+  int valuesPerThread = (int)vcl_ceil( range / (double)num );
+  int maxThreadIdUsed = (int)vcl_ceil( range / (double)valuesPerThread ) - 1;
+
+  IndexType splitIndex = region.GetIndex();
+  SizeType splitSize = region.GetSize();
+  if( i < maxThreadIdUsed )
+    {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = valuesPerThread;
+    }
+  if( i == maxThreadIdUsed )
+    {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    // last thread needs to process the "rest" dimension being split
+    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
+    }
+
+  splitRegion.SetIndex( splitIndex );
+  splitRegion.SetSize( splitSize );
+
+  return maxThreadIdUsed + 1;
+}
+
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+LabelPerimeterEstimationCalculator<TInputImage>
+::ThreaderCallback( void * arg )
+{
+  int threadId = ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  int threadCount = ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+  Self * self = (Self *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  RegionType splitRegion;
+  int total = self->SplitRegion( threadId, threadCount, self->m_RegionToProcess, splitRegion );
+  if( threadId < total )
+    {
+    self->ThreadedCompute( splitRegion, threadId );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 
@@ -228,6 +320,7 @@ LabelPerimeterEstimationCalculator<TInputImage>
   Superclass::PrintSelf(os, indent);
   
   os << indent << "FullyConnected: "  << m_FullyConnected << std::endl;
+  os << indent << "NumberOfThreads: "  << m_NumberOfThreads << std::endl;
 }
   
 }// end namespace itk
@@ -21,7 +21,18 @@
 
 namespace itk {
 /** \class MergeLabelMapFilter
- * \brief TODO
+ * \brief Merges several LabelMaps
+ *
+ * With the AGGREGATE method, the objects with the same label are merged. When they
+ * don't overlap, their attributes are merged with LabelObject::MergeAttributesFrom(),
+ * so the attributes which can be merged, like the size, the moments or the
+ * histogram, don't have to be computed again by a valuator. The attributes which
+ * can't be merged, and all the attributes of the overlapping objects, are marked
+ * as not evaluated in the label objects, and evaluated again on demand when the
+ * label objects can do it. * The statistics of StatisticsLabelObject can't be evaluated
+ * on demand: their getters throw an exception until they are computed again with
+ * StatisticsLabelMapFilter, which only processes the merged objects when
+ * ReuseEvaluatedAttributes is on.
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
@@ -20,6 +20,7 @@
 #include "itkMergeLabelMapFilter.h"
 #include "itkProgressReporter.h"
 #include <deque>
+#include <set>
 
 
 namespace itk {
@@ -119,6 +120,7 @@ MergeLabelMapFilter<TImage>
     }
   else if( m_Method == AGGREGATE )
     {
+    std::set< LabelObjectType * > overlappingLabelObjects;
     for( unsigned int i=1; i<this->GetNumberOfInputs(); i++ )
       {
       const LabelObjectContainerType & otherLabelObjects = this->GetInput(i)->GetLabelObjectContainer();
@@ -145,6 +147,7 @@ MergeLabelMapFilter<TImage>
           LabelObjectType * mainLo = output->GetLabelObject( lo->GetLabel() );
           typename LabelObjectType::LineContainerType::const_iterator lit;
           const typename LabelObjectType::LineContainerType & lineContainer = lo->GetLineContainer();
+          const unsigned long size = mainLo->Size() + lo->Size();
         
           for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
             {
@@ -152,12 +155,32 @@ MergeLabelMapFilter<TImage>
             }
           // be sure to have the lines well organized
           mainLo->Optimize();
+          // the objects of different inputs may overlap. When they don't, the
+          // attributes which can be merged don't have to be computed again, and
+          // the other ones are marked as not evaluated by the label object.
+          // The attributes of the overlapping objects are all invalidated once
+          // all the inputs are merged.
+          if( mainLo->Size() != size )
+            {
+            overlappingLabelObjects.insert( mainLo );
+            }
+          else
+            {
+            mainLo->MergeAttributesFrom( lo );
+            }
           }
         
         // go to the next label
         // progress.CompletedPixel();
         }
       }
+
+    for( typename std::set< LabelObjectType * >::iterator it = overlappingLabelObjects.begin();
+      it != overlappingLabelObjects.end();
+      it++ )
+      {
+      (*it)->InvalidateAttributes();
+      }
     }
   else if( m_Method == PACK )
     {
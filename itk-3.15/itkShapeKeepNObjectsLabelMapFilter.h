@@ -90,6 +90,15 @@ public:
   itkSetMacro( NumberOfObjects, unsigned long );
   itkGetConstReferenceMacro( NumberOfObjects, unsigned long );
 
+  /**
+   * Set/Get whether the removed objects are moved to the second output. When
+   * false, the removed objects are discarded and the second output is empty.
+   * Defaults to true.
+   */
+  itkSetMacro( StoreRemovedObjects, bool );
+  itkGetConstReferenceMacro( StoreRemovedObjects, bool );
+  itkBooleanMacro( StoreRemovedObjects );
+
   /**
    * Set/Get the attribute to use to select the object to keep. The default
    * is "Size".
@@ -114,6 +123,7 @@ protected:
 
   bool          m_ReverseOrdering;
   unsigned long m_NumberOfObjects;
+  bool          m_StoreRemovedObjects;
   AttributeType m_Attribute;
 
 private:
@@ -19,6 +19,7 @@
 
 #include "itkShapeKeepNObjectsLabelMapFilter.h"
 #include "itkProgressReporter.h"
+#include <algorithm>
 
 
 namespace itk {
@@ -29,6 +30,7 @@ ShapeKeepNObjectsLabelMapFilter<TImage>
 {
   m_ReverseOrdering = false;
   m_NumberOfObjects = 1;
+  m_StoreRemovedObjects = true;
   m_Attribute = LabelObjectType::SIZE;
   // create the output image for the removed objects
   this->SetNumberOfRequiredOutputs(2);
@@ -111,7 +113,7 @@ ShapeKeepNObjectsLabelMapFilter<TImage>
   const LabelObjectContainerType & labelObjectContainer = output->GetLabelObjectContainer();
   typedef typename std::vector< typename LabelObjectType::Pointer > VectorType;
 
-  ProgressReporter progress( this, 0, 2 * labelObjectContainer.size() );
+  ProgressReporter progress( this, 0, labelObjectContainer.size() );
 
   // get the label objects in a vector, so they can be sorted
   VectorType labelObjects;
@@ -138,17 +140,12 @@ ShapeKeepNObjectsLabelMapFilter<TImage>
       Functor::LabelObjectComparator< LabelObjectType, TAttributeAccessor > comparator;
       std::nth_element( labelObjects.begin(), end, labelObjects.end(), comparator );
       }
-//   progress.CompletedPixel();
-  
-    // and remove the last objects of the map
-    for( typename VectorType::const_iterator it = end;
-      it != labelObjects.end();
-      it++ )
-      {
-      output2->AddLabelObject( *it );
-      output->RemoveLabelObject( *it );
-      progress.CompletedPixel();
-      }
+
+    // keep the first objects, sorted by label, and rebuild the label object
+    // container only once
+    labelObjects.resize( m_NumberOfObjects );
+    std::sort( labelObjects.begin(), labelObjects.end(), typename Superclass::LabelComparator() );
+    this->KeepLabelObjects( labelObjects, m_StoreRemovedObjects ? output2 : NULL );
     }
 }
 
@@ -162,6 +159,7 @@ ShapeKeepNObjectsLabelMapFilter<TImage>
 
   os << indent << "ReverseOrdering: "  << m_ReverseOrdering << std::endl;
   os << indent << "NumberOfObjects: "  << m_NumberOfObjects << std::endl;
+  os << indent << "StoreRemovedObjects: "  << m_StoreRemovedObjects << std::endl;
   os << indent << "Attribute: "  << LabelObjectType::GetNameFromAttribute(m_Attribute) << " (" << m_Attribute << ")" << std::endl;
 }
 
@@ -16,7 +16,7 @@
 =========================================================================*/
 #ifndef __itkShapeLabelMapFilter_h
 #define __itkShapeLabelMapFilter_h
-#include "itkLabelPerimeterEstimationCalculator.h"
+#include "itkShapeLabelObjectAttributesEvaluator.h"
 
 #include "itkInPlaceLabelMapFilter.h"
 
@@ -29,13 +29,16 @@ namespace itk {
  * ShapeLabelMapFilter can be used to set the attributes values
  * of the ShapeLabelObject in a LabelMap.
  *
- * ShapeLabelMapFilter take an optional parameter, used only to optimize
- * the computation time and the memory usage when the perimeter or the feret diameter
- * are used: the exact copy of the input LabelMap but stored in an Image.
- * It can be set with SetLabelImage(). It is cleared at the end of the computation, and
- * so must be reset before running Update() again. It is not part of the pipeline management
- * design, to let the subclasses of ShapeLabelMapFilter use the
- * pipeline desing to specify a really required input.
+ * The perimeter and the feret diameter are computed directly from the lines of the
+ * objects and of their neighbor lines, so the label map never has to be stored in
+ * an image. SetLabelImage() is kept for backward compatibility, but the label image
+ * is not used anymore.
+ *
+ * The attributes are computed by a ShapeLabelObjectAttributesEvaluator. With
+ * LazyEvaluation on, the evaluator is only attached to the label objects, and
+ * a group of attributes is computed the first time one of its attributes
+ * is read - a pipeline which only uses the size of the objects doesn't pay for the
+ * moments, the eigen system, the feret diameter or the perimeter.
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
@@ -62,6 +65,7 @@ public:
   typedef typename ImageType::LabelObjectType  LabelObjectType;
   typedef typename LabelObjectType::MatrixType MatrixType;
   typedef typename LabelObjectType::VectorType VectorType;
+  typedef typename LabelObjectType::AttributeGroupMaskType AttributeGroupMaskType;
   
   typedef TLabelImage                              LabelImageType;
   typedef typename LabelImageType::Pointer         LabelImagePointer;
@@ -72,7 +76,7 @@ public:
   itkStaticConstMacro(ImageDimension, unsigned int,
                       TImage::ImageDimension);
 
-  typedef LabelPerimeterEstimationCalculator< LabelImageType > PerimeterCalculatorType;
+  typedef ShapeLabelObjectAttributesEvaluator< ImageType > AttributesEvaluatorType;
 
   /** Standard New method. */
   itkNewMacro(Self);  
@@ -95,6 +99,8 @@ public:
   /**
    * Set/Get whether the maximum Feret diameter should be computed or not. The
    * defaut value is false, because of the high computation time required.
+   * The pixels on the border of the objects are found directly from the lines
+   * of the objects, so the label map doesn't have to be stored in an image.
    */
   itkSetMacro(ComputeFeretDiameter, bool);
   itkGetConstReferenceMacro(ComputeFeretDiameter, bool);
@@ -108,11 +114,33 @@ public:
   itkGetConstReferenceMacro(ComputePerimeter, bool);
   itkBooleanMacro(ComputePerimeter);
 
+  /**
+   * Set/Get the groups of attributes to compute, as a combination of the
+   * *_ATTRIBUTES constants of the label object type. The feret diameter and the
+   * perimeter are also computed when ComputeFeretDiameter and ComputePerimeter
+   * are on. The attributes of the groups not computed are left to their default
+   * value. The groups required to compute the requested ones are always computed.
+   * The default value is SIZE_ATTRIBUTES | BORDER_ATTRIBUTES | MOMENTS_ATTRIBUTES.
+   * This option is ignored when LazyEvaluation is on.
+   */
+  itkSetMacro(ComputedAttributes, AttributeGroupMaskType);
+  itkGetConstReferenceMacro(ComputedAttributes, AttributeGroupMaskType);
+
+  /**
+   * Set/Get whether the attributes should be computed only when they are read
+   * for the first time. When on, the feret diameter and the perimeter are also
+   * computed on demand, whatever the value of ComputeFeretDiameter and
+   * ComputePerimeter. The lazy evaluation is not thread safe: an object with
+   * some attributes not yet evaluated must not be read by several threads at
+   * the same time. The default value is false.
+   */
+  itkSetMacro(LazyEvaluation, bool);
+  itkGetConstReferenceMacro(LazyEvaluation, bool);
+  itkBooleanMacro(LazyEvaluation);
 
-  /** Set the label image */
-  void SetLabelImage( const TLabelImage *input )
+  /** Set the label image. Not used anymore - kept for backward compatibility. */
+  void SetLabelImage( const TLabelImage * )
     {
-    m_LabelImage = input;
     }
 
   /** */
@@ -144,6 +172,18 @@ protected:
 
   virtual void AfterThreadedGenerateData();
 
+  /** The groups of shape attributes computed in ThreadedGenerateData(), with the
+   * groups they depend on. */
+  AttributeGroupMaskType GetEvaluatedShapeAttributes() const;
+
+  /** The evaluator of the shape attributes. Only valid during the update. A
+   * subclass which iterates over the lines of the objects can use it to
+   * compute the shape attributes in its own pass on the lines. */
+  const AttributesEvaluatorType * GetAttributesEvaluator() const
+    {
+    return m_AttributesEvaluator;
+    }
+
   void PrintSelf(std::ostream& os, Indent indent) const;
 
 private:
@@ -154,9 +194,11 @@ private:
 
   bool                                      m_ComputePerimeter;
 
-  LabelImageConstPointer                    m_LabelImage;
+  bool                                      m_LazyEvaluation;
+
+  AttributeGroupMaskType                    m_ComputedAttributes;
 
-  typename PerimeterCalculatorType::Pointer m_PerimeterCalculator;
+  typename AttributesEvaluatorType::Pointer m_AttributesEvaluator;
 
 }; // end of class
 
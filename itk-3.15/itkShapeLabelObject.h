@@ -20,6 +20,7 @@
 #include "itkLabelObject.h"
 #include "itkAffineTransform.h"
 #include "itkMatrix.h"
+#include <algorithm>
 
 namespace itk
 {
@@ -312,6 +313,281 @@ public:
   static const AttributeType EQUIVALENT_ELLIPSOID_RADIUS=116;
   static const AttributeType BINARY_FLATNESS=117;
 
+  /**
+   * The attributes are computed by groups of attributes which share most of
+   * their computation. The groups can be combined in a mask.
+   */
+  typedef unsigned long AttributeGroupMaskType;
+  /** Size, PhysicalSize, Region, Centroid, RegionElongation, SizeRegionRatio,
+   * EquivalentRadius and EquivalentPerimeter */
+  static const AttributeGroupMaskType SIZE_ATTRIBUTES=1;
+  /** SizeOnBorder and PhysicalSizeOnBorder */
+  static const AttributeGroupMaskType BORDER_ATTRIBUTES=2;
+  /** BinaryPrincipalMoments, BinaryPrincipalAxes, BinaryElongation, BinaryFlatness
+   * and EquivalentEllipsoidSize */
+  static const AttributeGroupMaskType MOMENTS_ATTRIBUTES=4;
+  /** FeretDiameter */
+  static const AttributeGroupMaskType FERET_DIAMETER_ATTRIBUTES=8;
+  /** Perimeter and Roundness */
+  static const AttributeGroupMaskType PERIMETER_ATTRIBUTES=16;
+  static const AttributeGroupMaskType ALL_SHAPE_ATTRIBUTES=31;
+
+  /** Return the group of an attribute, or 0 if the attribute is not a shape attribute */
+  static AttributeGroupMaskType GetAttributeGroup( const AttributeType & a )
+    {
+    switch( a )
+      {
+      case SIZE:
+      case PHYSICAL_SIZE:
+      case REGION_ELONGATION:
+      case SIZE_REGION_RATIO:
+      case CENTROID:
+      case REGION:
+      case EQUIVALENT_RADIUS:
+      case EQUIVALENT_PERIMETER:
+        return SIZE_ATTRIBUTES;
+        break;
+      case SIZE_ON_BORDER:
+      case PHYSICAL_SIZE_ON_BORDER:
+        return BORDER_ATTRIBUTES;
+        break;
+      case BINARY_PRINCIPAL_MOMENTS:
+      case BINARY_PRINCIPAL_AXES:
+      case BINARY_ELONGATION:
+      case EQUIVALENT_ELLIPSOID_RADIUS:
+      case BINARY_FLATNESS:
+        return MOMENTS_ATTRIBUTES;
+        break;
+      case FERET_DIAMETER:
+        return FERET_DIAMETER_ATTRIBUTES;
+        break;
+      case PERIMETER:
+      case ROUNDNESS:
+        return PERIMETER_ATTRIBUTES;
+        break;
+      }
+    return 0;
+    }
+
+  typedef ImageRegion< ImageDimension > RegionType;
+
+  typedef typename itk::Point<double, ImageDimension> CentroidType;
+
+  typedef Matrix< double, ImageDimension, ImageDimension >   MatrixType;
+
+  typedef Vector< double, ImageDimension > VectorType;
+
+  /** \class LineSumsType
+   * The sums accumulated on the lines of the object to compute the size, border and
+   * moments groups of attributes. The sums of two disjoint objects can be merged,
+   * so the attributes of their union are computed without reading the lines again.
+   */
+  struct LineSumsType
+    {
+    /** The groups of attributes the sums are valid for */
+    AttributeGroupMaskType Groups;
+    unsigned long          Size;
+    /** The sum of the indexes */
+    VectorType             Centroid;
+    IndexType              Minimum;
+    IndexType              Maximum;
+    unsigned long          SizeOnBorder;
+    double                 PhysicalSizeOnBorder;
+    /** The sum of the products of the physical positions */
+    MatrixType             Moments;
+
+    /** Add the sums of a disjoint object. Only the groups valid in both sums are kept. */
+    void Merge( const LineSumsType & sums )
+      {
+      Groups &= sums.Groups;
+      Size += sums.Size;
+      for( unsigned int i=0; i<ImageDimension; i++ )
+        {
+        Centroid[i] += sums.Centroid[i];
+        Minimum[i] = std::min( Minimum[i], sums.Minimum[i] );
+        Maximum[i] = std::max( Maximum[i], sums.Maximum[i] );
+        for( unsigned int j=0; j<ImageDimension; j++ )
+          {
+          Moments[i][j] += sums.Moments[i][j];
+          }
+        }
+      SizeOnBorder += sums.SizeOnBorder;
+      PhysicalSizeOnBorder += sums.PhysicalSizeOnBorder;
+      }
+    };
+
+  /** \class AttributesEvaluator
+   * Interface of the objects able to compute the attributes of a ShapeLabelObject
+   * on demand. When an evaluator is attached to a label object, a group of
+   * attributes is computed on the first access to one of its attributes,
+   * and cached in the label object.
+   */
+  class AttributesEvaluator : public LightObject
+    {
+    public:
+      typedef AttributesEvaluator             Self;
+      typedef LightObject                     Superclass;
+      typedef SmartPointer<Self>              Pointer;
+      typedef SmartPointer<const Self>        ConstPointer;
+      typedef ShapeLabelObject                ShapeLabelObjectType;
+
+      /** Compute and store the attributes of the given groups in the label object */
+      virtual void EvaluateAttributes( ShapeLabelObjectType * labelObject, const AttributeGroupMaskType & groups ) const = 0;
+
+      /** Compute and store the attributes of the groups of the sums in the label object */
+      virtual void SetAccumulatedAttributes( ShapeLabelObjectType * labelObject, const LineSumsType & sums ) const = 0;
+
+    protected:
+      AttributesEvaluator() {};
+      virtual ~AttributesEvaluator() {};
+
+    private:
+      AttributesEvaluator(const Self&); //purposely not implemented
+      void operator=(const Self&); //purposely not implemented
+    };
+
+  /**
+   * Set/Get the evaluator used to compute the attributes on demand. The attributes
+   * are marked as not evaluated when a new evaluator is set, and the line sums
+   * are dropped. Without evaluator, the Get*() methods simply return the values
+   * stored with the Set*() methods. The groups of the subclasses, which are not
+   * computed by the evaluator, are kept.
+   */
+  void SetAttributesEvaluator( const AttributesEvaluator * evaluator )
+    {
+    m_AttributesEvaluator = evaluator;
+    m_EvaluatedAttributes &= ~ALL_SHAPE_ATTRIBUTES;
+    m_LineSums.Groups = 0;
+    }
+
+  const AttributesEvaluator * GetAttributesEvaluator() const
+    {
+    return m_AttributesEvaluator;
+    }
+
+  /** Set/Get the groups of attributes already evaluated */
+  void SetEvaluatedAttributes( const AttributeGroupMaskType & groups )
+    {
+    m_EvaluatedAttributes = groups;
+    }
+
+  const AttributeGroupMaskType & GetEvaluatedAttributes() const
+    {
+    return m_EvaluatedAttributes;
+    }
+
+  /**
+   * Evaluate the groups of attributes not already evaluated, if an evaluator
+   * is attached to the label object. This method is called by the Get*() methods.
+   * It is not thread safe: a label object with some attributes still to evaluate
+   * must not be read by several threads at the same time.
+   */
+  void EvaluateAttributes( const AttributeGroupMaskType & groups ) const
+    {
+    AttributeGroupMaskType missing = groups & ~m_EvaluatedAttributes;
+    if( missing != 0 && m_AttributesEvaluator.IsNotNull() )
+      {
+      // mark the groups as evaluated first, so the evaluator can read the
+      // attributes it is computing without evaluating them again
+      m_EvaluatedAttributes |= missing;
+      m_AttributesEvaluator->EvaluateAttributes( const_cast< Self * >( this ), missing );
+      }
+    }
+
+  /**
+   * Set the sums accumulated on the lines of the object, and the evaluator able to
+   * compute the attributes from them. Only the sums of the groups in sums.Groups
+   * are replaced.
+   */
+  void SetLineSums( const LineSumsType & sums, const AttributesEvaluator * evaluator )
+    {
+    if( sums.Groups & SIZE_ATTRIBUTES )
+      {
+      m_LineSums.Size = sums.Size;
+      m_LineSums.Centroid = sums.Centroid;
+      m_LineSums.Minimum = sums.Minimum;
+      m_LineSums.Maximum = sums.Maximum;
+      }
+    if( sums.Groups & BORDER_ATTRIBUTES )
+      {
+      m_LineSums.SizeOnBorder = sums.SizeOnBorder;
+      m_LineSums.PhysicalSizeOnBorder = sums.PhysicalSizeOnBorder;
+      }
+    if( sums.Groups & MOMENTS_ATTRIBUTES )
+      {
+      m_LineSums.Moments = sums.Moments;
+      }
+    m_LineSums.Groups |= sums.Groups;
+    m_LineSumsEvaluator = evaluator;
+    }
+
+  const LineSumsType & GetLineSums() const
+    {
+    return m_LineSums;
+    }
+
+  /**
+   * Update the attributes after the lines of lo, disjoint from the ones of this
+   * object, have been added to this object. The size, border and moments groups are
+   * computed from the merged line sums. The other groups, and the groups without
+   * sums in both objects, are evaluated again from the lines on demand, like with
+   * the lazy evaluation. Return false if some shape attributes can't be evaluated
+   * again, because the attributes haven't been computed by a ShapeLabelMapFilter.
+   */
+  virtual bool MergeAttributesFrom( const LabelObjectType * lo )
+    {
+    const Self * src = dynamic_cast<const Self *>( lo );
+    if( m_LineSumsEvaluator.IsNull() )
+      {
+      // no way to compute the attributes again
+      m_EvaluatedAttributes &= ~ALL_SHAPE_ATTRIBUTES;
+      return false;
+      }
+
+    LineSumsType sums = m_LineSums;
+    if( src != NULL )
+      {
+      sums.Merge( src->m_LineSums );
+      }
+    else
+      {
+      sums.Groups = 0;
+      }
+
+    // the groups which can't be merged are evaluated again when they are read
+    if( m_AttributesEvaluator.IsNull() )
+      {
+      m_AttributesEvaluator = m_LineSumsEvaluator;
+      }
+    m_EvaluatedAttributes &= ~ALL_SHAPE_ATTRIBUTES;
+    m_EvaluatedAttributes |= sums.Groups;
+
+    // the sums of the groups not merged are not valid anymore
+    m_LineSums.Groups = 0;
+    if( sums.Groups != 0 )
+      {
+      m_LineSumsEvaluator->SetAccumulatedAttributes( this, sums );
+      }
+    return true;
+    }
+
+  /**
+   * Mark all the attributes as not evaluated. The shape attributes are evaluated
+   * again from the lines on demand, like with the lazy evaluation. Return false if
+   * they can't be evaluated again, because the attributes haven't been computed
+   * by a ShapeLabelMapFilter.
+   */
+  virtual bool InvalidateAttributes()
+    {
+    m_EvaluatedAttributes = 0;
+    m_LineSums.Groups = 0;
+    if( m_AttributesEvaluator.IsNull() )
+      {
+      m_AttributesEvaluator = m_LineSumsEvaluator;
+      }
+    return m_AttributesEvaluator.IsNotNull();
+    }
+
   static AttributeType GetAttributeFromName( const std::string & s )
     {
     if( s == "Size" )
@@ -452,18 +728,11 @@ public:
     return Superclass::GetNameFromAttribute( a );
     }
 
-  typedef ImageRegion< ImageDimension > RegionType;
-
-  typedef typename itk::Point<double, ImageDimension> CentroidType;
-
-  typedef Matrix< double, ImageDimension, ImageDimension >   MatrixType;
-
-  typedef Vector< double, ImageDimension > VectorType;
-
 /*  itkGetConstMacro( Region, RegionType );
   itkSetMacro( Region, RegionType );*/
   const RegionType & GetRegion() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES );
     return m_Region;
     }
 
@@ -476,6 +745,7 @@ public:
 //   itkSetMacro( PhysicalSize, double );
   const double & GetPhysicalSize() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES );
     return m_PhysicalSize;
     }
 
@@ -488,6 +758,7 @@ public:
 //   itkSetMacro( Size, unsigned long );
   const unsigned long & GetSize() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES );
     return m_Size;
     }
 
@@ -500,6 +771,7 @@ public:
 //   itkSetMacro( Centroid, CentroidType );
   const CentroidType & GetCentroid() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES );
     return m_Centroid;
     }
 
@@ -512,6 +784,7 @@ public:
 //   itkSetMacro( RegionElongation, double );
   const double & GetRegionElongation() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES );
     return m_RegionElongation;
     }
 
@@ -524,6 +797,7 @@ public:
 //   itkSetMacro( SizeRegionRatio, double );
   const double & GetSizeRegionRatio() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES );
     return m_SizeRegionRatio;
     }
 
@@ -536,6 +810,7 @@ public:
 //   itkSetMacro( SizeOnBorder, bool );
   const unsigned long & GetSizeOnBorder() const
     {
+    this->EvaluateAttributes( BORDER_ATTRIBUTES );
     return m_SizeOnBorder;
     }
 
@@ -548,6 +823,7 @@ public:
 //   itkSetMacro( PhysicalSizeOnBorder, double );
   const double & GetPhysicalSizeOnBorder() const
     {
+    this->EvaluateAttributes( BORDER_ATTRIBUTES );
     return m_PhysicalSizeOnBorder;
     }
 
@@ -560,6 +836,7 @@ public:
 //   itkSetMacro( FeretDiameter, double );
   const double & GetFeretDiameter() const
     {
+    this->EvaluateAttributes( FERET_DIAMETER_ATTRIBUTES );
     return m_FeretDiameter;
     }
 
@@ -572,6 +849,7 @@ public:
 //   itkSetMacro( BinaryPrincipalMoments, VectorType );
   const VectorType & GetBinaryPrincipalMoments() const
     {
+    this->EvaluateAttributes( MOMENTS_ATTRIBUTES );
     return m_BinaryPrincipalMoments;
     }
 
@@ -584,6 +862,7 @@ public:
 //   itkSetMacro( BinaryPrincipalAxes, MatrixType );
   const MatrixType & GetBinaryPrincipalAxes() const
     {
+    this->EvaluateAttributes( MOMENTS_ATTRIBUTES );
     return m_BinaryPrincipalAxes;
     }
 
@@ -596,6 +875,7 @@ public:
 //   itkSetMacro( BinaryElongation, double );
   const double & GetBinaryElongation() const
     {
+    this->EvaluateAttributes( MOMENTS_ATTRIBUTES );
     return m_BinaryElongation;
     }
 
@@ -608,6 +888,7 @@ public:
 //   itkSetMacro( Perimeter, double );
   const double & GetPerimeter() const
     {
+    this->EvaluateAttributes( PERIMETER_ATTRIBUTES );
     return m_Perimeter;
     }
 
@@ -620,6 +901,7 @@ public:
 //   itkSetMacro( Roundness, double );
   const double & GetRoundness() const
     {
+    this->EvaluateAttributes( PERIMETER_ATTRIBUTES );
     return m_Roundness;
     }
 
@@ -632,6 +914,7 @@ public:
 //   itkSetMacro( EquivalentRadius, double );
   const double & GetEquivalentRadius() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES );
     return m_EquivalentRadius;
     }
 
@@ -644,6 +927,7 @@ public:
 //   itkSetMacro( EquivalentPerimeter, double );
   const double & GetEquivalentPerimeter() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES );
     return m_EquivalentPerimeter;
     }
 
@@ -656,6 +940,7 @@ public:
 //   itkSetMacro( EquivalentEllipsoidSize, VectorType );
   const VectorType & GetEquivalentEllipsoidSize() const
     {
+    this->EvaluateAttributes( MOMENTS_ATTRIBUTES );
     return m_EquivalentEllipsoidSize;
     }
 
@@ -668,6 +953,7 @@ public:
 //   itkSetMacro( BinaryFlatness, double );
   const double & GetBinaryFlatness() const
     {
+    this->EvaluateAttributes( MOMENTS_ATTRIBUTES );
     return m_BinaryFlatness;
     }
 
@@ -688,6 +974,7 @@ public:
    * the principal axes coordinate system to physical coordinates. */
   AffineTransformPointer GetBinaryPrincipalAxesToPhysicalAxesTransform() const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES | MOMENTS_ATTRIBUTES );
     typename AffineTransformType::MatrixType matrix;
     typename AffineTransformType::OffsetType offset;
     for (unsigned int i = 0; i < ImageDimension; i++) 
@@ -713,6 +1000,7 @@ public:
    * system. */
   AffineTransformPointer GetPhysicalAxesToBinaryPrincipalAxesTransform(void) const
     {
+    this->EvaluateAttributes( SIZE_ATTRIBUTES | MOMENTS_ATTRIBUTES );
     typename AffineTransformType::MatrixType matrix;
     typename AffineTransformType::OffsetType offset;
     for (unsigned int i = 0; i < ImageDimension; i++) 
@@ -763,6 +1051,10 @@ public:
     m_EquivalentPerimeter = src->m_EquivalentPerimeter;
     m_EquivalentEllipsoidSize = src->m_EquivalentEllipsoidSize;
     m_BinaryFlatness = src->m_BinaryFlatness;
+    m_AttributesEvaluator = src->m_AttributesEvaluator;
+    m_EvaluatedAttributes = src->m_EvaluatedAttributes;
+    m_LineSums = src->m_LineSums;
+    m_LineSumsEvaluator = src->m_LineSumsEvaluator;
     }
 
 protected:
@@ -785,6 +1077,17 @@ protected:
     m_EquivalentPerimeter = 0;
     m_EquivalentEllipsoidSize.Fill(0);
     m_BinaryFlatness = 0;
+    m_AttributesEvaluator = NULL;
+    m_EvaluatedAttributes = 0;
+    m_LineSums.Groups = 0;
+    m_LineSums.Size = 0;
+    m_LineSums.Centroid.Fill(0);
+    m_LineSums.Minimum.Fill(0);
+    m_LineSums.Maximum.Fill(0);
+    m_LineSums.SizeOnBorder = 0;
+    m_LineSums.PhysicalSizeOnBorder = 0;
+    m_LineSums.Moments.Fill(0);
+    m_LineSumsEvaluator = NULL;
     }
   
 
@@ -836,6 +1139,12 @@ private:
   VectorType    m_EquivalentEllipsoidSize;
   double        m_BinaryFlatness;
 
+  typename AttributesEvaluator::ConstPointer m_AttributesEvaluator;
+  mutable AttributeGroupMaskType             m_EvaluatedAttributes;
+
+  LineSumsType                               m_LineSums;
+  typename AttributesEvaluator::ConstPointer m_LineSumsEvaluator;
+
 };
 
 } // end namespace itk
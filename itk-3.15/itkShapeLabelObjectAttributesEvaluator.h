@@ -0,0 +1,167 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkShapeLabelObjectAttributesEvaluator.h,v $
+  Language:  C++
+  Date:      $Date: 2006/03/28 19:59:05 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkShapeLabelObjectAttributesEvaluator_h
+#define __itkShapeLabelObjectAttributesEvaluator_h
+
+#include "itkLabelMapPerimeterEstimationCalculator.h"
+#include "itkLabelMapUtilities.h"
+
+namespace itk {
+
+/** \class ShapeLabelObjectAttributesEvaluator
+ * \brief Compute the attributes of the ShapeLabelObject, by group of attributes
+ *
+ * ShapeLabelObjectAttributesEvaluator computes the groups of attributes of
+ * the ShapeLabelObject (see ShapeLabelObject::SIZE_ATTRIBUTES and the
+ * following constants) from the lines of the objects. It is used by
+ * ShapeLabelMapFilter to compute the attributes during the update of the filter,
+ * or can be attached to the label objects, to compute them only when they are
+ * read for the first time.
+ *
+ * The evaluator keeps its own empty label map with the same geometry than the
+ * label map passed with SetImage(). That way, it can be attached to the label
+ * objects without creating a reference loop between the label map and the
+ * evaluator. The lines of the objects are read when the attributes are evaluated,
+ * so the objects must not be modified between the update of the valuator and
+ * the evaluation of the attributes.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa ShapeLabelMapFilter, ShapeLabelObject
+ * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
+ */
+template<class TImage>
+class ITK_EXPORT ShapeLabelObjectAttributesEvaluator :
+    public TImage::LabelObjectType::AttributesEvaluator
+{
+public:
+  /** Standard class typedefs. */
+  typedef ShapeLabelObjectAttributesEvaluator                   Self;
+  typedef typename TImage::LabelObjectType::AttributesEvaluator Superclass;
+  typedef SmartPointer<Self>                                    Pointer;
+  typedef SmartPointer<const Self>                              ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TImage                                          ImageType;
+  typedef typename ImageType::Pointer                     ImagePointer;
+  typedef typename ImageType::IndexType                   IndexType;
+  typedef typename ImageType::SpacingType                 SpacingType;
+  typedef typename ImageType::LabelObjectType             LabelObjectType;
+  typedef typename Superclass::ShapeLabelObjectType       ShapeLabelObjectType;
+  typedef typename ShapeLabelObjectType::AttributeGroupMaskType AttributeGroupMaskType;
+  typedef typename ShapeLabelObjectType::MatrixType       MatrixType;
+  typedef typename ShapeLabelObjectType::VectorType       VectorType;
+  typedef typename ShapeLabelObjectType::RegionType       RegionType;
+  typedef typename ShapeLabelObjectType::CentroidType     CentroidType;
+
+  typedef LabelMapPerimeterEstimationCalculator< ImageType >                PerimeterCalculatorType;
+  typedef typename PerimeterCalculatorType::RowIndexType                   RowIndexType;
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ShapeLabelObjectAttributesEvaluator, LightObject);
+
+  /**
+   * Set the label map used to get the geometry of the objects. Only the
+   * information of the label map is kept - not the label map itself.
+   */
+  void SetImage( const ImageType * image );
+
+  /** Compute and store the attributes of the given groups in the label object */
+  virtual void EvaluateAttributes( ShapeLabelObjectType * labelObject, const AttributeGroupMaskType & groups ) const;
+
+  /** Return the groups, and the groups they depend on. The groups a group depends
+   * on must be evaluated before, when the evaluator is not attached to the label object. */
+  static AttributeGroupMaskType GetRequiredGroups( const AttributeGroupMaskType & groups );
+
+  /** Compute the attributes of one group */
+  void EvaluateSizeAttributes( ShapeLabelObjectType * labelObject ) const;
+  void EvaluateBorderAttributes( ShapeLabelObjectType * labelObject ) const;
+  void EvaluateMomentsAttributes( ShapeLabelObjectType * labelObject ) const;
+  void EvaluateFeretDiameterAttributes( ShapeLabelObjectType * labelObject, const RowIndexType & rowIndex ) const;
+  void EvaluatePerimeterAttributes( ShapeLabelObjectType * labelObject, const RowIndexType & rowIndex ) const;
+
+  /** The sums accumulated on the lines of an object to compute the size, border
+   * and moments groups of attributes in a single pass. */
+  typedef typename ShapeLabelObjectType::LineSumsType LineAccumulatorType;
+
+  /** Compute the size, border and moments groups of attributes in a single pass
+   * on the lines of the object. Only the groups in the mask are computed. */
+  void EvaluateLineAttributes( ShapeLabelObjectType * labelObject, const AttributeGroupMaskType & groups ) const;
+
+  /** Compute the feret diameter and perimeter groups of attributes, if they are
+   * in the mask. */
+  void EvaluateRowAttributes( ShapeLabelObjectType * labelObject, const AttributeGroupMaskType & groups ) const;
+
+  /** The line accumulation, exposed so a valuator which already iterates over the
+   * lines of the objects can compute the shape attributes in the same pass:
+   * initialize the accumulator with the groups to compute, accumulate all the
+   * lines of the object, and set the attributes in the object. */
+  void InitializeLineAccumulator( LineAccumulatorType & accumulator, const AttributeGroupMaskType & groups ) const;
+  void AccumulateLine( LineAccumulatorType & accumulator, const IndexType & idx, unsigned long length ) const;
+  virtual void SetAccumulatedAttributes( ShapeLabelObjectType * labelObject, const LineAccumulatorType & accumulator ) const;
+
+  /** */
+  static long factorial( long n );
+
+  /** */
+  static long doubleFactorial( long n );
+
+  /** */
+  static double gammaN2p1( long n );
+
+  /** */
+  static double hyperSphereVolume( double radius );
+
+  /** */
+  static double hyperSpherePerimeter( double radius );
+
+  /** */
+  static double hyperSphereRadiusFromVolume( double volume );
+
+protected:
+  ShapeLabelObjectAttributesEvaluator();
+  ~ShapeLabelObjectAttributesEvaluator() {};
+
+private:
+  ShapeLabelObjectAttributesEvaluator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  ImagePointer                              m_Image;
+
+  double                                    m_SizePerPixel;
+  std::vector< double >                     m_SizePerPixelPerDimension;
+  IndexType                                 m_BorderMin;
+  IndexType                                 m_BorderMax;
+
+  typename PerimeterCalculatorType::Pointer m_PerimeterCalculator;
+
+}; // end of class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkShapeLabelObjectAttributesEvaluator.txx"
+#endif
+
+#endif
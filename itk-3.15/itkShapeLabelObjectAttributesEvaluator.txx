@@ -0,0 +1,622 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkShapeLabelObjectAttributesEvaluator.txx,v $
+  Language:  C++
+  Date:      $Date: 2005/08/23 15:09:03 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkShapeLabelObjectAttributesEvaluator_txx
+#define __itkShapeLabelObjectAttributesEvaluator_txx
+
+#include "itkShapeLabelObjectAttributesEvaluator.h"
+#include <deque>
+#include "itkPrincipalMomentsCalculator.h"
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+namespace itk {
+
+template <class TImage>
+ShapeLabelObjectAttributesEvaluator<TImage>
+::ShapeLabelObjectAttributesEvaluator()
+{
+  m_SizePerPixel = 1;
+  m_BorderMin.Fill( 0 );
+  m_BorderMax.Fill( 0 );
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::SetImage( const ImageType * image )
+{
+  // keep only the geometry of the label map - keeping the label map itself would
+  // create a reference loop when the evaluator is attached to the objects
+  m_Image = ImageType::New();
+  m_Image->CopyInformation( image );
+
+  // compute the size per pixel, to be used later
+  const SpacingType & spacing = m_Image->GetSpacing();
+  m_SizePerPixel = 1;
+  for( int i=0; i<ImageDimension; i++ )
+    {
+    m_SizePerPixel *= spacing[i];
+    }
+
+  m_SizePerPixelPerDimension.clear();
+  for( int i=0; i<ImageDimension; i++ )
+    {
+    m_SizePerPixelPerDimension.push_back( m_SizePerPixel / spacing[i] );
+    }
+
+  // compute the max the index on the border of the image
+  m_BorderMin = m_Image->GetLargestPossibleRegion().GetIndex();
+  m_BorderMax = m_BorderMin;
+  for( int i=0; i<ImageDimension; i++ )
+    {
+    m_BorderMax[i] += m_Image->GetLargestPossibleRegion().GetSize()[i] - 1;
+    }
+
+  m_PerimeterCalculator = PerimeterCalculatorType::New();
+  m_PerimeterCalculator->SetImage( m_Image );
+  m_PerimeterCalculator->Initialize();
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::EvaluateAttributes( ShapeLabelObjectType * labelObject, const AttributeGroupMaskType & groups ) const
+{
+  // the groups are computed in that order, so a group can use the attributes of
+  // the previous ones. The attributes of the groups not requested are read
+  // with the Get*() methods, and thus evaluated if required.
+  // The size, border and moments attributes are all accumulated in a single
+  // pass on the lines of the object.
+  const AttributeGroupMaskType lineGroups = groups & ( ShapeLabelObjectType::SIZE_ATTRIBUTES
+                                                     | ShapeLabelObjectType::BORDER_ATTRIBUTES
+                                                     | ShapeLabelObjectType::MOMENTS_ATTRIBUTES );
+  if( lineGroups != 0 )
+    {
+    this->EvaluateLineAttributes( labelObject, lineGroups );
+    }
+
+  // the lines of the object, indexed by row, are used for both the feret diameter
+  // and the perimeter
+  this->EvaluateRowAttributes( labelObject, groups );
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::EvaluateRowAttributes( ShapeLabelObjectType * labelObject, const AttributeGroupMaskType & groups ) const
+{
+  if( groups & ( ShapeLabelObjectType::FERET_DIAMETER_ATTRIBUTES | ShapeLabelObjectType::PERIMETER_ATTRIBUTES ) )
+    {
+    // the object passed to the evaluator is always an object of the label map
+    RowIndexType rowIndex( static_cast< LabelObjectType * >( labelObject ) );
+    if( groups & ShapeLabelObjectType::FERET_DIAMETER_ATTRIBUTES )
+      {
+      this->EvaluateFeretDiameterAttributes( labelObject, rowIndex );
+      }
+    if( groups & ShapeLabelObjectType::PERIMETER_ATTRIBUTES )
+      {
+      this->EvaluatePerimeterAttributes( labelObject, rowIndex );
+      }
+    }
+}
+
+
+template <class TImage>
+typename ShapeLabelObjectAttributesEvaluator<TImage>::AttributeGroupMaskType
+ShapeLabelObjectAttributesEvaluator<TImage>
+::GetRequiredGroups( const AttributeGroupMaskType & groups )
+{
+  AttributeGroupMaskType required = groups;
+  // the moments need the size and the centroid, and the roundness needs the
+  // equivalent perimeter
+  if( groups & ( ShapeLabelObjectType::MOMENTS_ATTRIBUTES | ShapeLabelObjectType::PERIMETER_ATTRIBUTES ) )
+    {
+    required |= ShapeLabelObjectType::SIZE_ATTRIBUTES;
+    }
+  return required;
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::EvaluateSizeAttributes( ShapeLabelObjectType * labelObject ) const
+{
+  this->EvaluateLineAttributes( labelObject, ShapeLabelObjectType::SIZE_ATTRIBUTES );
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::EvaluateBorderAttributes( ShapeLabelObjectType * labelObject ) const
+{
+  this->EvaluateLineAttributes( labelObject, ShapeLabelObjectType::BORDER_ATTRIBUTES );
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::EvaluateMomentsAttributes( ShapeLabelObjectType * labelObject ) const
+{
+  this->EvaluateLineAttributes( labelObject, ShapeLabelObjectType::MOMENTS_ATTRIBUTES );
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::EvaluateLineAttributes( ShapeLabelObjectType * labelObject, const AttributeGroupMaskType & groups ) const
+{
+  LineAccumulatorType accumulator;
+  this->InitializeLineAccumulator( accumulator, groups );
+
+  typename ShapeLabelObjectType::LineContainerType::const_iterator lit;
+  const typename ShapeLabelObjectType::LineContainerType & lineContainer = labelObject->GetLineContainer();
+
+  // iterate over all the lines
+  for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+    {
+    this->AccumulateLine( accumulator, lit->GetIndex(), lit->GetLength() );
+    }
+
+  this->SetAccumulatedAttributes( labelObject, accumulator );
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::InitializeLineAccumulator( LineAccumulatorType & accumulator, const AttributeGroupMaskType & groups ) const
+{
+  accumulator.Groups = groups & ( ShapeLabelObjectType::SIZE_ATTRIBUTES
+                                | ShapeLabelObjectType::BORDER_ATTRIBUTES
+                                | ShapeLabelObjectType::MOMENTS_ATTRIBUTES );
+  accumulator.Size = 0;
+  accumulator.Centroid.Fill( 0 );
+  accumulator.Minimum.Fill( NumericTraits< long >::max() );
+  accumulator.Maximum.Fill( NumericTraits< long >::NonpositiveMin() );
+  accumulator.SizeOnBorder = 0;
+  accumulator.PhysicalSizeOnBorder = 0;
+  accumulator.Moments.Fill( 0 );
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::AccumulateLine( LineAccumulatorType & accumulator, const IndexType & idx, unsigned long length ) const
+{
+  if( accumulator.Groups & ShapeLabelObjectType::SIZE_ATTRIBUTES )
+    {
+    // update the size
+    accumulator.Size += length;
+
+    // update the centroid - and report the progress
+    // first, update the axes which are not 0
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      accumulator.Centroid[i] += length * idx[i];
+      }
+    // then, update the axis 0
+    accumulator.Centroid[0] += idx[0] * length + ( length * ( length - 1 ) ) / 2.0;
+
+    // update the mins and maxs
+    for( int i=0; i<ImageDimension; i++)
+      {
+      if( idx[i] < accumulator.Minimum[i] )
+        {
+        accumulator.Minimum[i] = idx[i];
+        }
+      if( idx[i] > accumulator.Maximum[i] )
+        {
+        accumulator.Maximum[i] = idx[i];
+        }
+      }
+    // must fix the max for the axis 0
+    if( idx[0] + (long)length > accumulator.Maximum[0] )
+      {
+      accumulator.Maximum[0] = idx[0] + length - 1;
+      }
+    }
+
+  if( accumulator.Groups & ShapeLabelObjectType::BORDER_ATTRIBUTES )
+    {
+    // object is on a border ?
+    bool isOnBorder = false;
+    for( int i=1; i<ImageDimension; i++)
+      {
+      if( idx[i] == m_BorderMin[i] || idx[i] == m_BorderMax[i])
+        {
+        isOnBorder = true;
+        break;
+        }
+      }
+    if( isOnBorder )
+      {
+      // the line touch a border on a dimension other than 0, so
+      // all the line touch a border
+      accumulator.SizeOnBorder += length;
+      }
+    else
+      {
+      // we must check for the dimension 0
+      bool isOnBorder0 = false;
+      if( idx[0] == m_BorderMin[0] )
+        {
+        // one more pixel on the border
+        accumulator.SizeOnBorder++;
+        isOnBorder0 = true;
+        }
+      if( !isOnBorder0 || length > 1 )
+        {
+        // we can check for the end of the line
+        if( idx[0] + (long)length - 1 == m_BorderMax[0] )
+          {
+          // one more pixel on the border
+          accumulator.SizeOnBorder++;
+          }
+        }
+      }
+
+    // physical size on border
+    // first, the dimension 0
+    if( idx[0] == m_BorderMin[0] )
+      {
+      // the begining of the line
+      accumulator.PhysicalSizeOnBorder += m_SizePerPixelPerDimension[0];
+      }
+    if( idx[0] + (long)length - 1 == m_BorderMax[0] )
+      {
+      // and the end of the line
+      accumulator.PhysicalSizeOnBorder += m_SizePerPixelPerDimension[0];
+      }
+    // then the other dimensions
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      if( idx[i] == m_BorderMin[i] )
+        {
+        // one border
+        accumulator.PhysicalSizeOnBorder += m_SizePerPixelPerDimension[i] * length;
+        }
+      if( idx[i] == m_BorderMax[i] )
+        {
+        // and the other
+        accumulator.PhysicalSizeOnBorder += m_SizePerPixelPerDimension[i] * length;
+        }
+      }
+    }
+
+  if( accumulator.Groups & ShapeLabelObjectType::MOMENTS_ATTRIBUTES )
+    {
+    const SpacingType & spacing = m_Image->GetSpacing();
+    MatrixType & centralMoments = accumulator.Moments;
+
+    // moments computation
+// ****************************************************************
+// that commented code is the basic implementation. The next peace of code
+// give the same result in a much efficient way, by using expended formulae
+// allowed by the binary case instead of loops.
+// ****************************************************************
+//     long endIdx0 = idx[0] + length;
+//     for( IndexType iidx = idx; iidx[0]<endIdx0; iidx[0]++)
+//       {
+//       CentroidType pP;
+//       m_Image->TransformIndexToPhysicalPoint(iidx, pP);
+//
+//       for(unsigned int i=0; i<ImageDimension; i++)
+//         {
+//         for(unsigned int j=0; j<ImageDimension; j++)
+//           {
+//           centralMoments[i][j] += pP[i] * pP[j];
+//           }
+//         }
+//       }
+    // get the physical position - it is used several times later
+    CentroidType physicalPosition;
+    m_Image->TransformIndexToPhysicalPoint( idx, physicalPosition );
+    // the sum of x positions, also reused several times
+    double sumX = length * ( physicalPosition[0] + ( spacing[0] * ( length - 1 ) ) / 2.0 );
+    // the real job - the sum of square of x positions
+    // that's the central moments for dims 0, 0
+    centralMoments[0][0] += length * ( physicalPosition[0] * physicalPosition[0]
+            + spacing[0] * ( length - 1 ) * ( ( spacing[0] * ( 2 * length - 1 ) ) / 6.0 + physicalPosition[0] ) );
+    // the other ones
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      // do this one here to avoid the double assigment in the following loop
+      // when i == j
+      centralMoments[i][i] += length * physicalPosition[i] * physicalPosition[i];
+     // central moments are symetrics, so avoid to compute them 2 times
+      for( int j=i+1; j<ImageDimension; j++ )
+        {
+        // note that we won't use that code if the image dimension is less than 3
+        // --> the tests should be in 3D at least
+        double cm = length * physicalPosition[i] * physicalPosition[j];
+        centralMoments[i][j] += cm;
+        centralMoments[j][i] += cm;
+        }
+      // the last moments: the ones for the dimension 0
+      double cm = sumX * physicalPosition[i];
+      centralMoments[i][0] += cm;
+      centralMoments[0][i] += cm;
+      }
+    }
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::SetAccumulatedAttributes( ShapeLabelObjectType * labelObject, const LineAccumulatorType & accumulator ) const
+{
+  // keep the sums in the object, so the attributes can be merged with the ones
+  // of another object
+  labelObject->SetLineSums( accumulator, this );
+
+  // the size group first: the moments use its attributes
+  if( accumulator.Groups & ShapeLabelObjectType::SIZE_ATTRIBUTES )
+    {
+    const unsigned long & size = accumulator.Size;
+    const IndexType & mins = accumulator.Minimum;
+    const IndexType & maxs = accumulator.Maximum;
+    ContinuousIndex< double, ImageDimension> centroid;
+    for( int i=0; i<ImageDimension; i++ )
+      {
+      centroid[i] = accumulator.Centroid[i];
+      }
+
+    // final computation
+    typename ShapeLabelObjectType::RegionType::SizeType regionSize;
+    double minSize = NumericTraits< double >::max();
+    double maxSize = NumericTraits< double >::NonpositiveMin();
+    for( int i=0; i<ImageDimension; i++ )
+      {
+      centroid[i] /= size;
+      regionSize[i] = maxs[i] - mins[i] + 1;
+      double s = regionSize[i] * m_Image->GetSpacing()[i];
+      minSize = std::min( s, minSize );
+      maxSize = std::max( s, maxSize );
+      }
+    RegionType region( mins, regionSize );
+    CentroidType physicalCentroid;
+    m_Image->TransformContinuousIndexToPhysicalPoint( centroid, physicalCentroid );
+
+    double physicalSize = size * m_SizePerPixel;
+    double equivalentRadius = hyperSphereRadiusFromVolume( physicalSize );
+    double equivalentPerimeter = hyperSpherePerimeter( equivalentRadius );
+
+    // set the values in the object
+    labelObject->SetSize( size );
+    labelObject->SetPhysicalSize( physicalSize );
+    labelObject->SetRegion( region );
+    labelObject->SetCentroid( physicalCentroid );
+    labelObject->SetRegionElongation( maxSize / minSize );
+    labelObject->SetSizeRegionRatio( size / (double)region.GetNumberOfPixels() );
+    labelObject->SetEquivalentRadius( equivalentRadius );
+    labelObject->SetEquivalentPerimeter( equivalentPerimeter );
+    }
+
+  if( accumulator.Groups & ShapeLabelObjectType::BORDER_ATTRIBUTES )
+    {
+    labelObject->SetSizeOnBorder( accumulator.SizeOnBorder );
+    labelObject->SetPhysicalSizeOnBorder( accumulator.PhysicalSizeOnBorder );
+    }
+
+  if( accumulator.Groups & ShapeLabelObjectType::MOMENTS_ATTRIBUTES )
+    {
+    const SpacingType & spacing = m_Image->GetSpacing();
+    MatrixType centralMoments = accumulator.Moments;
+
+    // the size and the centroid are in the size group
+    const unsigned long & size = labelObject->GetSize();
+    const CentroidType & physicalCentroid = labelObject->GetCentroid();
+
+    // Center the second order moments
+    for(unsigned int i=0; i<ImageDimension; i++)
+      {
+      for(unsigned int j=0; j<ImageDimension; j++)
+        {
+        centralMoments[i][j] /= size;
+        centralMoments[i][j] -= physicalCentroid[i] * physicalCentroid[j];
+        }
+      }
+
+    // the normalized second order central moment of a pixel
+    for(unsigned int i=0; i<ImageDimension; i++)
+      {
+      centralMoments[i][i] += spacing[i] * spacing[i] / 12.0;
+      }
+
+    // Compute principal moments and axes
+    VectorType principalMoments;
+    MatrixType principalAxes;
+    // the axes are a proper rotation: the last one is reversed if needed
+    PrincipalMomentsCalculator< ImageDimension >::Compute( centralMoments, principalMoments, principalAxes );
+
+    double elongation = 0;
+    double flatness = 0;
+    if( ImageDimension < 2 )
+      {
+      elongation = 1;
+      flatness = 1;
+      }
+    else if( principalMoments[0] != 0 )
+      {
+  //    elongation = principalMoments[ImageDimension-1] / principalMoments[0];
+      elongation = vcl_sqrt(principalMoments[ImageDimension-1] / principalMoments[ImageDimension-2]);
+      flatness = vcl_sqrt(principalMoments[1] / principalMoments[0]);
+      }
+
+    // compute equilalent ellipsoid radius
+    const double & equivalentRadius = labelObject->GetEquivalentRadius();
+    VectorType ellipsoidSize;
+    double edet = 1.0;
+    for(unsigned int i=0; i<ImageDimension; i++)
+      {
+      edet *= principalMoments[i];
+      }
+    edet = vcl_pow( edet, 1.0/ImageDimension );
+    for(unsigned int i=0; i<ImageDimension; i++)
+      {
+      ellipsoidSize[i] = 2.0 * equivalentRadius * vcl_sqrt( principalMoments[i] / edet );
+      }
+
+    labelObject->SetBinaryPrincipalMoments( principalMoments );
+    labelObject->SetBinaryPrincipalAxes( principalAxes );
+    labelObject->SetBinaryElongation( elongation );
+    labelObject->SetEquivalentEllipsoidSize( ellipsoidSize );
+    labelObject->SetBinaryFlatness( flatness );
+    }
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::EvaluateFeretDiameterAttributes( ShapeLabelObjectType * labelObject, const RowIndexType & rowIndex ) const
+{
+  const SpacingType & spacing = m_Image->GetSpacing();
+
+  // get the pixels on the border of the object directly from the lines of
+  // the object and of its neighbor lines - no need to rasterize the label map
+  typedef typename std::deque< IndexType > IndexListType;
+  IndexListType idxList;
+  rowIndex.GetBorderIndexes( m_Image->GetLargestPossibleRegion(), idxList );
+
+  // we can now search the feret diameter
+  double feretDiameter = 0;
+  for( typename IndexListType::const_iterator iIt1 = idxList.begin();
+    iIt1 != idxList.end();
+    iIt1++ )
+    {
+    typename IndexListType::const_iterator iIt2 = iIt1;
+    for( iIt2++; iIt2 != idxList.end(); iIt2++ )
+      {
+      // Compute the length between the 2 indexes
+      double length = 0;
+      for( int i=0; i<ImageDimension; i++ )
+        {
+        length += vcl_pow( ( iIt1->operator[]( i ) - iIt2->operator[]( i ) ) * spacing[i], 2 );
+        }
+      if( feretDiameter < length )
+        {
+        feretDiameter = length;
+        }
+      }
+    }
+  // final computation
+  feretDiameter = vcl_sqrt( feretDiameter );
+
+  // finally put the values in the label object
+  labelObject->SetFeretDiameter( feretDiameter );
+}
+
+
+template <class TImage>
+void
+ShapeLabelObjectAttributesEvaluator<TImage>
+::EvaluatePerimeterAttributes( ShapeLabelObjectType * labelObject, const RowIndexType & rowIndex ) const
+{
+  // the calculator can't estimate the perimeter if the object is only on a border.
+  // It will occurre for sure when processing a 2D image with a 3D filter.
+  double perimeter = 0;
+  if( m_PerimeterCalculator->ComputePerimeter( rowIndex, perimeter ) )
+    {
+    labelObject->SetPerimeter( perimeter );
+    labelObject->SetRoundness( labelObject->GetEquivalentPerimeter() / perimeter );
+    }
+}
+
+
+template <class TImage>
+long
+ShapeLabelObjectAttributesEvaluator<TImage>
+::factorial( long n )
+{
+  if( n < 1 )
+    {
+    return 1;
+    }
+  return n * factorial( n - 1 );
+}
+
+
+template <class TImage>
+long
+ShapeLabelObjectAttributesEvaluator<TImage>
+::doubleFactorial( long n )
+{
+  if( n < 2 )
+    {
+    return 1;
+    }
+  return n * doubleFactorial( n - 2 );
+}
+
+
+template <class TImage>
+double
+ShapeLabelObjectAttributesEvaluator<TImage>
+::gammaN2p1( long n )
+{
+  bool even = n % 2 == 0;
+  if( even )
+    {
+    return factorial( n / 2 );
+    }
+  else
+    {
+    return  vcl_sqrt( PI ) * doubleFactorial( n ) / vcl_pow( 2, ( n + 1 ) / 2.0 );
+    }
+}
+
+
+template <class TImage>
+double
+ShapeLabelObjectAttributesEvaluator<TImage>
+::hyperSphereVolume( double radius )
+{
+  return vcl_pow( PI, ImageDimension / 2.0 ) * vcl_pow( radius, ImageDimension ) / gammaN2p1( ImageDimension );
+}
+
+
+template <class TImage>
+double
+ShapeLabelObjectAttributesEvaluator<TImage>
+::hyperSpherePerimeter( double radius )
+{
+  return ImageDimension * hyperSphereVolume( radius ) / radius;
+}
+
+
+template <class TImage>
+double
+ShapeLabelObjectAttributesEvaluator<TImage>
+::hyperSphereRadiusFromVolume( double volume )
+{
+  return vcl_pow( volume * gammaN2p1( ImageDimension ) / vcl_pow( PI, ImageDimension / 2.0 ), 1.0 / ImageDimension );
+}
+
+}// end namespace itk
+#endif
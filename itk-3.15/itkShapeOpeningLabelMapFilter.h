@@ -102,6 +102,15 @@ public:
     this->SetAttribute( LabelObjectType::GetAttributeFromName( s ) );
     }
 
+  /**
+   * Set/Get whether the removed objects are moved to the second output. When
+   * false, the removed objects are discarded and the second output is empty.
+   * Defaults to true.
+   */
+  itkGetConstMacro( StoreRemovedObjects, bool );
+  itkSetMacro( StoreRemovedObjects, bool );
+  itkBooleanMacro( StoreRemovedObjects );
+
 
 protected:
   ShapeOpeningLabelMapFilter();
@@ -116,6 +125,7 @@ protected:
   double        m_Lambda;
   bool          m_ReverseOrdering;
   AttributeType m_Attribute;
+  bool          m_StoreRemovedObjects;
 
 private:
   ShapeOpeningLabelMapFilter(const Self&); //purposely not implemented
@@ -30,6 +30,7 @@ ShapeOpeningLabelMapFilter<TImage>
   m_Lambda = NumericTraits< double >::Zero;
   m_ReverseOrdering = false;
   m_Attribute = LabelObjectType::SIZE;
+  m_StoreRemovedObjects = true;
   // create the output image for the removed objects
   this->SetNumberOfRequiredOutputs(2);
   this->SetNthOutput(1, static_cast<TImage*>(this->MakeOutput(1).GetPointer()));
@@ -114,28 +115,29 @@ ShapeOpeningLabelMapFilter<TImage>
 
   ProgressReporter progress( this, 0, labelObjectContainer.size() );
 
+  // select the kept objects in the order of the labels, and rebuild the
+  // label object container only once
+  typename ImageType::LabelObjectVectorType keptObjects;
   typename ImageType::LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
   while( it != labelObjectContainer.end() )
     {
-    typedef typename ImageType::LabelObjectType LabelObjectType;
-    typename LabelObjectType::LabelType label = it->first;
     LabelObjectType * labelObject = it->second;
 
-    if( ( !m_ReverseOrdering && accessor( labelObject ) < m_Lambda )
-      || ( m_ReverseOrdering && accessor( labelObject ) > m_Lambda ) )
+    const bool removed = ( !m_ReverseOrdering && accessor( labelObject ) < m_Lambda )
+      || ( m_ReverseOrdering && accessor( labelObject ) > m_Lambda );
+    if( !removed )
       {
-      // must increment the iterator before removing the object to avoid invalidating the iterator
-      it++;
-      output2->AddLabelObject( labelObject );
-      output->RemoveLabel( label );
-      }
-    else
-      {
-      it++;
+      keptObjects.push_back( labelObject );
       }
+    it++;
 
     progress.CompletedPixel();
     }
+
+  if( keptObjects.size() != labelObjectContainer.size() )
+    {
+    this->KeepLabelObjects( keptObjects, m_StoreRemovedObjects ? output2 : NULL );
+    }
 }
 
 
@@ -149,6 +151,7 @@ ShapeOpeningLabelMapFilter<TImage>
   os << indent << "ReverseOrdering: "  << m_ReverseOrdering << std::endl;
   os << indent << "Lambda: "  << m_Lambda << std::endl;
   os << indent << "Attribute: "  << LabelObjectType::GetNameFromAttribute(m_Attribute) << " (" << m_Attribute << ")" << std::endl;
+  os << indent << "StoreRemovedObjects: "  << m_StoreRemovedObjects << std::endl;
 }
 
 }// end namespace itk
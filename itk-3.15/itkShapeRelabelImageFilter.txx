@@ -89,6 +89,8 @@ ShapeRelabelImageFilter<TInputImage>
     {
     valuator->SetComputeFeretDiameter( true );
     }
+  // only compute the group of attributes which contains the attribute
+  valuator->SetComputedAttributes( LabelObjectType::GetAttributeGroup( m_Attribute ) );
   progress->RegisterInternalFilter(valuator, .3f);
   
   typename RelabelType::Pointer opening = RelabelType::New();
@@ -18,6 +18,7 @@
 #define __itkStatisticsLabelMapFilter_h
 
 #include "itkShapeLabelMapFilter.h"
+#include "itkFeatureRangeImageCalculator.h"
 
 namespace itk {
 /** \class StatisticsLabelMapFilter
@@ -26,6 +27,18 @@ namespace itk {
  * StatisticsCollectionImageFilter can be used to set the attributes values
  * of the StatisticsLabelObject in a LabelMap.
  *
+ * The groups of statistics attributes (INTENSITY_ATTRIBUTES, HIGHER_ORDER_ATTRIBUTES,
+ * WEIGHTED_MOMENTS_ATTRIBUTES, HISTOGRAM_ATTRIBUTES and QUANTILE_ATTRIBUTES) are
+ * selected with SetComputedAttributes(), in the same way as the shape ones. All
+ * of them but the quantiles are computed by default, and the histogram is only
+ * computed if ComputeHistogram is on. The median and the quantiles require to
+ * keep all the values of an object, so they are only computed when
+ * QUANTILE_ATTRIBUTES is in the computed attributes, when ComputeMedian is on,
+ * or when some quantiles are given with SetQuantiles().
+ *
+ * The size, border and moments shape attributes are accumulated in the same pass
+ * on the lines of the objects as the statistics, so the lines are only read once.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
@@ -56,6 +69,9 @@ public:
   typedef typename FeatureImageType::Pointer         FeatureImagePointer;
   typedef typename FeatureImageType::ConstPointer    FeatureImageConstPointer;
   typedef typename FeatureImageType::PixelType       FeatureImagePixelType;
+
+  typedef typename LabelObjectType::HistogramType       HistogramType;
+  typedef typename LabelObjectType::HistogramCountsType HistogramCountsType;
   
   /** ImageDimension constants */
   itkStaticConstMacro(ImageDimension, unsigned int,
@@ -104,24 +120,88 @@ public:
     this->SetFeatureImage( input );
     }
 
+  typedef typename Superclass::AttributeGroupMaskType AttributeGroupMaskType;
+  typedef typename Superclass::AttributesEvaluatorType AttributesEvaluatorType;
+
   /**
-   * Set/Get whether the histogram should be attached to the label object or not.
-   * This option defaults to `true`, but because the histogram may take a lot of memory
-   * compared to the other attributes, this option is useful to reduce the memory usage
-   * when the histogram is not required.
+   * Set/Get whether the histogram should be computed and attached to the label
+   * object or not. This option defaults to `false`, because the histogram may take
+   * a lot of memory compared to the other attributes. The median doesn't depend
+   * on the histogram.
    */
   itkSetMacro(ComputeHistogram, bool);
   itkGetConstReferenceMacro(ComputeHistogram, bool);
   itkBooleanMacro(ComputeHistogram);
 
   /**
-   * Set/Get the number of bins in the histogram. Note that the histogram is used
-   * to compute the median value, and that this option may have an effect on the
-   * value of the median.
+   * Set/Get the number of bins in the histogram.
    */
   itkSetMacro(NumberOfBins, unsigned int);
   itkGetConstReferenceMacro(NumberOfBins, unsigned int);
 
+  /**
+   * Set/Get whether the range of the histograms is the range of the values in the
+   * feature image. The range of the feature image is computed in parallel, and only
+   * when the feature image is modified. When this option is off, the range given
+   * with SetFeatureMinimum() and SetFeatureMaximum() is used instead, and the
+   * feature image is not read to find its range. The values out of the range go in
+   * the bins at the ends of the histograms. This option defaults to `true`.
+   */
+  itkSetMacro(ComputeFeatureRange, bool);
+  itkGetConstReferenceMacro(ComputeFeatureRange, bool);
+  itkBooleanMacro(ComputeFeatureRange);
+
+  /**
+   * Set/Get the range of the histograms, used when ComputeFeatureRange is off.
+   * The default is the full range of the pixel type. It must be set for the real
+   * pixel types, for which that range can't be divided in bins.
+   */
+  itkSetMacro(FeatureMinimum, FeatureImagePixelType);
+  itkGetConstReferenceMacro(FeatureMinimum, FeatureImagePixelType);
+  itkSetMacro(FeatureMaximum, FeatureImagePixelType);
+  itkGetConstReferenceMacro(FeatureMaximum, FeatureImagePixelType);
+
+  /**
+   * Set/Get whether the median should be computed or not. The default value is
+   * false, because all the values of an object must be stored to compute it.
+   * The median is also computed when QUANTILE_ATTRIBUTES is in the computed
+   * attributes, or when some quantiles are given.
+   */
+  itkSetMacro(ComputeMedian, bool);
+  itkGetConstReferenceMacro(ComputeMedian, bool);
+  itkBooleanMacro(ComputeMedian);
+
+  typedef typename LabelObjectType::QuantilesType QuantilesType;
+
+  /**
+   * Set/Get the probabilities, in the range [0, 1], of the quantiles to compute in
+   * addition to the median. The quantiles and the median are exact: they are
+   * computed by selection in the values of the pixels of the object. The default
+   * is to compute no other quantile than the median.
+   */
+  itkSetMacro(Quantiles, QuantilesType);
+  itkGetConstReferenceMacro(Quantiles, QuantilesType);
+
+  /**
+   * Set/Get whether the statistics still valid in the input objects are kept.
+   * When this option is on, the statistics are only computed for the objects
+   * which don't have all the requested groups of statistics - typically the
+   * objects modified by a merge, for which the statistics which can't be merged
+   * have been invalidated. The shape attributes are computed for all the objects.
+   * The feature image and the other options must be the ones used to compute
+   * the statistics kept. This option defaults to `false`.
+   */
+  itkSetMacro(ReuseEvaluatedAttributes, bool);
+  itkGetConstReferenceMacro(ReuseEvaluatedAttributes, bool);
+  itkBooleanMacro(ReuseEvaluatedAttributes);
+
+  /**
+   * Compute the quantiles of the given probabilities in values, by selection. The
+   * quantiles are linearly interpolated between the closest ranks. The values are
+   * reordered.
+   */
+  static void ComputeQuantiles( std::vector< FeatureImagePixelType > & values, const QuantilesType & probabilities, QuantilesType & quantiles );
+
 
 protected:
   StatisticsLabelMapFilter();
@@ -130,6 +210,8 @@ protected:
   virtual void ThreadedGenerateData( LabelObjectType * labelObject );
   
   virtual void BeforeThreadedGenerateData();
+
+  virtual void AfterThreadedGenerateData();
   
   void PrintSelf(std::ostream& os, Indent indent) const;
 
@@ -140,7 +222,24 @@ private:
   FeatureImagePixelType m_Minimum;
   FeatureImagePixelType m_Maximum;
   unsigned int          m_NumberOfBins;
+  bool                  m_ComputeFeatureRange;
+  FeatureImagePixelType m_FeatureMinimum;
+  FeatureImagePixelType m_FeatureMaximum;
   bool                  m_ComputeHistogram;
+  bool                  m_ComputeMedian;
+  bool                  m_ReuseEvaluatedAttributes;
+  QuantilesType         m_Quantiles;
+  MatrixType            m_IndexToPhysicalPointMatrix;
+
+  // the bins of the histograms, shared by all the objects
+  typename HistogramType::Pointer m_HistogramBins;
+  // the bin of each value, for the integer types with a small range
+  std::vector< unsigned int >     m_BinLookUpTable;
+
+  // kept between the updates, to compute the range of the feature image only
+  // when it is modified
+  typedef FeatureRangeImageCalculator< FeatureImageType > FeatureRangeCalculatorType;
+  typename FeatureRangeCalculatorType::Pointer m_FeatureRangeCalculator;
 
 }; // end of class
 
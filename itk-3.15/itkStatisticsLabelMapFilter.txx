@@ -18,10 +18,10 @@
 #define __itkStatisticsLabelMapFilter_txx
 
 #include "itkStatisticsLabelMapFilter.h"
-#include "itkMinimumMaximumImageCalculator.h"
 #include "itkProgressReporter.h"
-#include "vnl/algo/vnl_real_eigensystem.h"
-#include "vnl/algo/vnl_symmetric_eigensystem.h"
+#include "itkPrincipalMomentsCalculator.h"
+#include <algorithm>
+#include <vector>
 
 
 namespace itk {
@@ -31,8 +31,18 @@ StatisticsLabelMapFilter<TImage, TFeatureImage>
 ::StatisticsLabelMapFilter()
 {
   m_NumberOfBins = 128;
-  m_ComputeHistogram = true;
+  m_ComputeFeatureRange = true;
+  m_FeatureMinimum = NumericTraits< FeatureImagePixelType >::NonpositiveMin();
+  m_FeatureMaximum = NumericTraits< FeatureImagePixelType >::max();
+  m_FeatureRangeCalculator = FeatureRangeCalculatorType::New();
+  m_ComputeHistogram = false;
+  m_ComputeMedian = false;
+  m_ReuseEvaluatedAttributes = false;
   this->SetNumberOfRequiredInputs(2);
+  // the quantiles are only computed on demand: they require to store all the
+  // values of the objects
+  this->SetComputedAttributes( this->GetComputedAttributes()
+    | ( LabelObjectType::ALL_STATISTICS_ATTRIBUTES & ~LabelObjectType::QUANTILE_ATTRIBUTES ) );
 }
 
 
@@ -43,47 +53,183 @@ StatisticsLabelMapFilter<TImage, TFeatureImage>
 {
   Superclass::BeforeThreadedGenerateData();
 
+  // the linear part of the index to physical point transform, used to transform
+  // the weighted moments computed in the index space
+  const ImageType * output = this->GetOutput();
+  ContinuousIndex< double, ImageDimension > cidx;
+  cidx.Fill( 0 );
+  PointType origin;
+  output->TransformContinuousIndexToPhysicalPoint( cidx, origin );
+  for( unsigned int j=0; j<ImageDimension; j++ )
+    {
+    cidx.Fill( 0 );
+    cidx[j] = 1;
+    PointType p;
+    output->TransformContinuousIndexToPhysicalPoint( cidx, p );
+    for( unsigned int i=0; i<ImageDimension; i++ )
+      {
+      m_IndexToPhysicalPointMatrix[i][j] = p[i] - origin[i];
+      }
+    }
+
+  // the bounds are only used by the histograms
+  if( !m_ComputeHistogram || !( this->GetComputedAttributes() & LabelObjectType::HISTOGRAM_ATTRIBUTES ) )
+    {
+    return;
+    }
+
   // get the min and max of the feature image, to use those value as the bounds of our
-  // histograms
-  typedef MinimumMaximumImageCalculator< FeatureImageType > MinMaxCalculatorType;
-  typename MinMaxCalculatorType::Pointer minMax = MinMaxCalculatorType::New();
-  minMax->SetImage( this->GetFeatureImage() );
-  minMax->Compute();
+  // histograms. The range is only computed again if the feature image has been
+  // modified since the last update.
+  if( m_ComputeFeatureRange )
+    {
+    m_FeatureRangeCalculator->SetImage( this->GetFeatureImage() );
+    m_FeatureRangeCalculator->SetNumberOfThreads( this->GetNumberOfThreads() );
+    m_FeatureRangeCalculator->Compute();
+    m_Minimum = m_FeatureRangeCalculator->GetMinimum();
+    m_Maximum = m_FeatureRangeCalculator->GetMaximum();
+    }
+  else
+    {
+    if( m_FeatureMinimum > m_FeatureMaximum )
+      {
+      itkExceptionMacro( << "The feature minimum must be lower than the feature maximum." );
+      }
+    // the default range is the full range of the pixel type, which can't be
+    // divided in bins for the real types
+    if( !NumericTraits< FeatureImagePixelType >::is_integer
+      && m_FeatureMinimum == NumericTraits< FeatureImagePixelType >::NonpositiveMin()
+      && m_FeatureMaximum == NumericTraits< FeatureImagePixelType >::max() )
+      {
+      itkExceptionMacro( << "The feature minimum and maximum must be set when ComputeFeatureRange is off." );
+      }
+    m_Minimum = m_FeatureMinimum;
+    m_Maximum = m_FeatureMaximum;
+    }
 
-  m_Minimum = minMax->GetMinimum();
-  m_Maximum = minMax->GetMaximum();
+  // the bins of the histograms are the same for all the objects - they are created
+  // only once and shared by the objects. The frequencies of that histogram are not used.
+  typename HistogramType::SizeType histogramSize;
+  histogramSize.Fill( m_NumberOfBins );
+  typename HistogramType::MeasurementVectorType featureImageMin;
+  featureImageMin.Fill( m_Minimum );
+  typename HistogramType::MeasurementVectorType featureImageMax;
+  featureImageMax.Fill( m_Maximum );
+
+  m_HistogramBins = HistogramType::New();
+  m_HistogramBins->SetClipBinsAtEnds( false );
+  m_HistogramBins->Initialize( histogramSize, featureImageMin, featureImageMax );
 
+  // for the integer types with a small range, like unsigned char or short, the bin of
+  // all the possible values is stored in a look up table, to avoid searching the bin
+  // of each pixel
+  m_BinLookUpTable.clear();
+  if( NumericTraits< FeatureImagePixelType >::is_integer && sizeof( FeatureImagePixelType ) <= 2 )
+    {
+    m_BinLookUpTable.resize( (long)m_Maximum - (long)m_Minimum + 1 );
+    typename HistogramType::MeasurementVectorType mv;
+    typename HistogramType::IndexType index;
+    for( unsigned long i=0; i<m_BinLookUpTable.size(); i++ )
+      {
+      mv[0] = (long)m_Minimum + (long)i;
+      m_HistogramBins->GetIndex( mv, index );
+      m_BinLookUpTable[i] = index[0];
+      }
+    }
 }
 
 
 template <class TImage, class TFeatureImage>
 void
 StatisticsLabelMapFilter<TImage, TFeatureImage>
-::ThreadedGenerateData( LabelObjectType * labelObject )
+::AfterThreadedGenerateData()
 {
-  Superclass::ThreadedGenerateData( labelObject );
+  Superclass::AfterThreadedGenerateData();
+
+  // the bins are kept by the objects which need them
+  m_HistogramBins = NULL;
+  m_BinLookUpTable.clear();
+}
+
 
+template <class TImage, class TFeatureImage>
+void
+StatisticsLabelMapFilter<TImage, TFeatureImage>
+::ThreadedGenerateData( LabelObjectType * labelObject )
+{
   ImageType * output = this->GetOutput();
   const FeatureImageType * featureImage = this->GetFeatureImage();
 
-  typedef typename LabelObjectType::HistogramType HistogramType;
+  // only compute the requested groups of attributes
+  const AttributeGroupMaskType & computedAttributes = this->GetComputedAttributes();
+  bool computeIntensity = ( computedAttributes & LabelObjectType::INTENSITY_ATTRIBUTES ) != 0;
+  bool computeHigherOrder = ( computedAttributes & LabelObjectType::HIGHER_ORDER_ATTRIBUTES ) != 0;
+  bool computeWeightedMoments = ( computedAttributes & LabelObjectType::WEIGHTED_MOMENTS_ATTRIBUTES ) != 0;
+  bool computeHistogram = m_ComputeHistogram && ( computedAttributes & LabelObjectType::HISTOGRAM_ATTRIBUTES ) != 0;
+  bool computeQuantiles = ( computedAttributes & LabelObjectType::QUANTILE_ATTRIBUTES ) != 0
+    || m_ComputeMedian || !m_Quantiles.empty();
+  if( !computeIntensity && !computeHigherOrder && !computeWeightedMoments && !computeHistogram && !computeQuantiles )
+    {
+    Superclass::ThreadedGenerateData( labelObject );
+    return;
+    }
 
-  typename HistogramType::SizeType histogramSize;
-  histogramSize.Fill( m_NumberOfBins );
-  typename HistogramType::MeasurementVectorType featureImageMin;
-  featureImageMin.Fill( m_Minimum );
-  typename HistogramType::MeasurementVectorType featureImageMax;
-  featureImageMax.Fill( m_Maximum );
+  // the statistics groups computed for this object
+  AttributeGroupMaskType statisticsGroups = computedAttributes & LabelObjectType::ALL_STATISTICS_ATTRIBUTES;
+  if( !computeHistogram )
+    {
+    statisticsGroups &= ~LabelObjectType::HISTOGRAM_ATTRIBUTES;
+    }
+  if( computeQuantiles )
+    {
+    statisticsGroups |= LabelObjectType::QUANTILE_ATTRIBUTES;
+    }
 
-  typename HistogramType::Pointer histogram = HistogramType::New();
-  histogram->SetClipBinsAtEnds( false );
-  histogram->Initialize( histogramSize, featureImageMin, featureImageMax );
+  if( m_ReuseEvaluatedAttributes
+    && ( labelObject->GetEvaluatedAttributes() & statisticsGroups ) == statisticsGroups )
+    {
+    // the statistics are still valid - only the shape attributes are computed
+    Superclass::ThreadedGenerateData( labelObject );
+    return;
+    }
+  labelObject->SetEvaluatedAttributes( labelObject->GetEvaluatedAttributes() & ~LabelObjectType::ALL_STATISTICS_ATTRIBUTES );
+
+  // the shape attributes read on the lines are accumulated in the same pass as the
+  // statistics, unless they are evaluated lazily
+  const AttributesEvaluatorType * evaluator = this->GetAttributesEvaluator();
+  AttributeGroupMaskType shapeGroups = 0;
+  if( this->GetLazyEvaluation() )
+    {
+    Superclass::ThreadedGenerateData( labelObject );
+    }
+  else
+    {
+    labelObject->SetAttributesEvaluator( NULL );
+    shapeGroups = this->GetEvaluatedShapeAttributes();
+    }
+  typename AttributesEvaluatorType::LineAccumulatorType shapeAccumulator;
+  evaluator->InitializeLineAccumulator( shapeAccumulator, shapeGroups );
+
+  // the values of the pixels of the object, to compute the quantiles by selection
+  std::vector< FeatureImagePixelType > values;
+
+  // the histogram is stored as compact counts, and is only converted to a
+  // full histogram if it is requested
+  HistogramCountsType histogramCounts;
+  if( computeHistogram )
+    {
+    histogramCounts.resize( m_NumberOfBins, 0 );
+    }
+  const bool useBinLookUpTable = !m_BinLookUpTable.empty();
+  const long lookUpTableMax = (long)m_BinLookUpTable.size() - 1;
+  const long lookUpTableOrigin = (long)m_Minimum;
 
   typename LabelObjectType::LineContainerType::const_iterator lit;
   typename LabelObjectType::LineContainerType & lineContainer = labelObject->GetLineContainer();
 
   FeatureImagePixelType min = NumericTraits< FeatureImagePixelType >::max();
   FeatureImagePixelType max = NumericTraits< FeatureImagePixelType >::NonpositiveMin();
+  unsigned long size = 0;
   double sum = 0;
   double sum2 = 0;
   double sum3 = 0;
@@ -101,58 +247,172 @@ StatisticsLabelMapFilter<TImage, TFeatureImage>
   VectorType principalMoments;
   principalMoments.Fill( 0 );
 
+  // the weighted moments are accumulated in the index space, relatively to the
+  // first index of the object to keep the values small, and are transformed to
+  // the physical space only once per object
+  IndexType referenceIdx;
+  referenceIdx.Fill( 0 );
+  if( !lineContainer.empty() )
+    {
+    referenceIdx = lineContainer.begin()->GetIndex();
+    }
+  VectorType indexSums;
+  indexSums.Fill( 0 );
+  MatrixType indexMoments;
+  indexMoments.Fill( 0 );
+
+  // read the pixels directly in the buffer of the feature image
+  const FeatureImagePixelType * featureBuffer = featureImage->GetBufferPointer();
+
   // iterate over all the lines
   for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
     {
     const IndexType & firstIdx = lit->GetIndex();
-    unsigned long length = lit->GetLength();
+    const long length = lit->GetLength();
+    size += length;
+    const FeatureImagePixelType * run = featureBuffer + featureImage->ComputeOffset( firstIdx );
+    evaluator->AccumulateLine( shapeAccumulator, firstIdx, length );
+
+    // the sums and the min and max values of the run. The loop has no branch
+    // and no dependency between the iterations except the accumulators, so it
+    // can be vectorized by the compiler.
+    double runSum = 0;
+    double runSum2 = 0;
+    double runSum3 = 0;
+    double runSum4 = 0;
+    FeatureImagePixelType runMin = run[0];
+    FeatureImagePixelType runMax = run[0];
+    if( computeHigherOrder )
+      {
+      for( long i=0; i<length; i++ )
+        {
+        const double v = run[i];
+        const double v2 = v * v;
+        runSum += v;
+        runSum2 += v2;
+        runSum3 += v2 * v;
+        runSum4 += v2 * v2;
+        }
+      }
+    else
+      {
+      for( long i=0; i<length; i++ )
+        {
+        const double v = run[i];
+        runSum += v;
+        runSum2 += v * v;
+        }
+      }
+    for( long i=1; i<length; i++ )
+      {
+      runMin = std::min( runMin, run[i] );
+      runMax = std::max( runMax, run[i] );
+      }
+    sum += runSum;
+    sum2 += runSum2;
+    sum3 += runSum3;
+    sum4 += runSum4;
+
+    // update min and max. As before, the index is the one of the last pixel with
+    // the min or max value, so it is searched from the end of the run only when the
+    // run contains the new min or max.
+    if( runMin <= min )
+      {
+      min = runMin;
+      long i = length - 1;
+      while( run[i] != runMin )
+        {
+        i--;
+        }
+      minIdx = firstIdx;
+      minIdx[0] += i;
+      }
+    if( runMax >= max )
+      {
+      max = runMax;
+      long i = length - 1;
+      while( run[i] != runMax )
+        {
+        i--;
+        }
+      maxIdx = firstIdx;
+      maxIdx[0] += i;
+      }
 
-    typename HistogramType::MeasurementVectorType mv;
-    long endIdx0 = firstIdx[0] + length;
-    for( IndexType idx = firstIdx; idx[0]<endIdx0; idx[0]++)
+    if( computeQuantiles )
       {
-      const FeatureImagePixelType & v = featureImage->GetPixel( idx );
-      mv[0] = v;
-      histogram->IncreaseFrequency( mv, 1 );
+      values.insert( values.end(), run, run + length );
+      }
 
-      // update min and max
-      if( v <= min )
+    if( computeHistogram && useBinLookUpTable )
+      {
+      for( long i=0; i<length; i++ )
         {
-        min = v;
-        minIdx = idx;
+        // the values out of the range of the table go in the bins at the ends
+        const long v = std::max( 0L, std::min( (long)run[i] - lookUpTableOrigin, lookUpTableMax ) );
+        histogramCounts[ m_BinLookUpTable[v] ]++;
         }
-      if( v >= max )
+      }
+    else if( computeHistogram )
+      {
+      typename HistogramType::MeasurementVectorType mv;
+      typename HistogramType::IndexType index;
+      for( long i=0; i<length; i++ )
         {
-        max = v;
-        maxIdx = idx;
+        mv[0] = run[i];
+        m_HistogramBins->GetIndex( mv, index );
+        histogramCounts[ index[0] ]++;
         }
+      }
 
-      //increase the sums
-      sum += v;
-      sum2 += vcl_pow( (double)v, 2 );
-      sum3 += vcl_pow( (double)v, 3 );
-      sum4 += vcl_pow( (double)v, 4 );
-
-      // moments
-      PointType physicalPosition;
-      output->TransformIndexToPhysicalPoint(idx, physicalPosition);
-      for(unsigned int i=0; i<ImageDimension; i++)
+    // moments
+    if( computeWeightedMoments )
+      {
+      // the sums of v * i and v * i^2 along the run, with i the position in the run
+      double runSumI = 0;
+      double runSumI2 = 0;
+      for( long i=0; i<length; i++ )
         {
-        centerOfGravity[i] += physicalPosition[i] * v; 
-        centralMoments[i][i] += v * physicalPosition[i] * physicalPosition[i];
-        for(unsigned int j=i+1; j<ImageDimension; j++)
+        const double vi = run[i] * (double)i;
+        runSumI += vi;
+        runSumI2 += vi * i;
+        }
+      // the position of the run relatively to the reference index
+      VectorType d;
+      for( unsigned int i=0; i<ImageDimension; i++ )
+        {
+        d[i] = firstIdx[i] - referenceIdx[i];
+        }
+      // the sum of v * x for the dimension 0 - also reused for the cross moments
+      const double sumX0 = d[0] * runSum + runSumI;
+      indexSums[0] += sumX0;
+      indexMoments[0][0] += d[0] * d[0] * runSum + 2.0 * d[0] * runSumI + runSumI2;
+      for( unsigned int i=1; i<ImageDimension; i++ )
+        {
+        indexSums[i] += d[i] * runSum;
+        const double cm = d[i] * sumX0;
+        indexMoments[0][i] += cm;
+        indexMoments[i][0] += cm;
+        for( unsigned int j=i; j<ImageDimension; j++ )
           {
-          double weight = v * physicalPosition[i] * physicalPosition[j];
-          centralMoments[i][j] += weight;
-          centralMoments[j][i] += weight;
+          const double cm2 = d[i] * d[j] * runSum;
+          indexMoments[i][j] += cm2;
+          if( j != i )
+            {
+            indexMoments[j][i] += cm2;
+            }
           }
         }
-
       }
     }
 
+  // the shape attributes. The feret diameter and the perimeter need the
+  // neighbor lines, and are computed separately.
+  evaluator->SetAccumulatedAttributes( labelObject, shapeAccumulator );
+  evaluator->EvaluateRowAttributes( labelObject, shapeGroups );
+
   // final computations
-  const typename HistogramType::FrequencyType & totalFreq = histogram->GetTotalFrequency();
+  const double totalFreq = size;
   double mean = sum / totalFreq;
   double variance = ( sum2 - ( vcl_pow( sum, 2 ) / totalFreq ) ) / ( totalFreq - 1 );
   double sigma = vcl_sqrt( variance );
@@ -160,44 +420,41 @@ StatisticsLabelMapFilter<TImage, TFeatureImage>
   double skewness = ( ( sum3 - 3.0 * mean * sum2) / totalFreq + 2.0 * mean * mean2 ) / ( variance * sigma );
   double kurtosis = ( ( sum4 - 4.0 * mean * sum3 + 6.0 * mean2 * sum2) / totalFreq - 3.0 * mean2 * mean2 ) / ( variance * variance ) - 3.0;
 
-  // the median
+  // the median and the other quantiles
   double median = 0;
-  double count = 0;  // will not be fully set, so do not use later !
-  for( unsigned long i=0;
-    i<histogram->Size();
-    i++)
+  QuantilesType quantiles;
+  if( computeQuantiles )
     {
-    count += histogram->GetFrequency( i );
-
-    if( count >= ( totalFreq / 2 ) )
-      {
-      median = histogram->GetMeasurementVector( i )[0];
-      break;
-      }
+    QuantilesType probabilities = m_Quantiles;
+    probabilities.push_back( 0.5 );
+    ComputeQuantiles( values, probabilities, quantiles );
+    median = quantiles.back();
+    quantiles.pop_back();
     }
 
   double elongation = 0;
   double flatness = 0;
-  if( sum != 0 )
+  if( computeWeightedMoments && sum != 0 )
     {
-    // Normalize using the total mass
+    // Normalize using the total mass, and center the second order moments, in the
+    // index space
+    ContinuousIndex< double, ImageDimension > indexCenterOfGravity;
     for(unsigned int i=0; i<ImageDimension; i++)
       {
-      centerOfGravity[i] /= sum;
-      for(unsigned int j=0; j<ImageDimension; j++)
-        {
-        centralMoments[i][j] /= sum;
-        }
+      indexSums[i] /= sum;
+      indexCenterOfGravity[i] = referenceIdx[i] + indexSums[i];
       }
-  
-    // Center the second order moments
     for(unsigned int i=0; i<ImageDimension; i++)
       {
       for(unsigned int j=0; j<ImageDimension; j++)
         {
-        centralMoments[i][j] -= centerOfGravity[i] * centerOfGravity[j];
+        indexMoments[i][j] = indexMoments[i][j] / sum - indexSums[i] * indexSums[j];
         }
       }
+
+    // then transform them in the physical space
+    output->TransformContinuousIndexToPhysicalPoint( indexCenterOfGravity, centerOfGravity );
+    centralMoments = m_IndexToPhysicalPointMatrix * indexMoments * m_IndexToPhysicalPointMatrix.GetTranspose();
   
     // the normalized second order central moment of a pixel
     for(unsigned int i=0; i<ImageDimension; i++)
@@ -206,30 +463,8 @@ StatisticsLabelMapFilter<TImage, TFeatureImage>
       }
 
     // Compute principal moments and axes
-    vnl_symmetric_eigensystem<double> eigen( centralMoments.GetVnlMatrix() );
-    vnl_diag_matrix<double> pm = eigen.D;
-    for(unsigned int i=0; i<ImageDimension; i++)
-      {
-  //    principalMoments[i] = 4 * vcl_sqrt( pm(i,i) );
-      principalMoments[i] = pm(i,i);
-      }
-    principalAxes = eigen.V.transpose();
-  
-    // Add a final reflection if needed for a proper rotation,
-    // by multiplying the last row by the determinant
-    vnl_real_eigensystem eigenrot( principalAxes.GetVnlMatrix() );
-    vnl_diag_matrix< vcl_complex<double> > eigenval = eigenrot.D;
-    vcl_complex<double> det( 1.0, 0.0 );
-  
-    for(unsigned int i=0; i<ImageDimension; i++)
-      {
-      det *= eigenval( i, i );
-      }
-  
-    for(unsigned int i=0; i<ImageDimension; i++)
-      {
-      principalAxes[ ImageDimension-1 ][i] *= std::real( det );
-      }
+    // the axes are a proper rotation: the last one is reversed if needed
+    PrincipalMomentsCalculator< ImageDimension >::Compute( centralMoments, principalMoments, principalAxes );
   
     if( ImageDimension < 2 )
       {
@@ -259,27 +494,85 @@ StatisticsLabelMapFilter<TImage, TFeatureImage>
     }
 
   // finally put the values in the label object
-  labelObject->SetMinimum( (double)min );
-  labelObject->SetMaximum( (double)max );
-  labelObject->SetSum( sum );
-  labelObject->SetMean( mean );
-  labelObject->SetMedian( median );
-  labelObject->SetVariance( variance );
-  labelObject->SetSigma( sigma );
-  labelObject->SetMinimumIndex( minIdx );
-  labelObject->SetMaximumIndex( maxIdx );
-  labelObject->SetCenterOfGravity( centerOfGravity );
-  labelObject->SetPrincipalAxes( principalAxes );
-  labelObject->SetPrincipalMoments( principalMoments );
-//  labelObject->SetCentralMoments( centralMoments );
-  labelObject->SetSkewness( skewness );
-  labelObject->SetKurtosis( kurtosis );
-  labelObject->SetElongation( elongation );
-  if( m_ComputeHistogram )
+  if( computeIntensity )
+    {
+    labelObject->SetMinimum( (double)min );
+    labelObject->SetMaximum( (double)max );
+    labelObject->SetSum( sum );
+    labelObject->SetMean( mean );
+    labelObject->SetVariance( variance );
+    labelObject->SetSigma( sigma );
+    labelObject->SetMinimumIndex( minIdx );
+    labelObject->SetMaximumIndex( maxIdx );
+    }
+  if( computeWeightedMoments )
+    {
+    labelObject->SetCenterOfGravity( centerOfGravity );
+    labelObject->SetPrincipalAxes( principalAxes );
+    labelObject->SetPrincipalMoments( principalMoments );
+  //  labelObject->SetCentralMoments( centralMoments );
+    labelObject->SetElongation( elongation );
+    }
+  if( computeHigherOrder )
+    {
+    labelObject->SetSkewness( skewness );
+    labelObject->SetKurtosis( kurtosis );
+    }
+  if( computeHistogram )
+    {
+    labelObject->SetHistogramCounts( m_HistogramBins, histogramCounts );
+    }
+  if( computeQuantiles )
+    {
+    labelObject->SetMedian( median );
+    labelObject->SetQuantiles( m_Quantiles, quantiles );
+    }
+
+  // keep track of the statistics computed, so the ones which can't be merged
+  // are known to be invalid after the merge of two objects
+  labelObject->SetEvaluatedAttributes( labelObject->GetEvaluatedAttributes() | statisticsGroups );
+
+}
+
+
+template <class TImage, class TFeatureImage>
+void
+StatisticsLabelMapFilter<TImage, TFeatureImage>
+::ComputeQuantiles( std::vector< FeatureImagePixelType > & values, const QuantilesType & probabilities, QuantilesType & quantiles )
+{
+  quantiles.resize( probabilities.size() );
+  if( values.empty() )
     {
-    labelObject->SetHistogram( histogram );
+    std::fill( quantiles.begin(), quantiles.end(), 0.0 );
+    return;
     }
 
+  // process the quantiles in increasing order, so each selection is done in
+  // the values not already known to be lower than the previous quantile
+  std::vector< std::pair< double, unsigned int > > order;
+  for( unsigned int i=0; i<probabilities.size(); i++ )
+    {
+    order.push_back( std::make_pair( std::max( 0.0, std::min( probabilities[i], 1.0 ) ), i ) );
+    }
+  std::sort( order.begin(), order.end() );
+
+  typename std::vector< FeatureImagePixelType >::iterator first = values.begin();
+  for( unsigned int i=0; i<order.size(); i++ )
+    {
+    double h = ( values.size() - 1 ) * order[i].first;
+    unsigned long k = (unsigned long)vcl_floor( h );
+    typename std::vector< FeatureImagePixelType >::iterator kth = values.begin() + k;
+    std::nth_element( first, kth, values.end() );
+    double q = *kth;
+    if( h > k )
+      {
+      // interpolate with the next value - the smallest one after the k-th
+      double next = *std::min_element( kth + 1, values.end() );
+      q += ( h - k ) * ( next - q );
+      }
+    quantiles[ order[i].second ] = q;
+    first = kth;
+    }
 }
 
 
@@ -291,7 +584,20 @@ StatisticsLabelMapFilter<TImage, TFeatureImage>
   Superclass::PrintSelf(os,indent);
   
   os << indent << "ComputeHistogram: " << m_ComputeHistogram << std::endl;
+  os << indent << "ComputeMedian: " << m_ComputeMedian << std::endl;
+  os << indent << "ReuseEvaluatedAttributes: " << m_ReuseEvaluatedAttributes << std::endl;
   os << indent << "NumberOfBins: " << m_NumberOfBins << std::endl;
+  os << indent << "ComputeFeatureRange: " << m_ComputeFeatureRange << std::endl;
+  os << indent << "FeatureMinimum: "
+     << static_cast<typename NumericTraits<FeatureImagePixelType>::PrintType>(m_FeatureMinimum) << std::endl;
+  os << indent << "FeatureMaximum: "
+     << static_cast<typename NumericTraits<FeatureImagePixelType>::PrintType>(m_FeatureMaximum) << std::endl;
+  os << indent << "Quantiles:";
+  for( unsigned int i=0; i<m_Quantiles.size(); i++ )
+    {
+    os << " " << m_Quantiles[i];
+    }
+  os << std::endl;
 }
 
 
@@ -19,6 +19,8 @@
 
 #include "itkShapeLabelObject.h"
 #include "itkHistogram.h"
+#include <algorithm>
+#include <vector>
 
 namespace itk
 {
@@ -269,6 +271,12 @@ public:
  *
  * StatisticsLabelObject stores  the common attributes related to the statistics of the object
  *
+ * The getters of the statistics throw an exception when their group of attributes
+ * has not been computed, or is not valid anymore after the merge of two objects
+ * - see MergeAttributesFrom(). GetHistogram() returns NULL in that case.
+ * StatisticsLabelMapFilter can compute them again, only for the objects which
+ * need it with ReuseEvaluatedAttributes set to true.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * \ingroup DataRepresentation 
@@ -333,6 +341,56 @@ public:
   static const AttributeType HISTOGRAM=216;
   static const AttributeType FLATNESS=217;
 
+  /** The groups of statistics attributes - see ShapeLabelObject for the shape ones */
+  typedef typename Superclass::AttributeGroupMaskType AttributeGroupMaskType;
+  /** Minimum, Maximum, MinimumIndex, MaximumIndex, Sum, Mean, Variance and Sigma */
+  static const AttributeGroupMaskType INTENSITY_ATTRIBUTES=32;
+  /** Skewness and Kurtosis */
+  static const AttributeGroupMaskType HIGHER_ORDER_ATTRIBUTES=64;
+  /** CenterOfGravity, PrincipalMoments, PrincipalAxes, Elongation and Flatness */
+  static const AttributeGroupMaskType WEIGHTED_MOMENTS_ATTRIBUTES=128;
+  /** Histogram */
+  static const AttributeGroupMaskType HISTOGRAM_ATTRIBUTES=256;
+  /** Median and Quantiles */
+  static const AttributeGroupMaskType QUANTILE_ATTRIBUTES=512;
+  static const AttributeGroupMaskType ALL_STATISTICS_ATTRIBUTES=992;
+
+  /** Return the group of an attribute */
+  static AttributeGroupMaskType GetAttributeGroup( const AttributeType & a )
+    {
+    switch( a )
+      {
+      case MINIMUM:
+      case MAXIMUM:
+      case MEAN:
+      case SUM:
+      case SIGMA:
+      case VARIANCE:
+      case MAXIMUM_INDEX:
+      case MINIMUM_INDEX:
+        return INTENSITY_ATTRIBUTES;
+        break;
+      case KURTOSIS:
+      case SKEWNESS:
+        return HIGHER_ORDER_ATTRIBUTES;
+        break;
+      case CENTER_OF_GRAVITY:
+      case PRINCIPAL_MOMENTS:
+      case PRINCIPAL_AXES:
+      case ELONGATION:
+      case FLATNESS:
+        return WEIGHTED_MOMENTS_ATTRIBUTES;
+        break;
+      case HISTOGRAM:
+        return HISTOGRAM_ATTRIBUTES;
+        break;
+      case MEDIAN:
+        return QUANTILE_ATTRIBUTES;
+        break;
+      }
+    return Superclass::GetAttributeGroup( a );
+    }
+
   static AttributeType GetAttributeFromName( const std::string & s )
     {
     if( s == "Minimum" )
@@ -496,6 +554,8 @@ public:
     m_Sigma = src->m_Sigma;
     m_Variance = src->m_Variance;
     m_Median = src->m_Median;
+    m_QuantileProbabilities = src->m_QuantileProbabilities;
+    m_QuantileValues = src->m_QuantileValues;
     m_MaximumIndex = src->m_MaximumIndex;
     m_MinimumIndex = src->m_MinimumIndex;
     m_CenterOfGravity = src->m_CenterOfGravity;
@@ -506,127 +566,279 @@ public:
     m_Skewness = src->m_Skewness;
     m_Elongation = src->m_Elongation;
     m_Histogram = src->m_Histogram;
+    m_HistogramBins = src->m_HistogramBins;
+    m_HistogramCounts = src->m_HistogramCounts;
+    m_HistogramCountBins = src->m_HistogramCountBins;
     m_Flatness = src->m_Flatness;
     }
 
+  /**
+   * Update the attributes after the lines of lo, disjoint from the ones of this
+   * object, have been added to this object. In addition to the shape attributes,
+   * the intensity attributes are merged when the sizes of both objects are known,
+   * and the histograms are merged when they share the same bins. The other
+   * statistics - the higher order ones, the weighted moments and the quantiles -
+   * can't be merged: their groups are marked as not evaluated, and false is
+   * returned if they had been computed.
+   */
+  virtual bool MergeAttributesFrom( const LabelObjectType * lo )
+    {
+    // the sizes and the evaluated groups must be read before the merge of the
+    // shape attributes
+    const Self * src = dynamic_cast<const Self *>( lo );
+    const AttributeGroupMaskType groups = this->GetEvaluatedAttributes() & ALL_STATISTICS_ATTRIBUTES;
+    const AttributeGroupMaskType srcGroups = src != NULL ? src->GetEvaluatedAttributes() & ALL_STATISTICS_ATTRIBUTES : 0;
+    const bool mergeIntensity = src != NULL
+      && ( this->GetLineSums().Groups & src->GetLineSums().Groups & Superclass::SIZE_ATTRIBUTES );
+    const double n1 = this->GetLineSums().Size;
+    const double n2 = mergeIntensity ? src->GetLineSums().Size : 0.0;
+
+    bool upToDate = Superclass::MergeAttributesFrom( lo );
+
+    // the statistics groups still valid after the merge
+    AttributeGroupMaskType mergedGroups = 0;
+    if( src != NULL && mergeIntensity && n1 > 0 && n2 > 0 )
+      {
+      // combine the sums of the squared deviations to the mean
+      const double n = n1 + n2;
+      const double ss1 = n1 > 1 ? m_Variance * ( n1 - 1 ) : 0.0;
+      const double ss2 = n2 > 1 ? src->m_Variance * ( n2 - 1 ) : 0.0;
+      const double delta = src->m_Mean - m_Mean;
+      m_Sum += src->m_Sum;
+      m_Mean = m_Sum / n;
+      m_Variance = ( ss1 + ss2 + delta * delta * n1 * n2 / n ) / ( n - 1 );
+      m_Sigma = vcl_sqrt( m_Variance );
+      if( src->m_Minimum < m_Minimum )
+        {
+        m_Minimum = src->m_Minimum;
+        m_MinimumIndex = src->m_MinimumIndex;
+        }
+      if( src->m_Maximum > m_Maximum )
+        {
+        m_Maximum = src->m_Maximum;
+        m_MaximumIndex = src->m_MaximumIndex;
+        }
+      mergedGroups |= groups & srcGroups & INTENSITY_ATTRIBUTES;
+      }
+
+    if( src != NULL && m_HistogramBins.IsNotNull() && m_HistogramBins == src->m_HistogramBins )
+      {
+      // the counts can simply be added
+      HistogramCountsType counts = this->GetHistogramCounts();
+      for( unsigned long i=0; i<src->m_HistogramCounts.size(); i++ )
+        {
+        if( src->m_HistogramCountBins.empty() )
+          {
+          counts[i] += src->m_HistogramCounts[i];
+          }
+        else
+          {
+          counts[ src->m_HistogramCountBins[i] ] += src->m_HistogramCounts[i];
+          }
+        }
+      this->SetHistogramCounts( m_HistogramBins, counts );
+      mergedGroups |= groups & srcGroups & HISTOGRAM_ATTRIBUTES;
+      }
+
+    // the groups not merged must be computed again - their getters throw an
+    // exception until then
+    this->ResetStatisticsAttributes( ALL_STATISTICS_ATTRIBUTES & ~mergedGroups );
+    this->SetEvaluatedAttributes( ( this->GetEvaluatedAttributes() & ~ALL_STATISTICS_ATTRIBUTES ) | mergedGroups );
+    return upToDate && ( ( groups | srcGroups ) & ~mergedGroups ) == 0;
+    }
+
+  /**
+   * Mark all the attributes as not evaluated. Return false if some statistics
+   * had been computed, because they can't be computed again without the
+   * feature image: their getters throw an exception until they are computed
+   * again by StatisticsLabelMapFilter.
+   */
+  virtual bool InvalidateAttributes()
+    {
+    const AttributeGroupMaskType groups = this->GetEvaluatedAttributes() & ALL_STATISTICS_ATTRIBUTES;
+    this->ResetStatisticsAttributes( ALL_STATISTICS_ATTRIBUTES );
+    return Superclass::InvalidateAttributes() && groups == 0;
+    }
+
 //   itkGetConstMacro( Minimum, double );
 //   itkSetMacro( Minimum, double );
   const double & GetMinimum() const
     {
+    this->CheckStatisticsAttributes( INTENSITY_ATTRIBUTES );
     return m_Minimum;
     }
 
   void SetMinimum( const double & v )
     {
     m_Minimum = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | INTENSITY_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Maximum, double );
 //   itkSetMacro( Maximum, double );
   const double & GetMaximum() const
     {
+    this->CheckStatisticsAttributes( INTENSITY_ATTRIBUTES );
     return m_Maximum;
     }
 
   void SetMaximum( const double & v )
     {
     m_Maximum = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | INTENSITY_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Mean, double );
 //   itkSetMacro( Mean, double );
   const double & GetMean() const
     {
+    this->CheckStatisticsAttributes( INTENSITY_ATTRIBUTES );
     return m_Mean;
     }
 
   void SetMean( const double & v )
     {
     m_Mean = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | INTENSITY_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Sum, double );
 //   itkSetMacro( Sum, double );
   const double & GetSum() const
     {
+    this->CheckStatisticsAttributes( INTENSITY_ATTRIBUTES );
     return m_Sum;
     }
 
   void SetSum( const double & v )
     {
     m_Sum = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | INTENSITY_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Sigma, double );
 //   itkSetMacro( Sigma, double );
   const double & GetSigma() const
     {
+    this->CheckStatisticsAttributes( INTENSITY_ATTRIBUTES );
     return m_Sigma;
     }
 
   void SetSigma( const double & v )
     {
     m_Sigma = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | INTENSITY_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Variance, double );
 //   itkSetMacro( Variance, double );
   const double & GetVariance() const
     {
+    this->CheckStatisticsAttributes( INTENSITY_ATTRIBUTES );
     return m_Variance;
     }
 
   void SetVariance( const double & v )
     {
     m_Variance = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | INTENSITY_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Median, double );
 //   itkSetMacro( Median, double );
   const double & GetMedian() const
     {
+    this->CheckStatisticsAttributes( QUANTILE_ATTRIBUTES );
     return m_Median;
     }
 
   void SetMedian( const double & v )
     {
     m_Median = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | QUANTILE_ATTRIBUTES );
+    }
+
+  /** The probabilities and the values of the quantiles */
+  typedef std::vector< double > QuantilesType;
+
+  /**
+   * Set/Get the exact quantiles of the pixel values. The values are the ones of the
+   * quantiles of the given probabilities, in the range [0, 1].
+   */
+  void SetQuantiles( const QuantilesType & probabilities, const QuantilesType & values )
+    {
+    m_QuantileProbabilities = probabilities;
+    m_QuantileValues = values;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | QUANTILE_ATTRIBUTES );
+    }
+
+  const QuantilesType & GetQuantileProbabilities() const
+    {
+    this->CheckStatisticsAttributes( QUANTILE_ATTRIBUTES );
+    return m_QuantileProbabilities;
+    }
+
+  const QuantilesType & GetQuantileValues() const
+    {
+    this->CheckStatisticsAttributes( QUANTILE_ATTRIBUTES );
+    return m_QuantileValues;
+    }
+
+  /** Return the value of the quantile of probability p. An exception is thrown if
+   * that quantile has not been computed. */
+  const double & GetQuantile( double p ) const
+    {
+    this->CheckStatisticsAttributes( QUANTILE_ATTRIBUTES );
+    for( unsigned int i=0; i<m_QuantileProbabilities.size(); i++ )
+      {
+      if( m_QuantileProbabilities[i] == p )
+        {
+        return m_QuantileValues[i];
+        }
+      }
+    itkGenericExceptionMacro( << "The quantile " << p << " has not been computed." );
     }
 
 //   itkGetConstMacro( MaximumIndex, IndexType );
 //   itkSetMacro( MaximumIndex, IndexType );
   const IndexType & GetMaximumIndex() const
     {
+    this->CheckStatisticsAttributes( INTENSITY_ATTRIBUTES );
     return m_MaximumIndex;
     }
 
   void SetMaximumIndex( const IndexType & v )
     {
     m_MaximumIndex = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | INTENSITY_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( MinimumIndex, IndexType );
 //   itkSetMacro( MinimumIndex, IndexType );
   const IndexType & GetMinimumIndex() const
     {
+    this->CheckStatisticsAttributes( INTENSITY_ATTRIBUTES );
     return m_MinimumIndex;
     }
 
   void SetMinimumIndex( const IndexType & v )
     {
     m_MinimumIndex = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | INTENSITY_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( CenterOfGravity, PointType );
 //   itkSetMacro( CenterOfGravity, PointType );
   const PointType & GetCenterOfGravity() const
     {
+    this->CheckStatisticsAttributes( WEIGHTED_MOMENTS_ATTRIBUTES );
     return m_CenterOfGravity;
     }
 
   void SetCenterOfGravity( const PointType & v )
     {
     m_CenterOfGravity = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | WEIGHTED_MOMENTS_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( CentralMoments, MatrixType );
@@ -645,84 +857,214 @@ public:
 //   itkSetMacro( PrincipalMoments, VectorType );
   const VectorType & GetPrincipalMoments() const
     {
+    this->CheckStatisticsAttributes( WEIGHTED_MOMENTS_ATTRIBUTES );
     return m_PrincipalMoments;
     }
 
   void SetPrincipalMoments( const VectorType & v )
     {
     m_PrincipalMoments = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | WEIGHTED_MOMENTS_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( PrincipalAxes, MatrixType );
 //   itkSetMacro( PrincipalAxes, MatrixType );
   const MatrixType & GetPrincipalAxes() const
     {
+    this->CheckStatisticsAttributes( WEIGHTED_MOMENTS_ATTRIBUTES );
     return m_PrincipalAxes;
     }
 
   void SetPrincipalAxes( const MatrixType & v )
     {
     m_PrincipalAxes = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | WEIGHTED_MOMENTS_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Skewness, double );
 //   itkSetMacro( Skewness, double );
   const double & GetSkewness() const
     {
+    this->CheckStatisticsAttributes( HIGHER_ORDER_ATTRIBUTES );
     return m_Skewness;
     }
 
   void SetSkewness( const double & v )
     {
     m_Skewness = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | HIGHER_ORDER_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Kurtosis, double );
 //   itkSetMacro( Kurtosis, double );
   const double & GetKurtosis() const
     {
+    this->CheckStatisticsAttributes( HIGHER_ORDER_ATTRIBUTES );
     return m_Kurtosis;
     }
 
   void SetKurtosis( const double & v )
     {
     m_Kurtosis = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | HIGHER_ORDER_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Elongation, double );
 //   itkSetMacro( Elongation, double );
   const double & GetElongation() const
     {
+    this->CheckStatisticsAttributes( WEIGHTED_MOMENTS_ATTRIBUTES );
     return m_Elongation;
     }
 
   void SetElongation( const double & v )
     {
     m_Elongation = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | WEIGHTED_MOMENTS_ATTRIBUTES );
     }
 
 //   itkGetConstMacro( Histogram, double );
 //   itkSetMacro( Histogram, double );
+  /** Return NULL if the histogram is not computed, or not valid anymore. */
   const HistogramType * GetHistogram() const
     {
+    if( !( this->GetEvaluatedAttributes() & HISTOGRAM_ATTRIBUTES ) )
+      {
+      return NULL;
+      }
+    if( m_Histogram.IsNull() && m_HistogramBins.IsNotNull() )
+      {
+      // build the histogram from the compact counts on the first access
+      typename HistogramType::Pointer histogram = HistogramType::New();
+      histogram->SetClipBinsAtEnds( false );
+      typename HistogramType::MeasurementVectorType lower;
+      lower[0] = m_HistogramBins->GetBinMin( 0, 0 );
+      typename HistogramType::MeasurementVectorType upper;
+      upper[0] = m_HistogramBins->GetBinMax( 0, m_HistogramBins->Size() - 1 );
+      histogram->Initialize( m_HistogramBins->GetSize(), lower, upper );
+      for( unsigned long i=0; i<m_HistogramCounts.size(); i++ )
+        {
+        if( m_HistogramCountBins.empty() )
+          {
+          histogram->SetFrequency( i, m_HistogramCounts[i] );
+          }
+        else
+          {
+          histogram->SetFrequency( m_HistogramCountBins[i], m_HistogramCounts[i] );
+          }
+        }
+      m_Histogram = histogram;
+      }
     return m_Histogram;
     }
 
   void SetHistogram( const HistogramType * v )
     {
     m_Histogram = v;
+    m_HistogramBins = NULL;
+    m_HistogramCounts.clear();
+    m_HistogramCountBins.clear();
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | HISTOGRAM_ATTRIBUTES );
+    }
+
+  /** The number of pixels in each bin of a histogram. */
+  typedef std::vector< unsigned int > HistogramCountsType;
+
+  /**
+   * Set the histogram as compact counts - one count per bin. The bins are described
+   * by the histogram bins, which are shared by all the objects of a label map - their
+   * frequencies are not used. The counts of the histograms with mostly empty bins,
+   * like the ones of the small objects, are stored sparsely: only the non empty bins
+   * are kept. The content of the counts passed as parameter is undefined after the
+   * call - they may be swapped with the previous counts of the label object.
+   * The full histogram, which doesn't clip the bins at ends, is built only
+   * if GetHistogram() is called. As for the lazy
+   * evaluation of the shape attributes, this is not thread safe.
+   */
+  void SetHistogramCounts( const HistogramType * bins, HistogramCountsType & counts )
+    {
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | HISTOGRAM_ATTRIBUTES );
+    m_Histogram = NULL;
+    m_HistogramBins = bins;
+    m_HistogramCountBins.clear();
+    unsigned long nonEmptyBins = counts.size() - std::count( counts.begin(), counts.end(), 0U );
+    if( nonEmptyBins > 0 && 2 * nonEmptyBins < counts.size() )
+      {
+      // a bin number and a count for each non empty bin take less memory
+      HistogramCountsType sparseCounts( nonEmptyBins );
+      m_HistogramCountBins.resize( nonEmptyBins );
+      unsigned long j = 0;
+      for( unsigned long i=0; i<counts.size(); i++ )
+        {
+        if( counts[i] != 0 )
+          {
+          m_HistogramCountBins[j] = i;
+          sparseCounts[j] = counts[i];
+          j++;
+          }
+        }
+      m_HistogramCounts.swap( sparseCounts );
+      }
+    else
+      {
+      m_HistogramCounts.swap( counts );
+      }
+    }
+
+  /** Return the counts of all the bins of the histogram. */
+  HistogramCountsType GetHistogramCounts() const
+    {
+    if( m_HistogramCountBins.empty() )
+      {
+      return m_HistogramCounts;
+      }
+    HistogramCountsType counts( m_HistogramBins->Size(), 0 );
+    for( unsigned long i=0; i<m_HistogramCounts.size(); i++ )
+      {
+      counts[ m_HistogramCountBins[i] ] = m_HistogramCounts[i];
+      }
+    return counts;
+    }
+
+  /** Return the count of a bin of the histogram. */
+  unsigned int GetHistogramCount( unsigned long bin ) const
+    {
+    if( m_HistogramCountBins.empty() )
+      {
+      return bin < m_HistogramCounts.size() ? m_HistogramCounts[bin] : 0;
+      }
+    typename HistogramCountsType::const_iterator it =
+      std::lower_bound( m_HistogramCountBins.begin(), m_HistogramCountBins.end(), bin );
+    if( it != m_HistogramCountBins.end() && *it == bin )
+      {
+      return m_HistogramCounts[ it - m_HistogramCountBins.begin() ];
+      }
+    return 0;
+    }
+
+  /** Return whether the counts of the histogram are stored sparsely. */
+  bool GetHistogramCountsAreSparse() const
+    {
+    return !m_HistogramCountBins.empty();
+    }
+
+  const HistogramType * GetHistogramBins() const
+    {
+    return m_HistogramBins;
     }
 
 //   itkGetConstMacro( Flatness, double );
 //   itkSetMacro( Flatness, double );
   const double & GetFlatness() const
     {
+    this->CheckStatisticsAttributes( WEIGHTED_MOMENTS_ATTRIBUTES );
     return m_Flatness;
     }
 
   void SetFlatness( const double & v )
     {
     m_Flatness = v;
+    this->SetEvaluatedAttributes( this->GetEvaluatedAttributes() | WEIGHTED_MOMENTS_ATTRIBUTES );
     }
 
 
@@ -737,6 +1079,7 @@ public:
    * the principal axes coordinate system to physical coordinates. */
   AffineTransformPointer GetPrincipalAxesToPhysicalAxesTransform() const
     {
+    this->CheckStatisticsAttributes( WEIGHTED_MOMENTS_ATTRIBUTES );
     typename AffineTransformType::MatrixType matrix;
     typename AffineTransformType::OffsetType offset;
     for (unsigned int i = 0; i < ImageDimension; i++) 
@@ -762,6 +1105,7 @@ public:
    * system. */
   AffineTransformPointer GetPhysicalAxesToPrincipalAxesTransform(void) const
     {
+    this->CheckStatisticsAttributes( WEIGHTED_MOMENTS_ATTRIBUTES );
     typename AffineTransformType::MatrixType matrix;
     typename AffineTransformType::OffsetType offset;
     for (unsigned int i = 0; i < ImageDimension; i++) 
@@ -804,10 +1148,66 @@ protected:
     m_Skewness = 0;
     m_Elongation = 0;
     m_Histogram = NULL;
+    m_HistogramBins = NULL;
     m_Flatness = 0;
     }
   
 
+  /**
+   * Throw an exception if the statistics of the group have not been computed,
+   * or are not valid anymore after a merge.
+   */
+  void CheckStatisticsAttributes( const AttributeGroupMaskType & group ) const
+    {
+    if( !( this->GetEvaluatedAttributes() & group ) )
+      {
+      itkGenericExceptionMacro( << "The statistics attributes of the group " << group
+        << " are not computed, or are not valid anymore after a merge. Use StatisticsLabelMapFilter to compute them." );
+      }
+    }
+
+  /** Reset the statistics of the groups to their default values. */
+  void ResetStatisticsAttributes( const AttributeGroupMaskType & groups )
+    {
+    if( groups & INTENSITY_ATTRIBUTES )
+      {
+      m_Minimum = 0;
+      m_Maximum = 0;
+      m_Mean = 0;
+      m_Sum = 0;
+      m_Sigma = 0;
+      m_Variance = 0;
+      m_MaximumIndex.Fill(0);
+      m_MinimumIndex.Fill(0);
+      }
+    if( groups & HIGHER_ORDER_ATTRIBUTES )
+      {
+      m_Kurtosis = 0;
+      m_Skewness = 0;
+      }
+    if( groups & WEIGHTED_MOMENTS_ATTRIBUTES )
+      {
+      m_CenterOfGravity.Fill(0);
+      m_PrincipalMoments.Fill(0);
+      m_PrincipalAxes.Fill(0);
+      m_Elongation = 0;
+      m_Flatness = 0;
+      }
+    if( groups & HISTOGRAM_ATTRIBUTES )
+      {
+      m_Histogram = NULL;
+      m_HistogramBins = NULL;
+      m_HistogramCounts.clear();
+      m_HistogramCountBins.clear();
+      }
+    if( groups & QUANTILE_ATTRIBUTES )
+      {
+      m_Median = 0;
+      m_QuantileProbabilities.clear();
+      m_QuantileValues.clear();
+      }
+    }
+
   void PrintSelf(std::ostream& os, Indent indent) const
     {
     Superclass::PrintSelf( os, indent );
@@ -819,6 +1219,12 @@ protected:
     os << indent << "Sigma: " << m_Sigma << std::endl;
     os << indent << "Variance: " << m_Variance << std::endl;
     os << indent << "Median: " << m_Median << std::endl;
+    os << indent << "Quantiles:";
+    for( unsigned int i=0; i<m_QuantileProbabilities.size(); i++ )
+      {
+      os << " " << m_QuantileProbabilities[i] << ": " << m_QuantileValues[i];
+      }
+    os << std::endl;
     os << indent << "MaximumIndex: " << m_MaximumIndex << std::endl;
     os << indent << "MinimumIndex: " << m_MinimumIndex << std::endl;
     os << indent << "CenterOfGravity: " << m_CenterOfGravity << std::endl;
@@ -829,13 +1235,22 @@ protected:
     os << indent << "Kurtosis: " << m_Kurtosis << std::endl;
     os << indent << "Elongation: " << m_Elongation << std::endl;
     os << indent << "Histogram: ";
-    if( m_Histogram.IsNull() )
+    if( m_Histogram.IsNotNull() )
       {
-      os << "NULL" << std::endl;
+      m_Histogram->Print( os, indent );
+      }
+    else if( m_HistogramBins.IsNotNull() )
+      {
+      os << m_HistogramBins->Size() << " bins (compact";
+      if( !m_HistogramCountBins.empty() )
+        {
+        os << ", " << m_HistogramCountBins.size() << " non empty bins";
+        }
+      os << ")" << std::endl;
       }
     else
       {
-      m_Histogram->Print( os, indent );
+      os << "NULL" << std::endl;
       }
     os << indent << "Flatness: " << m_Flatness << std::endl;
     }
@@ -851,6 +1266,8 @@ private:
   double                               m_Sigma;
   double                               m_Variance;
   double                               m_Median;
+  QuantilesType                        m_QuantileProbabilities;
+  QuantilesType                        m_QuantileValues;
   IndexType                            m_MaximumIndex;
   IndexType                            m_MinimumIndex;
   PointType                            m_CenterOfGravity;
@@ -860,7 +1277,11 @@ private:
   double                               m_Skewness;
   double                               m_Kurtosis;
   double                               m_Elongation;
-  typename HistogramType::ConstPointer m_Histogram;
+  mutable typename HistogramType::ConstPointer m_Histogram;
+  typename HistogramType::ConstPointer m_HistogramBins;
+  HistogramCountsType                  m_HistogramCounts;
+  // the bins of the counts, when they are sparse
+  HistogramCountsType                  m_HistogramCountBins;
   double                               m_Flatness;
 
 };
@@ -0,0 +1,132 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkVectorStatisticsLabelMapFilter.h,v $
+  Language:  C++
+  Date:      $Date: 2006/03/28 19:59:05 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkVectorStatisticsLabelMapFilter_h
+#define __itkVectorStatisticsLabelMapFilter_h
+
+#include "itkShapeLabelMapFilter.h"
+#include "itkDefaultConvertPixelTraits.h"
+
+namespace itk {
+/** \class VectorStatisticsLabelMapFilter
+ * \brief The valuator class for the VectorStatisticsLabelObject
+ *
+ * VectorStatisticsLabelMapFilter computes the statistics of all the channels of a
+ * multi-channel feature image - an image of RGBPixel, of Vector, or a VectorImage -
+ * and stores them in the VectorStatisticsLabelObject of a LabelMap, in addition to
+ * the shape attributes. All the channels are read in a single pass on the
+ * lines of the objects: the channels of a pixel are interleaved in the buffer of
+ * the feature image, and are all accumulated at the same time.
+ *
+ * The groups of attributes (CHANNEL_INTENSITY_ATTRIBUTES and
+ * CHANNEL_COVARIANCE_ATTRIBUTES) are selected with SetComputedAttributes(),
+ * in the same way as the shape ones. All of them are computed by default.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa VectorStatisticsLabelObject, StatisticsLabelMapFilter
+ * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
+ */
+template<class TImage, class TFeatureImage>
+class ITK_EXPORT VectorStatisticsLabelMapFilter :
+    public ShapeLabelMapFilter<TImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef VectorStatisticsLabelMapFilter Self;
+  typedef ShapeLabelMapFilter<TImage>    Superclass;
+  typedef SmartPointer<Self>             Pointer;
+  typedef SmartPointer<const Self>       ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TImage                               ImageType;
+  typedef typename ImageType::Pointer          ImagePointer;
+  typedef typename ImageType::ConstPointer     ImageConstPointer;
+  typedef typename ImageType::PixelType        PixelType;
+  typedef typename ImageType::IndexType        IndexType;
+  typedef typename ImageType::LabelObjectType  LabelObjectType;
+  typedef typename LabelObjectType::ChannelVectorType ChannelVectorType;
+  typedef typename LabelObjectType::ChannelMatrixType ChannelMatrixType;
+
+  typedef TFeatureImage                              FeatureImageType;
+  typedef typename FeatureImageType::Pointer         FeatureImagePointer;
+  typedef typename FeatureImageType::ConstPointer    FeatureImageConstPointer;
+  typedef typename FeatureImageType::PixelType       FeatureImagePixelType;
+
+  /** The type of the channels of the feature image, as stored in its buffer */
+  typedef typename DefaultConvertPixelTraits< typename FeatureImageType::InternalPixelType >::ComponentType
+                                                     FeatureImageComponentType;
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(VectorStatisticsLabelMapFilter,
+               ShapeLabelMapFilter);
+
+   /** Set the feature image */
+  void SetFeatureImage(const TFeatureImage *input)
+    {
+    // Process object is not const-correct so the const casting is required.
+    this->SetNthInput( 1, const_cast<TFeatureImage *>(input) );
+    }
+
+  /** Get the feature image */
+  FeatureImageType * GetFeatureImage()
+    {
+    return static_cast<FeatureImageType*>(const_cast<DataObject *>(this->ProcessObject::GetInput(1)));
+    }
+
+   /** Set the input image */
+  void SetInput1(TImage *input)
+    {
+    this->SetInput( input );
+    }
+
+  /** Set the feature image */
+  void SetInput2(const TFeatureImage *input)
+    {
+    this->SetFeatureImage( input );
+    }
+
+  typedef typename Superclass::AttributeGroupMaskType AttributeGroupMaskType;
+
+
+protected:
+  VectorStatisticsLabelMapFilter();
+  ~VectorStatisticsLabelMapFilter() {};
+
+  virtual void ThreadedGenerateData( LabelObjectType * labelObject );
+
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+private:
+  VectorStatisticsLabelMapFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+}; // end of class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkVectorStatisticsLabelMapFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkVectorStatisticsLabelMapFilter.txx,v $
+  Language:  C++
+  Date:      $Date: 2005/08/23 15:09:03 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkVectorStatisticsLabelMapFilter_txx
+#define __itkVectorStatisticsLabelMapFilter_txx
+
+#include "itkVectorStatisticsLabelMapFilter.h"
+#include <algorithm>
+#include <vector>
+
+
+namespace itk {
+
+template <class TImage, class TFeatureImage>
+VectorStatisticsLabelMapFilter<TImage, TFeatureImage>
+::VectorStatisticsLabelMapFilter()
+{
+  this->SetNumberOfRequiredInputs(2);
+  this->SetComputedAttributes( this->GetComputedAttributes() | LabelObjectType::ALL_CHANNEL_STATISTICS_ATTRIBUTES );
+}
+
+
+template <class TImage, class TFeatureImage>
+void
+VectorStatisticsLabelMapFilter<TImage, TFeatureImage>
+::ThreadedGenerateData( LabelObjectType * labelObject )
+{
+  Superclass::ThreadedGenerateData( labelObject );
+
+  const FeatureImageType * featureImage = this->GetFeatureImage();
+
+  // only compute the requested groups of attributes
+  const AttributeGroupMaskType & computedAttributes = this->GetComputedAttributes();
+  bool computeIntensity = ( computedAttributes & LabelObjectType::CHANNEL_INTENSITY_ATTRIBUTES ) != 0;
+  bool computeCovariance = ( computedAttributes & LabelObjectType::CHANNEL_COVARIANCE_ATTRIBUTES ) != 0;
+  if( !computeIntensity && !computeCovariance )
+    {
+    return;
+    }
+
+  const unsigned int numberOfChannels = featureImage->GetNumberOfComponentsPerPixel();
+
+  // the channels of a pixel are contiguous in the buffer, for the images of RGBPixel
+  // or Vector as well as for the VectorImage, so the buffer is read as an array of
+  // channels
+  const FeatureImageComponentType * featureBuffer =
+    reinterpret_cast< const FeatureImageComponentType * >( featureImage->GetBufferPointer() );
+
+  typename LabelObjectType::LineContainerType::const_iterator lit;
+  typename LabelObjectType::LineContainerType & lineContainer = labelObject->GetLineContainer();
+
+  // the sums are accumulated relatively to the value of the first pixel of the
+  // object, to reduce the cancellation in the computation of the (co)variance
+  std::vector< double > reference( numberOfChannels, 0.0 );
+  if( !lineContainer.empty() )
+    {
+    const FeatureImageComponentType * first = featureBuffer
+      + featureImage->ComputeOffset( lineContainer.begin()->GetIndex() ) * numberOfChannels;
+    for( unsigned int c=0; c<numberOfChannels; c++ )
+      {
+      reference[c] = first[c];
+      }
+    }
+
+  std::vector< FeatureImageComponentType > min( numberOfChannels, NumericTraits< FeatureImageComponentType >::max() );
+  std::vector< FeatureImageComponentType > max( numberOfChannels, NumericTraits< FeatureImageComponentType >::NonpositiveMin() );
+  std::vector< double > sum( numberOfChannels, 0.0 );
+  // the sums of the products of the channels, in a row major matrix. Only the upper
+  // triangle is accumulated - or only the diagonal, without the covariance.
+  std::vector< double > sumProducts( numberOfChannels * numberOfChannels, 0.0 );
+  std::vector< double > d( numberOfChannels );
+  unsigned long size = 0;
+
+  // iterate over all the lines
+  for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+    {
+    const IndexType & firstIdx = lit->GetIndex();
+    const long length = lit->GetLength();
+    size += length;
+    const FeatureImageComponentType * p = featureBuffer + featureImage->ComputeOffset( firstIdx ) * numberOfChannels;
+
+    for( long i=0; i<length; i++, p+=numberOfChannels )
+      {
+      for( unsigned int c=0; c<numberOfChannels; c++ )
+        {
+        min[c] = std::min( min[c], p[c] );
+        max[c] = std::max( max[c], p[c] );
+        d[c] = p[c] - reference[c];
+        sum[c] += d[c];
+        }
+      if( computeCovariance )
+        {
+        for( unsigned int c=0; c<numberOfChannels; c++ )
+          {
+          double * row = &sumProducts[ c * numberOfChannels ];
+          for( unsigned int e=c; e<numberOfChannels; e++ )
+            {
+            row[e] += d[c] * d[e];
+            }
+          }
+        }
+      else
+        {
+        for( unsigned int c=0; c<numberOfChannels; c++ )
+          {
+          sumProducts[ c * numberOfChannels + c ] += d[c] * d[c];
+          }
+        }
+      }
+    }
+
+  // final computations
+  const double totalFreq = size;
+  ChannelMatrixType covariance( numberOfChannels, numberOfChannels );
+  covariance.Fill( 0 );
+  for( unsigned int c=0; c<numberOfChannels; c++ )
+    {
+    for( unsigned int e=c; e<numberOfChannels; e++ )
+      {
+      if( ( computeCovariance || e == c ) && size > 1 )
+        {
+        covariance( c, e ) = ( sumProducts[ c * numberOfChannels + e ] - sum[c] * sum[e] / totalFreq ) / ( totalFreq - 1 );
+        covariance( e, c ) = covariance( c, e );
+        }
+      }
+    }
+
+  if( computeIntensity )
+    {
+    ChannelVectorType minimum( numberOfChannels );
+    ChannelVectorType maximum( numberOfChannels );
+    ChannelVectorType sums( numberOfChannels );
+    ChannelVectorType mean( numberOfChannels );
+    ChannelVectorType variance( numberOfChannels );
+    ChannelVectorType sigma( numberOfChannels );
+    for( unsigned int c=0; c<numberOfChannels; c++ )
+      {
+      minimum[c] = size > 0 ? (double)min[c] : 0.0;
+      maximum[c] = size > 0 ? (double)max[c] : 0.0;
+      sums[c] = sum[c] + reference[c] * totalFreq;
+      mean[c] = size > 0 ? reference[c] + sum[c] / totalFreq : 0.0;
+      variance[c] = covariance( c, c );
+      sigma[c] = vcl_sqrt( variance[c] );
+      }
+    labelObject->SetChannelMinimum( minimum );
+    labelObject->SetChannelMaximum( maximum );
+    labelObject->SetChannelSum( sums );
+    labelObject->SetChannelMean( mean );
+    labelObject->SetChannelVariance( variance );
+    labelObject->SetChannelSigma( sigma );
+    }
+  if( computeCovariance )
+    {
+    labelObject->SetChannelCovariance( covariance );
+    }
+
+}
+
+
+template <class TImage, class TFeatureImage>
+void
+VectorStatisticsLabelMapFilter<TImage, TFeatureImage>
+::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os,indent);
+}
+
+
+}// end namespace itk
+#endif
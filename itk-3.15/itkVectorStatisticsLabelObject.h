@@ -0,0 +1,474 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkVectorStatisticsLabelObject.h,v $
+  Language:  C++
+  Date:      $Date: 2005/01/21 20:13:31 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkVectorStatisticsLabelObject_h
+#define __itkVectorStatisticsLabelObject_h
+
+#include "itkShapeLabelObject.h"
+#include "itkVariableLengthVector.h"
+#include "itkVariableSizeMatrix.h"
+
+namespace itk
+{
+
+
+namespace Functor {
+
+template< class TLabelObject >
+class ITK_EXPORT ChannelMinimumLabelObjectAccessor
+{
+public:
+  typedef TLabelObject                                LabelObjectType;
+  typedef typename LabelObjectType::ChannelVectorType AttributeValueType;
+
+  inline const AttributeValueType & operator()( const LabelObjectType * labelObject )
+    {
+    return labelObject->GetChannelMinimum();
+    }
+};
+
+template< class TLabelObject >
+class ITK_EXPORT ChannelMaximumLabelObjectAccessor
+{
+public:
+  typedef TLabelObject                                LabelObjectType;
+  typedef typename LabelObjectType::ChannelVectorType AttributeValueType;
+
+  inline const AttributeValueType & operator()( const LabelObjectType * labelObject )
+    {
+    return labelObject->GetChannelMaximum();
+    }
+};
+
+template< class TLabelObject >
+class ITK_EXPORT ChannelMeanLabelObjectAccessor
+{
+public:
+  typedef TLabelObject                                LabelObjectType;
+  typedef typename LabelObjectType::ChannelVectorType AttributeValueType;
+
+  inline const AttributeValueType & operator()( const LabelObjectType * labelObject )
+    {
+    return labelObject->GetChannelMean();
+    }
+};
+
+template< class TLabelObject >
+class ITK_EXPORT ChannelSumLabelObjectAccessor
+{
+public:
+  typedef TLabelObject                                LabelObjectType;
+  typedef typename LabelObjectType::ChannelVectorType AttributeValueType;
+
+  inline const AttributeValueType & operator()( const LabelObjectType * labelObject )
+    {
+    return labelObject->GetChannelSum();
+    }
+};
+
+template< class TLabelObject >
+class ITK_EXPORT ChannelSigmaLabelObjectAccessor
+{
+public:
+  typedef TLabelObject                                LabelObjectType;
+  typedef typename LabelObjectType::ChannelVectorType AttributeValueType;
+
+  inline const AttributeValueType & operator()( const LabelObjectType * labelObject )
+    {
+    return labelObject->GetChannelSigma();
+    }
+};
+
+template< class TLabelObject >
+class ITK_EXPORT ChannelVarianceLabelObjectAccessor
+{
+public:
+  typedef TLabelObject                                LabelObjectType;
+  typedef typename LabelObjectType::ChannelVectorType AttributeValueType;
+
+  inline const AttributeValueType & operator()( const LabelObjectType * labelObject )
+    {
+    return labelObject->GetChannelVariance();
+    }
+};
+
+template< class TLabelObject >
+class ITK_EXPORT ChannelCovarianceLabelObjectAccessor
+{
+public:
+  typedef TLabelObject                                LabelObjectType;
+  typedef typename LabelObjectType::ChannelMatrixType AttributeValueType;
+
+  inline const AttributeValueType & operator()( const LabelObjectType * labelObject )
+    {
+    return labelObject->GetChannelCovariance();
+    }
+};
+
+}
+
+
+/** \class VectorStatisticsLabelObject
+ *  \brief A Label object to store the statistics of the object in a multi-channel image
+ *
+ * VectorStatisticsLabelObject stores, for each channel of a vector, RGB or
+ * VectorImage feature image, the minimum, maximum, sum, mean, variance and sigma
+ * of the pixels of the object, and the covariance matrix of the channels.
+ * All the values are stored as double, with one value per channel.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa VectorStatisticsLabelMapFilter, StatisticsLabelObject
+ * \ingroup DataRepresentation
+ */
+template < class TLabel, unsigned int VImageDimension >
+class ITK_EXPORT VectorStatisticsLabelObject : public ShapeLabelObject< TLabel, VImageDimension >
+{
+public:
+  /** Standard class typedefs */
+  typedef VectorStatisticsLabelObject                 Self;
+  typedef ShapeLabelObject< TLabel, VImageDimension > Superclass;
+  typedef typename Superclass::LabelObjectType        LabelObjectType;
+  typedef SmartPointer<Self>                          Pointer;
+  typedef SmartPointer<const Self>                    ConstPointer;
+  typedef WeakPointer<const Self>                     ConstWeakPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(VectorStatisticsLabelObject, LabelObject);
+
+  typedef LabelMap< Self > LabelMapType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, VImageDimension);
+
+  typedef typename Superclass::IndexType IndexType;
+
+  typedef TLabel LabelType;
+
+  typedef typename Superclass::LineType LineType;
+
+  typedef typename Superclass::LengthType LengthType;
+
+  typedef typename Superclass::LineContainerType LineContainerType;
+
+  /** The values of all the channels, and the covariance between the channels */
+  typedef VariableLengthVector< double > ChannelVectorType;
+
+  typedef VariableSizeMatrix< double > ChannelMatrixType;
+
+  typedef typename Superclass::AttributeType AttributeType;
+  static const AttributeType CHANNEL_MINIMUM=300;
+  static const AttributeType CHANNEL_MAXIMUM=301;
+  static const AttributeType CHANNEL_MEAN=302;
+  static const AttributeType CHANNEL_SUM=303;
+  static const AttributeType CHANNEL_SIGMA=304;
+  static const AttributeType CHANNEL_VARIANCE=305;
+  static const AttributeType CHANNEL_COVARIANCE=306;
+
+  /** The groups of channel statistics attributes - see ShapeLabelObject for the shape ones */
+  typedef typename Superclass::AttributeGroupMaskType AttributeGroupMaskType;
+  /** ChannelMinimum, ChannelMaximum, ChannelSum, ChannelMean, ChannelVariance and ChannelSigma */
+  static const AttributeGroupMaskType CHANNEL_INTENSITY_ATTRIBUTES=1024;
+  /** ChannelCovariance */
+  static const AttributeGroupMaskType CHANNEL_COVARIANCE_ATTRIBUTES=2048;
+  static const AttributeGroupMaskType ALL_CHANNEL_STATISTICS_ATTRIBUTES=3072;
+
+  /** Return the group of an attribute */
+  static AttributeGroupMaskType GetAttributeGroup( const AttributeType & a )
+    {
+    switch( a )
+      {
+      case CHANNEL_MINIMUM:
+      case CHANNEL_MAXIMUM:
+      case CHANNEL_MEAN:
+      case CHANNEL_SUM:
+      case CHANNEL_SIGMA:
+      case CHANNEL_VARIANCE:
+        return CHANNEL_INTENSITY_ATTRIBUTES;
+        break;
+      case CHANNEL_COVARIANCE:
+        return CHANNEL_COVARIANCE_ATTRIBUTES;
+        break;
+      }
+    return Superclass::GetAttributeGroup( a );
+    }
+
+  static AttributeType GetAttributeFromName( const std::string & s )
+    {
+    if( s == "ChannelMinimum" )
+      {
+      return CHANNEL_MINIMUM;
+      }
+    else if( s == "ChannelMaximum" )
+      {
+      return CHANNEL_MAXIMUM;
+      }
+    else if( s == "ChannelMean" )
+      {
+      return CHANNEL_MEAN;
+      }
+    else if( s == "ChannelSum" )
+      {
+      return CHANNEL_SUM;
+      }
+    else if( s == "ChannelSigma" )
+      {
+      return CHANNEL_SIGMA;
+      }
+    else if( s == "ChannelVariance" )
+      {
+      return CHANNEL_VARIANCE;
+      }
+    else if( s == "ChannelCovariance" )
+      {
+      return CHANNEL_COVARIANCE;
+      }
+    // can't recognize the name
+    return Superclass::GetAttributeFromName( s );
+    }
+
+  static std::string GetNameFromAttribute( const AttributeType & a )
+    {
+    switch( a )
+      {
+      case CHANNEL_MINIMUM:
+        return "ChannelMinimum";
+        break;
+      case CHANNEL_MAXIMUM:
+        return "ChannelMaximum";
+        break;
+      case CHANNEL_MEAN:
+        return "ChannelMean";
+        break;
+      case CHANNEL_SUM:
+        return "ChannelSum";
+        break;
+      case CHANNEL_SIGMA:
+        return "ChannelSigma";
+        break;
+      case CHANNEL_VARIANCE:
+        return "ChannelVariance";
+        break;
+      case CHANNEL_COVARIANCE:
+        return "ChannelCovariance";
+        break;
+      }
+    // can't recognize the name
+    return Superclass::GetNameFromAttribute( a );
+    }
+
+  typedef ImageRegion< ImageDimension > RegionType;
+
+  typedef typename Superclass::CentroidType CentroidType;
+
+
+  virtual void CopyAttributesFrom( const LabelObjectType * lo )
+    {
+    Superclass::CopyAttributesFrom( lo );
+
+    // copy the data of the current type if possible
+    const Self * src = dynamic_cast<const Self *>( lo );
+    if( src == NULL )
+      {
+      return;
+      }
+    m_ChannelMinimum = src->m_ChannelMinimum;
+    m_ChannelMaximum = src->m_ChannelMaximum;
+    m_ChannelMean = src->m_ChannelMean;
+    m_ChannelSum = src->m_ChannelSum;
+    m_ChannelSigma = src->m_ChannelSigma;
+    m_ChannelVariance = src->m_ChannelVariance;
+    m_ChannelCovariance = src->m_ChannelCovariance;
+    }
+
+  /**
+   * Update the attributes after the lines of lo, disjoint from the ones of this
+   * object, have been added to this object. The statistics of the channels are
+   * merged when the sizes of both objects are known. Return false if some
+   * attributes can't be merged, and must be computed again by a valuator.
+   */
+  virtual bool MergeAttributesFrom( const LabelObjectType * lo )
+    {
+    // the sizes must be read before the merge of the shape attributes
+    const Self * src = dynamic_cast<const Self *>( lo );
+    const bool mergeChannels = src != NULL
+      && ( this->GetLineSums().Groups & src->GetLineSums().Groups & Superclass::SIZE_ATTRIBUTES )
+      && this->GetNumberOfChannels() == src->GetNumberOfChannels();
+    const double n1 = this->GetLineSums().Size;
+    const double n2 = mergeChannels ? src->GetLineSums().Size : 0.0;
+
+    bool upToDate = Superclass::MergeAttributesFrom( lo );
+    if( !mergeChannels )
+      {
+      return false;
+      }
+    if( n1 == 0 || n2 == 0 )
+      {
+      return upToDate;
+      }
+
+    // combine the sums of the products of the deviations to the mean
+    const unsigned int numberOfChannels = this->GetNumberOfChannels();
+    const double n = n1 + n2;
+    const bool mergeCovariance = m_ChannelCovariance.Rows() == numberOfChannels
+      && src->m_ChannelCovariance.Rows() == numberOfChannels;
+    ChannelVectorType delta( numberOfChannels );
+    for( unsigned int c=0; c<numberOfChannels; c++ )
+      {
+      delta[c] = src->m_ChannelMean[c] - m_ChannelMean[c];
+      }
+    for( unsigned int c=0; c<numberOfChannels; c++ )
+      {
+      m_ChannelMinimum[c] = std::min( m_ChannelMinimum[c], src->m_ChannelMinimum[c] );
+      m_ChannelMaximum[c] = std::max( m_ChannelMaximum[c], src->m_ChannelMaximum[c] );
+      m_ChannelSum[c] += src->m_ChannelSum[c];
+      m_ChannelMean[c] = m_ChannelSum[c] / n;
+      m_ChannelVariance[c] = ( m_ChannelVariance[c] * ( n1 - 1 ) + src->m_ChannelVariance[c] * ( n2 - 1 )
+        + delta[c] * delta[c] * n1 * n2 / n ) / ( n - 1 );
+      m_ChannelSigma[c] = vcl_sqrt( m_ChannelVariance[c] );
+      if( mergeCovariance )
+        {
+        for( unsigned int e=0; e<numberOfChannels; e++ )
+          {
+          m_ChannelCovariance( c, e ) = ( m_ChannelCovariance( c, e ) * ( n1 - 1 )
+            + src->m_ChannelCovariance( c, e ) * ( n2 - 1 ) + delta[c] * delta[e] * n1 * n2 / n ) / ( n - 1 );
+          }
+        }
+      }
+    if( !mergeCovariance && m_ChannelCovariance.Rows() != 0 )
+      {
+      m_ChannelCovariance = ChannelMatrixType();
+      upToDate = false;
+      }
+    return upToDate;
+    }
+
+  /** Return the number of channels of the statistics stored in the label object */
+  unsigned int GetNumberOfChannels() const
+    {
+    return m_ChannelMean.Size();
+    }
+
+  const ChannelVectorType & GetChannelMinimum() const
+    {
+    return m_ChannelMinimum;
+    }
+
+  void SetChannelMinimum( const ChannelVectorType & v )
+    {
+    m_ChannelMinimum = v;
+    }
+
+  const ChannelVectorType & GetChannelMaximum() const
+    {
+    return m_ChannelMaximum;
+    }
+
+  void SetChannelMaximum( const ChannelVectorType & v )
+    {
+    m_ChannelMaximum = v;
+    }
+
+  const ChannelVectorType & GetChannelMean() const
+    {
+    return m_ChannelMean;
+    }
+
+  void SetChannelMean( const ChannelVectorType & v )
+    {
+    m_ChannelMean = v;
+    }
+
+  const ChannelVectorType & GetChannelSum() const
+    {
+    return m_ChannelSum;
+    }
+
+  void SetChannelSum( const ChannelVectorType & v )
+    {
+    m_ChannelSum = v;
+    }
+
+  const ChannelVectorType & GetChannelSigma() const
+    {
+    return m_ChannelSigma;
+    }
+
+  void SetChannelSigma( const ChannelVectorType & v )
+    {
+    m_ChannelSigma = v;
+    }
+
+  const ChannelVectorType & GetChannelVariance() const
+    {
+    return m_ChannelVariance;
+    }
+
+  void SetChannelVariance( const ChannelVectorType & v )
+    {
+    m_ChannelVariance = v;
+    }
+
+  /** The covariance matrix of the channels. Its diagonal is the variance of the channels. */
+  const ChannelMatrixType & GetChannelCovariance() const
+    {
+    return m_ChannelCovariance;
+    }
+
+  void SetChannelCovariance( const ChannelMatrixType & v )
+    {
+    m_ChannelCovariance = v;
+    }
+
+
+protected:
+  VectorStatisticsLabelObject()
+    {
+    }
+
+
+  void PrintSelf(std::ostream& os, Indent indent) const
+    {
+    Superclass::PrintSelf( os, indent );
+
+    os << indent << "ChannelMinimum: " << m_ChannelMinimum << std::endl;
+    os << indent << "ChannelMaximum: " << m_ChannelMaximum << std::endl;
+    os << indent << "ChannelMean: " << m_ChannelMean << std::endl;
+    os << indent << "ChannelSum: " << m_ChannelSum << std::endl;
+    os << indent << "ChannelSigma: " << m_ChannelSigma << std::endl;
+    os << indent << "ChannelVariance: " << m_ChannelVariance << std::endl;
+    os << indent << "ChannelCovariance: " << std::endl << m_ChannelCovariance;
+    }
+
+private:
+  VectorStatisticsLabelObject(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  ChannelVectorType m_ChannelMinimum;
+  ChannelVectorType m_ChannelMaximum;
+  ChannelVectorType m_ChannelMean;
+  ChannelVectorType m_ChannelSum;
+  ChannelVectorType m_ChannelSigma;
+  ChannelVectorType m_ChannelVariance;
+  ChannelMatrixType m_ChannelCovariance;
+
+};
+
+} // end namespace itk
+
+#endif
@@ -92,6 +92,15 @@ public:
   itkSetMacro( NumberOfObjects, unsigned long );
   itkGetConstReferenceMacro( NumberOfObjects, unsigned long );
 
+  /**
+   * Set/Get whether the removed objects are moved to the second output. When
+   * false, the removed objects are discarded and the second output is empty.
+   * Defaults to true.
+   */
+  itkSetMacro( StoreRemovedObjects, bool );
+  itkGetConstReferenceMacro( StoreRemovedObjects, bool );
+  itkBooleanMacro( StoreRemovedObjects );
+
 protected:
   AttributeKeepNObjectsLabelMapFilter();
   ~AttributeKeepNObjectsLabelMapFilter() {};
@@ -100,12 +109,23 @@ protected:
 
   void PrintSelf(std::ostream& os, Indent indent) const;
 
+  /** Sort the objects by increasing or decreasing attribute value. The objects
+   * with the same value are sorted by label, so the objects kept don't depend on
+   * the implementation of nth_element. */
   class ReverseComparator
     {
     public:
     bool operator()( const typename LabelObjectType::Pointer & a, const typename LabelObjectType::Pointer & b )
       {
-      return accessor( a ) < accessor( b );
+      if( accessor( a ) < accessor( b ) )
+        {
+        return true;
+        }
+      if( accessor( a ) > accessor( b ) )
+        {
+        return false;
+        }
+      return a->GetLabel() < b->GetLabel();
       }
      AttributeAccessorType accessor;
     };
@@ -115,7 +135,15 @@ protected:
   public:
     bool operator()( const typename LabelObjectType::Pointer & a, const typename LabelObjectType::Pointer & b )
       {
-      return accessor( a ) > accessor( b );
+      if( accessor( a ) > accessor( b ) )
+        {
+        return true;
+        }
+      if( accessor( a ) < accessor( b ) )
+        {
+        return false;
+        }
+      return a->GetLabel() < b->GetLabel();
       }
     AttributeAccessorType accessor;
     };
@@ -126,6 +154,7 @@ private:
 
   bool          m_ReverseOrdering;
   unsigned long m_NumberOfObjects;
+  bool          m_StoreRemovedObjects;
 
 }; // end of class
 
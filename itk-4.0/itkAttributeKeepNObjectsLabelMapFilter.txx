@@ -19,6 +19,7 @@
 
 #include "itkAttributeKeepNObjectsLabelMapFilter.h"
 #include "itkProgressReporter.h"
+#include <algorithm>
 
 
 namespace itk {
@@ -29,6 +30,7 @@ AttributeKeepNObjectsLabelMapFilter<TImage, TAttributeAccessor>
 {
   m_ReverseOrdering = false;
   m_NumberOfObjects = 1;
+  m_StoreRemovedObjects = true;
   // create the output image for the removed objects
   this->SetNumberOfRequiredOutputs(2);
   this->SetNthOutput(1, static_cast<TImage*>(this->MakeOutput(1).GetPointer()));
@@ -53,7 +55,7 @@ AttributeKeepNObjectsLabelMapFilter<TImage, TAttributeAccessor>
   const LabelObjectContainerType & labelObjectContainer = output->GetLabelObjectContainer();
   typedef typename std::vector< typename LabelObjectType::Pointer > VectorType;
 
-  ProgressReporter progress( this, 0, 2 * labelObjectContainer.size() );
+  ProgressReporter progress( this, 0, labelObjectContainer.size() );
 
   // get the label objects in a vector, so they can be sorted
   VectorType labelObjects;
@@ -80,17 +82,12 @@ AttributeKeepNObjectsLabelMapFilter<TImage, TAttributeAccessor>
       Comparator comparator;
       std::nth_element( labelObjects.begin(), end, labelObjects.end(), comparator );
       }
-//   progress.CompletedPixel();
-  
-    // and move the last objects to the second output
-    for( typename VectorType::const_iterator it = end;
-      it != labelObjects.end();
-      it++ )
-      {
-      output->RemoveLabelObject( *it );
-      output2->AddLabelObject( *it );
-      progress.CompletedPixel();
-      }
+
+    // keep the first objects, sorted by label, and rebuild the label object
+    // container only once
+    labelObjects.resize( m_NumberOfObjects );
+    std::sort( labelObjects.begin(), labelObjects.end(), typename Superclass::LabelComparator() );
+    this->KeepLabelObjects( labelObjects, m_StoreRemovedObjects ? output2 : NULL );
     }
 }
 
@@ -104,6 +101,7 @@ AttributeKeepNObjectsLabelMapFilter<TImage, TAttributeAccessor>
 
   os << indent << "ReverseOrdering: "  << m_ReverseOrdering << std::endl;
   os << indent << "NumberOfObjects: "  << m_NumberOfObjects << std::endl;
+  os << indent << "StoreRemovedObjects: "  << m_StoreRemovedObjects << std::endl;
 }
 
 }// end namespace itk
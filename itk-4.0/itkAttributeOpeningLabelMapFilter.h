@@ -93,6 +93,15 @@ public:
   itkSetMacro( ReverseOrdering, bool );
   itkBooleanMacro( ReverseOrdering );
 
+  /**
+   * Set/Get whether the removed objects are moved to the second output. When
+   * false, the removed objects are discarded and the second output is empty.
+   * Defaults to true.
+   */
+  itkGetConstMacro( StoreRemovedObjects, bool );
+  itkSetMacro( StoreRemovedObjects, bool );
+  itkBooleanMacro( StoreRemovedObjects );
+
 protected:
   AttributeOpeningLabelMapFilter();
   ~AttributeOpeningLabelMapFilter() {};
@@ -107,6 +116,7 @@ private:
 
   AttributeValueType m_Lambda;
   bool               m_ReverseOrdering;
+  bool               m_StoreRemovedObjects;
 
 }; // end of class
 
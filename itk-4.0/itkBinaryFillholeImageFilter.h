@@ -25,6 +25,9 @@ namespace itk {
  * \brief Remove holes not connected to the boundary of the image.
  *
  * BinaryFillholeImageFilter fills holes in a binary image.
+ * The holes are the connected components of the background which don't touch
+ * the border of the image. They are found on the runs of the background with
+ * BinaryReconstructionCalculator, without inverting and labeling the image.
  *
  * Geodesic morphology and the Fillhole algorithm is described in
  * Chapter 6 of Pierre Soille's book "Morphological Image Analysis:
@@ -32,7 +35,7 @@ namespace itk {
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
- * \sa GrayscaleFillholeImageFilter
+ * \sa GrayscaleFillholeImageFilter, BinaryReconstructionCalculator
  * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
  */
 template<class TInputImage>
@@ -110,8 +113,8 @@ protected:
   /** BinaryFillholeImageFilter will produce the entire output. */
   void EnlargeOutputRequestedRegion(DataObject *itkNotUsed(output));
   
-  /** Single-threaded version of GenerateData.  This filter delegates
-   * to GrayscaleGeodesicErodeImageFilter. */
+  /** The holes are found and filled in a single pass with
+   * BinaryReconstructionCalculator. */
   void GenerateData();
   
 
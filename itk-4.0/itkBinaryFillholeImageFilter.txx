@@ -18,11 +18,8 @@
 #define __itkBinaryFillholeImageFilter_txx
 
 #include "itkBinaryFillholeImageFilter.h"
-#include "itkBinaryNotImageFilter.h"
-#include "itkBinaryImageToShapeLabelMapFilter.h"
-#include "itkShapeOpeningLabelMapFilter.h"
-#include "itkLabelMapMaskImageFilter.h"
-#include "itkProgressAccumulator.h"
+#include "itkBinaryReconstructionCalculator.h"
+#include "itkProgressReporter.h"
 
 namespace itk {
 
@@ -66,65 +63,27 @@ void
 BinaryFillholeImageFilter<TInputImage>
 ::GenerateData()
 {
-  // let choose a background value. Background value should not be given by user
-  // because closing is extensive so no background pixels will be added
-  // it is just needed for internal erosion filter and constant padder
-  InputImagePixelType backgroundValue = NumericTraits<InputImagePixelType>::Zero;
-  if ( m_ForegroundValue == backgroundValue )
-    {
-    // current background value is already used for foreground value
-    // choose another one
-    backgroundValue = NumericTraits<InputImagePixelType>::max();
-    }
-
-  // Create a process accumulator for tracking the progress of this minipipeline
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter(this);
+  ProgressReporter progress( this, 0, 1 );
 
   // Allocate the output
   this->AllocateOutputs();
-  
-  typedef BinaryNotImageFilter< InputImageType > NotType;
-  typename NotType::Pointer notInput = NotType::New();
-  notInput->SetInput( this->GetInput() );
-  notInput->SetForegroundValue( m_ForegroundValue );
-  notInput->SetBackgroundValue( backgroundValue );
-  notInput->SetNumberOfThreads( this->GetNumberOfThreads() );
-  notInput->SetReleaseDataFlag( true );
-  progress->RegisterInternalFilter(notInput, .2f);
-  
-  typedef typename itk::BinaryImageToShapeLabelMapFilter< InputImageType > LabelizerType;
-  typename LabelizerType::Pointer labelizer = LabelizerType::New();
-  labelizer->SetInput( notInput->GetOutput() );
-  labelizer->SetInputForegroundValue( m_ForegroundValue );
-  labelizer->SetOutputBackgroundValue( backgroundValue );
-  labelizer->SetFullyConnected( m_FullyConnected );
-  labelizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(labelizer, .5f);
-  
-  typedef typename LabelizerType::OutputImageType LabelMapType;
-  typedef typename itk::ShapeOpeningLabelMapFilter< LabelMapType > OpeningType;
-  typename OpeningType::Pointer opening = OpeningType::New();
-  opening->SetInput( labelizer->GetOutput() );
-  opening->SetAttribute( "SizeOnBorder" );
-  opening->SetLambda( 1 );
-  opening->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(opening, .1f);
-
-  // invert the image during the binarization
-  typedef typename itk::LabelMapMaskImageFilter< LabelMapType, OutputImageType > BinarizerType;
-  typename BinarizerType::Pointer binarizer = BinarizerType::New();
-  binarizer->SetInput( opening->GetOutput() );
-  binarizer->SetLabel( backgroundValue );
-  binarizer->SetNegated( true );
-  binarizer->SetBackgroundValue( m_ForegroundValue );
-  binarizer->SetFeatureImage( this->GetInput() );
-  binarizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(binarizer, .2f);
-
-  binarizer->GraftOutput( this->GetOutput() );
-  binarizer->Update();
-  this->GraftOutput( binarizer->GetOutput() );
+
+  // the background components which touch the border of the image are the
+  // reconstruction of the background from the border. The other ones are the
+  // holes, and are filled with the foreground value. The input is neither
+  // inverted nor labeled.
+  typedef BinaryReconstructionCalculator< InputImageType > CalculatorType;
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetMaskImage( this->GetInput() );
+  calculator->SetForegroundValue( m_ForegroundValue );
+  calculator->SetNegated( true );
+  calculator->SetBorderMarker( true );
+  calculator->SetRemovedValue( m_ForegroundValue );
+  calculator->SetFullyConnected( m_FullyConnected );
+  calculator->SetNumberOfThreads( this->GetNumberOfThreads() );
+  calculator->Compute( this->GetOutput() );
+
+  progress.CompletedPixel();
 }
 
 
@@ -116,8 +116,8 @@ protected:
   /** BinaryGrindPeakImageFilter will produce the entire output. */
   void EnlargeOutputRequestedRegion(DataObject *itkNotUsed(output));
   
-  /** Single-threaded version of GenerateData.  This filter delegates
-   * to GrayscaleGeodesicErodeImageFilter. */
+  /** The objects are found and cleared in a single pass with
+   * BinaryReconstructionCalculator. */
   void GenerateData();
   
 
@@ -18,10 +18,8 @@
 #define __itkBinaryGrindPeakImageFilter_txx
 
 #include "itkBinaryGrindPeakImageFilter.h"
-#include "itkBinaryImageToShapeLabelMapFilter.h"
-#include "itkShapeOpeningLabelMapFilter.h"
-#include "itkLabelMapToBinaryImageFilter.h"
-#include "itkProgressAccumulator.h"
+#include "itkBinaryReconstructionCalculator.h"
+#include "itkProgressReporter.h"
 
 namespace itk {
 
@@ -66,44 +64,26 @@ void
 BinaryGrindPeakImageFilter<TInputImage>
 ::GenerateData()
 {
-  // Create a process accumulator for tracking the progress of this minipipeline
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter(this);
+  ProgressReporter progress( this, 0, 1 );
 
   // Allocate the output
   this->AllocateOutputs();
-  
-  typedef typename itk::BinaryImageToShapeLabelMapFilter< InputImageType > LabelizerType;
-  typename LabelizerType::Pointer labelizer = LabelizerType::New();
-  labelizer->SetInput( this->GetInput() );
-  labelizer->SetInputForegroundValue( m_ForegroundValue );
-  labelizer->SetOutputBackgroundValue( m_BackgroundValue );
-  labelizer->SetFullyConnected( m_FullyConnected );
-  labelizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(labelizer, .6f);
-  
-  typedef typename LabelizerType::OutputImageType LabelMapType;
-  typedef typename itk::ShapeOpeningLabelMapFilter< LabelMapType > OpeningType;
-  typename OpeningType::Pointer opening = OpeningType::New();
-  opening->SetInput( labelizer->GetOutput() );
-  opening->SetAttribute( "SizeOnBorder" );
-  opening->SetLambda( 0 );
-  opening->SetReverseOrdering(true);
-  opening->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(opening, .1f);
-
-  typedef typename itk::LabelMapToBinaryImageFilter< LabelMapType, OutputImageType > BinarizerType;
-  typename BinarizerType::Pointer binarizer = BinarizerType::New();
-  binarizer->SetInput( opening->GetOutput() );
-  binarizer->SetForegroundValue( m_ForegroundValue );
-  binarizer->SetBackgroundValue( m_BackgroundValue );
-  binarizer->SetBackgroundImage( this->GetInput() );
-  binarizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(binarizer, .2f);
-
-  binarizer->GraftOutput( this->GetOutput() );
-  binarizer->Update();
-  this->GraftOutput( binarizer->GetOutput() );
+
+  // only a "touches the border" flag is needed for the connected components: they
+  // are found on the runs of the image, and the ones on the border are cleared.
+  // The shape attributes are not computed, and no label map is produced.
+  typedef BinaryReconstructionCalculator< InputImageType > CalculatorType;
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetMaskImage( this->GetInput() );
+  calculator->SetForegroundValue( m_ForegroundValue );
+  calculator->SetBorderMarker( true );
+  calculator->SetRemoveMarked( true );
+  calculator->SetRemovedValue( m_BackgroundValue );
+  calculator->SetFullyConnected( m_FullyConnected );
+  calculator->SetNumberOfThreads( this->GetNumberOfThreads() );
+  calculator->Compute( this->GetOutput() );
+
+  progress.CompletedPixel();
 }
 
 
@@ -18,7 +18,7 @@
 #define __itkBinaryReconstructionByDilationImageFilter_txx
 
 #include "itkBinaryReconstructionByDilationImageFilter.h"
-#include "itkProgressAccumulator.h"
+#include "itkProgressReporter.h"
 
 
 namespace itk {
@@ -71,45 +71,21 @@ void
 BinaryReconstructionByDilationImageFilter<TInputImage>
 ::GenerateData()
 {
-  // Create a process accumulator for tracking the progress of this minipipeline
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter(this);
+  ProgressReporter progress( this, 0, 1 );
 
   // Allocate the output
   this->AllocateOutputs();
-  
-  typename LabelizerType::Pointer labelizer = LabelizerType::New();
-  labelizer->SetInput( this->GetMaskImage() );
-  labelizer->SetInputForegroundValue( m_ForegroundValue );
-  labelizer->SetOutputBackgroundValue( m_BackgroundValue );
-  labelizer->SetFullyConnected( m_FullyConnected );
-  labelizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(labelizer, .25f);
-  
-  typename ReconstructionType::Pointer reconstruction = ReconstructionType::New();
-  reconstruction->SetInput( labelizer->GetOutput() );
-  reconstruction->SetMarkerImage( this->GetMarkerImage() );
-  reconstruction->SetForegroundValue( m_ForegroundValue );
-  reconstruction->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(reconstruction, .25f);
-  
-  typename OpeningType::Pointer opening = OpeningType::New();
-  opening->SetInput( reconstruction->GetOutput() );
-  opening->SetLambda( true );
-  opening->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(opening, .25f);
-
-  typename BinarizerType::Pointer binarizer = BinarizerType::New();
-  binarizer->SetInput( opening->GetOutput() );
-  binarizer->SetForegroundValue( m_ForegroundValue );
-  binarizer->SetBackgroundValue( m_BackgroundValue );
-  binarizer->SetBackgroundImage( this->GetMaskImage() );
-  binarizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(binarizer, .5f);  
-
-  binarizer->GraftOutput( this->GetOutput() );
-  binarizer->Update();
-  this->GraftOutput( binarizer->GetOutput() );
+
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetMaskImage( this->GetMaskImage() );
+  calculator->SetMarkerImage( this->GetMarkerImage() );
+  calculator->SetForegroundValue( m_ForegroundValue );
+  calculator->SetRemovedValue( m_BackgroundValue );
+  calculator->SetFullyConnected( m_FullyConnected );
+  calculator->SetNumberOfThreads( this->GetNumberOfThreads() );
+  calculator->Compute( this->GetOutput() );
+
+  progress.CompletedPixel();
 }
 
 
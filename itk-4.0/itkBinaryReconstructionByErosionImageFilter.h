@@ -18,14 +18,7 @@
 #define __itkBinaryReconstructionByErosionImageFilter_h
 
 #include "itkImageToImageFilter.h"
-#include "itkAttributeLabelObject.h"
-#include "itkLabelMap.h"
-#include "itkBinaryNotImageFilter.h"
-#include "itkBinaryImageToLabelMapFilter.h"
-#include "itkBinaryReconstructionLabelMapFilter.h"
-#include "itkAttributeOpeningLabelMapFilter.h"
-#include "itkLabelMapMaskImageFilter.h"
-
+#include "itkBinaryReconstructionCalculator.h"
 
 namespace itk {
 
@@ -76,13 +69,7 @@ public:
   itkStaticConstMacro(ImageDimension, unsigned int,
                       TInputImage::ImageDimension);
 
-  typedef BinaryNotImageFilter< InputImageType >                                           NotType;
-  typedef AttributeLabelObject<unsigned long, ImageDimension, bool>                        LabelObjectType;
-  typedef typename itk::LabelMap< LabelObjectType >                                        LabelMapType;
-  typedef typename itk::BinaryImageToLabelMapFilter< InputImageType, LabelMapType >        LabelizerType;
-  typedef typename itk::BinaryReconstructionLabelMapFilter< LabelMapType, InputImageType > ReconstructionType;
-  typedef typename itk::AttributeOpeningLabelMapFilter< LabelMapType >                     OpeningType;
-  typedef typename itk::LabelMapMaskImageFilter< LabelMapType, OutputImageType >           BinarizerType;
+  typedef BinaryReconstructionCalculator< InputImageType > CalculatorType;
 
   /** Standard New method. */
   itkNewMacro(Self);  
@@ -165,8 +152,8 @@ protected:
   /** BinaryReconstructionByErosionImageFilter will produce the entire output. */
   void EnlargeOutputRequestedRegion(DataObject *itkNotUsed(output));
   
-  /** Single-threaded version of GenerateData.  This filter delegates
-   * to GrayscaleGeodesicErodeImageFilter. */
+  /** The connected components of the mask and their marker are found, and the
+   * output is written, in a single pass with BinaryReconstructionCalculator. */
   void GenerateData();
   
 
@@ -18,7 +18,7 @@
 #define __itkBinaryReconstructionByErosionImageFilter_txx
 
 #include "itkBinaryReconstructionByErosionImageFilter.h"
-#include "itkProgressAccumulator.h"
+#include "itkProgressReporter.h"
 
 
 namespace itk {
@@ -71,61 +71,25 @@ void
 BinaryReconstructionByErosionImageFilter<TInputImage>
 ::GenerateData()
 {
-  // Create a process accumulator for tracking the progress of this minipipeline
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter(this);
+  ProgressReporter progress( this, 0, 1 );
 
   // Allocate the output
   this->AllocateOutputs();
-  
-  typename NotType::Pointer notMask = NotType::New();
-  notMask->SetInput( this->GetMaskImage() );
-  notMask->SetForegroundValue( m_ForegroundValue );
-  notMask->SetBackgroundValue( m_BackgroundValue );
-  notMask->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(notMask, .1f);
-  
-  typename NotType::Pointer notMarker = NotType::New();
-  notMarker->SetInput( this->GetMarkerImage() );
-  notMarker->SetForegroundValue( m_ForegroundValue );
-  notMarker->SetBackgroundValue( m_BackgroundValue );
-  notMarker->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(notMarker, .1f);
-  
-  typename LabelizerType::Pointer labelizer = LabelizerType::New();
-  labelizer->SetInput( notMask->GetOutput() );
-  labelizer->SetInputForegroundValue( m_ForegroundValue );
-  labelizer->SetOutputBackgroundValue( m_BackgroundValue );
-  labelizer->SetFullyConnected( m_FullyConnected );
-  labelizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(labelizer, .2f);
-  
-  typename ReconstructionType::Pointer reconstruction = ReconstructionType::New();
-  reconstruction->SetInput( labelizer->GetOutput() );
-  reconstruction->SetMarkerImage( notMarker->GetOutput() );
-  reconstruction->SetForegroundValue( m_ForegroundValue );
-  reconstruction->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(reconstruction, .2f);
-  
-  typename OpeningType::Pointer opening = OpeningType::New();
-  opening->SetInput( reconstruction->GetOutput() );
-  opening->SetLambda( true );
-  opening->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(opening, .2f);
-
-  // invert the image during the binarization
-  typename BinarizerType::Pointer binarizer = BinarizerType::New();
-  binarizer->SetInput( opening->GetOutput() );
-  binarizer->SetLabel( m_BackgroundValue );
-  binarizer->SetNegated( true );
-  binarizer->SetBackgroundValue( m_ForegroundValue );
-  binarizer->SetFeatureImage( this->GetMaskImage() );
-  binarizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(binarizer, .2f);
-
-  binarizer->GraftOutput( this->GetOutput() );
-  binarizer->Update();
-  this->GraftOutput( binarizer->GetOutput() );
+
+  // the reconstruction by dilation of the complements of the mask and of the marker:
+  // the pixels of the complement of the mask which are not reconstructed are set
+  // to the foreground value
+  typename CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetMaskImage( this->GetMaskImage() );
+  calculator->SetMarkerImage( this->GetMarkerImage() );
+  calculator->SetForegroundValue( m_ForegroundValue );
+  calculator->SetNegated( true );
+  calculator->SetRemovedValue( m_ForegroundValue );
+  calculator->SetFullyConnected( m_FullyConnected );
+  calculator->SetNumberOfThreads( this->GetNumberOfThreads() );
+  calculator->Compute( this->GetOutput() );
+
+  progress.CompletedPixel();
 }
 
 
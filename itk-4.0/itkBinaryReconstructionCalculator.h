@@ -0,0 +1,222 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkBinaryReconstructionCalculator.h,v $
+  Language:  C++
+  Date:      $Date: 2006/03/28 19:59:05 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBinaryReconstructionCalculator_h
+#define __itkBinaryReconstructionCalculator_h
+
+#include "itkObject.h"
+#include "itkMultiThreader.h"
+#include <vector>
+
+namespace itk {
+
+/** \class BinaryReconstructionCalculator
+ * \brief Compute a binary reconstruction in a single pass on the runs of the mask
+ *
+ * The connected components of the mask are found with the runs of the mask and a
+ * union-find, as in BinaryImageToLabelMapFilter, but each run also stores if it
+ * contains a pixel of the marker, and that flag is propagated to the root of the
+ * component when the runs are linked. The output is then written directly: the
+ * mask is copied, and the runs of the components without marker are filled with
+ * RemovedValue. No label map is produced.
+ *
+ * A pixel is in the mask (or in the marker) if its value is ForegroundValue, or,
+ * with Negated set to true, if its value is not ForegroundValue - the reconstruction
+ * by erosion is the reconstruction by dilation of the complements.
+ *
+ * With BorderMarker set to true, the marker image is not used: the marker is the
+ * border of the image. The reconstruction of the background from the border is
+ * then the complement of the fill hole.
+ *
+ * With RemoveMarked set to true, the components which contain the marker are
+ * removed instead of the other ones - with BorderMarker, the objects touching
+ * the border of the image are cleared, without computing any attribute.
+ *
+ * The mask, the marker and the output must have the same largest possible region,
+ * and must be fully buffered.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa BinaryReconstructionByDilationImageFilter, BinaryReconstructionByErosionImageFilter,
+ * BinaryFillholeImageFilter
+ */
+template<class TImage>
+class ITK_EXPORT BinaryReconstructionCalculator :
+    public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef BinaryReconstructionCalculator Self;
+  typedef Object                         Superclass;
+  typedef SmartPointer<Self>             Pointer;
+  typedef SmartPointer<const Self>       ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TImage                          ImageType;
+  typedef typename ImageType::ConstPointer ImageConstPointer;
+  typedef typename ImageType::PixelType   PixelType;
+  typedef typename ImageType::IndexType   IndexType;
+  typedef typename ImageType::SizeType    SizeType;
+  typedef typename ImageType::RegionType  RegionType;
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(ImageDimension, unsigned int,
+                      TImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(BinaryReconstructionCalculator,
+               Object);
+
+  /**
+   * Set/Get the number of threads used to compute the reconstruction.
+   * It defaults to the global default number of threads.
+   */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstReferenceMacro(NumberOfThreads, int);
+
+  /** Set/Get the mask image */
+  itkSetConstObjectMacro(MaskImage, ImageType);
+  itkGetConstObjectMacro(MaskImage, ImageType);
+
+  /** Set/Get the marker image */
+  itkSetConstObjectMacro(MarkerImage, ImageType);
+  itkGetConstObjectMacro(MarkerImage, ImageType);
+
+  /**
+   * Set/Get whether the connected components are defined strictly by
+   * face connectivity or by face+edge+vertex connectivity.  Default is
+   * FullyConnectedOff.
+   */
+  itkSetMacro(FullyConnected, bool);
+  itkGetConstReferenceMacro(FullyConnected, bool);
+  itkBooleanMacro(FullyConnected);
+
+  /**
+   * Set/Get the value of the pixels of the mask and of the marker.
+   * Defaults to NumericTraits<PixelType>::max().
+   */
+  itkSetMacro(ForegroundValue, PixelType);
+  itkGetConstMacro(ForegroundValue, PixelType);
+
+  /**
+   * Set/Get whether the pixels of the mask and of the marker are the ones which
+   * are NOT equal to ForegroundValue. Defaults to false.
+   */
+  itkSetMacro(Negated, bool);
+  itkGetConstReferenceMacro(Negated, bool);
+  itkBooleanMacro(Negated);
+
+  /**
+   * Set/Get whether the marker is the border of the image, instead of the marker
+   * image. Defaults to false.
+   */
+  itkSetMacro(BorderMarker, bool);
+  itkGetConstReferenceMacro(BorderMarker, bool);
+  itkBooleanMacro(BorderMarker);
+
+  /**
+   * Set/Get whether the components of the mask which contain the marker are removed,
+   * instead of the ones which don't contain it. Defaults to false.
+   */
+  itkSetMacro(RemoveMarked, bool);
+  itkGetConstReferenceMacro(RemoveMarked, bool);
+  itkBooleanMacro(RemoveMarked);
+
+  /**
+   * Set/Get the value written in the output for the pixels of the mask which are
+   * removed.
+   * Defaults to NumericTraits<PixelType>::NonpositiveMin().
+   */
+  itkSetMacro(RemovedValue, PixelType);
+  itkGetConstMacro(RemovedValue, PixelType);
+
+  /** Compute the reconstruction and write it in the output, which must be allocated */
+  void Compute( ImageType * output );
+
+protected:
+  BinaryReconstructionCalculator();
+  ~BinaryReconstructionCalculator() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Find the runs of the mask in a range of lines, and if they contain the marker */
+  void ThreadedFindRuns( unsigned long beginLine, unsigned long endLine );
+
+  /** Copy the mask to the output in a range of lines, and fill the removed runs */
+  void ThreadedWriteOutput( unsigned long beginLine, unsigned long endLine );
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+private:
+  BinaryReconstructionCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** A run of the mask - the position of its first and last pixels in the dimension 0,
+   * whether it contains a pixel of the marker, and its label in the union-find */
+  struct RunType
+    {
+    long          First;
+    long          Last;
+    bool          Marked;
+    unsigned long Label;
+    };
+  typedef std::vector< RunType > LineType;
+
+  /** Return the index of the first pixel of a line of the region */
+  IndexType GetLineIndex( unsigned long line ) const;
+
+  /** Link the runs of two neighbor lines which are touching */
+  void LinkLines( const LineType & line, const LineType & neighbor, long offset );
+
+  unsigned long LookupSet( unsigned long label );
+
+  void LinkLabels( unsigned long label1, unsigned long label2 );
+
+  int        m_NumberOfThreads;
+  bool       m_FullyConnected;
+  bool       m_Negated;
+  bool       m_BorderMarker;
+  bool       m_RemoveMarked;
+  PixelType  m_ForegroundValue;
+  PixelType  m_RemovedValue;
+
+  ImageConstPointer m_MaskImage;
+  ImageConstPointer m_MarkerImage;
+  ImageType *       m_Output;
+
+  /** The step of the computation run by the threads */
+  enum { FIND_RUNS, WRITE_OUTPUT } m_Step;
+
+  RegionType              m_Region;
+  std::vector< LineType > m_Lines;
+
+  /** The union-find, and the marker flag of the labels. The flag is only meaningful
+   * for the roots of the union-find, once the runs are linked. */
+  std::vector< unsigned long > m_UnionFind;
+  std::vector< char >          m_Marked;
+
+}; // end of class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkBinaryReconstructionCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,414 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkBinaryReconstructionCalculator.txx,v $
+  Language:  C++
+  Date:      $Date: 2005/08/23 15:09:03 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkBinaryReconstructionCalculator_txx
+#define __itkBinaryReconstructionCalculator_txx
+
+#include "itkBinaryReconstructionCalculator.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+
+namespace itk {
+
+template <class TImage>
+BinaryReconstructionCalculator<TImage>
+::BinaryReconstructionCalculator()
+{
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_FullyConnected = false;
+  m_Negated = false;
+  m_BorderMarker = false;
+  m_RemoveMarked = false;
+  m_ForegroundValue = NumericTraits< PixelType >::max();
+  m_RemovedValue = NumericTraits< PixelType >::NonpositiveMin();
+  m_MaskImage = NULL;
+  m_MarkerImage = NULL;
+  m_Output = NULL;
+  m_Step = FIND_RUNS;
+}
+
+
+template <class TImage>
+void
+BinaryReconstructionCalculator<TImage>
+::Compute( ImageType * output )
+{
+  if( m_MaskImage.IsNull() || ( m_MarkerImage.IsNull() && !m_BorderMarker ) )
+    {
+    itkExceptionMacro( << "The mask and the marker images are required." );
+    }
+
+  m_Output = output;
+  m_Region = m_MaskImage->GetLargestPossibleRegion();
+  const unsigned long numberOfLines = m_Region.GetNumberOfPixels() / m_Region.GetSize()[0];
+  m_Lines.clear();
+  m_Lines.resize( numberOfLines );
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( std::max( 1, (int)std::min( (unsigned long)m_NumberOfThreads, numberOfLines ) ) );
+  threader->SetSingleMethod( this->ThreaderCallback, this );
+
+  // find the runs of the mask, and whether they contain a pixel of the marker
+  m_Step = FIND_RUNS;
+  threader->SingleMethodExecute();
+
+  // label the runs, and propagate the marker flag to the labels
+  unsigned long numberOfRuns = 0;
+  for( unsigned long l=0; l<numberOfLines; l++ )
+    {
+    numberOfRuns += m_Lines[l].size();
+    }
+  m_UnionFind.resize( numberOfRuns );
+  m_Marked.resize( numberOfRuns );
+  unsigned long label = 0;
+  for( unsigned long l=0; l<numberOfLines; l++ )
+    {
+    for( typename LineType::iterator it = m_Lines[l].begin(); it != m_Lines[l].end(); it++ )
+      {
+      it->Label = label;
+      m_UnionFind[label] = label;
+      m_Marked[label] = it->Marked;
+      label++;
+      }
+    }
+
+  // the offsets to the "previous" neighbor lines, in the dimensions 1 to ImageDimension-1:
+  // the highest non zero dimension of the offset is -1. With the face connectivity, only
+  // one dimension can be non zero.
+  const SizeType & size = m_Region.GetSize();
+  typedef std::vector< long > LineOffsetType;
+  std::vector< LineOffsetType > neighborOffsets;
+  LineOffsetType offset( ImageDimension, -1 );
+  offset[0] = 0;
+  bool done = ( ImageDimension < 2 );
+  while( !done )
+    {
+    int highest = 0;
+    int nonZero = 0;
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      if( offset[i] != 0 )
+        {
+        highest = i;
+        nonZero++;
+        }
+      }
+    if( highest > 0 && offset[highest] == -1 && ( m_FullyConnected || nonZero == 1 ) )
+      {
+      neighborOffsets.push_back( offset );
+      }
+    // next offset
+    done = true;
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      if( offset[i] < 1 )
+        {
+        offset[i]++;
+        done = false;
+        break;
+        }
+      offset[i] = -1;
+      }
+    }
+
+  // link the touching runs of the neighbor lines. The position of the line in the
+  // dimensions 1 to ImageDimension-1 is updated incrementally.
+  const long dim0Offset = m_FullyConnected ? 1 : 0;
+  LineOffsetType position( ImageDimension, 0 );
+  for( unsigned long l=0; l<numberOfLines; l++ )
+    {
+    if( !m_Lines[l].empty() )
+      {
+      for( typename std::vector< LineOffsetType >::const_iterator oit = neighborOffsets.begin();
+        oit != neighborOffsets.end();
+        oit++ )
+        {
+        long neighbor = 0;
+        long stride = 1;
+        bool inside = true;
+        for( int i=1; i<ImageDimension; i++ )
+          {
+          const long p = position[i] + (*oit)[i];
+          inside = inside && p >= 0 && p < (long)size[i];
+          neighbor += p * stride;
+          stride *= size[i];
+          }
+        if( inside && !m_Lines[neighbor].empty() )
+          {
+          this->LinkLines( m_Lines[l], m_Lines[neighbor], dim0Offset );
+          }
+        }
+      }
+    // next line
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      position[i]++;
+      if( position[i] < (long)size[i] )
+        {
+        break;
+        }
+      position[i] = 0;
+      }
+    }
+
+  // resolve the flags of the runs before the threads, so they don't have to use
+  // the union-find
+  for( unsigned long l=0; l<numberOfLines; l++ )
+    {
+    for( typename LineType::iterator it = m_Lines[l].begin(); it != m_Lines[l].end(); it++ )
+      {
+      it->Marked = m_Marked[ this->LookupSet( it->Label ) ] != 0;
+      }
+    }
+  m_UnionFind.clear();
+  m_Marked.clear();
+
+  // write the output
+  m_Step = WRITE_OUTPUT;
+  threader->SingleMethodExecute();
+
+  m_Lines.clear();
+  m_Output = NULL;
+}
+
+
+template <class TImage>
+typename BinaryReconstructionCalculator<TImage>::IndexType
+BinaryReconstructionCalculator<TImage>
+::GetLineIndex( unsigned long line ) const
+{
+  IndexType idx = m_Region.GetIndex();
+  for( int i=1; i<ImageDimension; i++ )
+    {
+    idx[i] += line % m_Region.GetSize()[i];
+    line /= m_Region.GetSize()[i];
+    }
+  return idx;
+}
+
+
+template <class TImage>
+void
+BinaryReconstructionCalculator<TImage>
+::ThreadedFindRuns( unsigned long beginLine, unsigned long endLine )
+{
+  const long length = m_Region.GetSize()[0];
+  for( unsigned long l=beginLine; l<endLine; l++ )
+    {
+    const IndexType idx = this->GetLineIndex( l );
+    const PixelType * mask = m_MaskImage->GetBufferPointer() + m_MaskImage->ComputeOffset( idx );
+    LineType & line = m_Lines[l];
+
+    const PixelType * marker = NULL;
+    bool lineOnBorder = false;
+    if( m_BorderMarker )
+      {
+      // all the pixels of a line are on the border, if the line is on the border of
+      // the region in one of the dimensions 1 to ImageDimension-1
+      for( int i=1; i<ImageDimension; i++ )
+        {
+        const long p = idx[i] - m_Region.GetIndex()[i];
+        lineOnBorder = lineOnBorder || p == 0 || p == (long)m_Region.GetSize()[i] - 1;
+        }
+      }
+    else
+      {
+      marker = m_MarkerImage->GetBufferPointer() + m_MarkerImage->ComputeOffset( idx );
+      }
+
+    long i = 0;
+    while( i < length )
+      {
+      if( ( mask[i] == m_ForegroundValue ) == m_Negated )
+        {
+        i++;
+        continue;
+        }
+      // a run starts here - read the marker at the same time
+      RunType run;
+      run.First = idx[0] + i;
+      run.Marked = false;
+      run.Label = 0;
+      if( m_BorderMarker )
+        {
+        run.Marked = lineOnBorder || i == 0;
+        while( i < length && ( mask[i] == m_ForegroundValue ) != m_Negated )
+          {
+          i++;
+          }
+        run.Marked = run.Marked || i == length;
+        }
+      else
+        {
+        while( i < length && ( mask[i] == m_ForegroundValue ) != m_Negated )
+          {
+          run.Marked = run.Marked || ( ( marker[i] == m_ForegroundValue ) != m_Negated );
+          i++;
+          }
+        }
+      run.Last = idx[0] + i - 1;
+      line.push_back( run );
+      }
+    }
+}
+
+
+template <class TImage>
+void
+BinaryReconstructionCalculator<TImage>
+::ThreadedWriteOutput( unsigned long beginLine, unsigned long endLine )
+{
+  const long length = m_Region.GetSize()[0];
+  for( unsigned long l=beginLine; l<endLine; l++ )
+    {
+    const IndexType idx = this->GetLineIndex( l );
+    const PixelType * mask = m_MaskImage->GetBufferPointer() + m_MaskImage->ComputeOffset( idx );
+    PixelType * out = m_Output->GetBufferPointer() + m_Output->ComputeOffset( idx );
+
+    std::copy( mask, mask + length, out );
+    const LineType & line = m_Lines[l];
+    for( typename LineType::const_iterator it = line.begin(); it != line.end(); it++ )
+      {
+      if( it->Marked == m_RemoveMarked )
+        {
+        std::fill( out + ( it->First - idx[0] ), out + ( it->Last - idx[0] + 1 ), m_RemovedValue );
+        }
+      }
+    }
+}
+
+
+template <class TImage>
+void
+BinaryReconstructionCalculator<TImage>
+::LinkLines( const LineType & line, const LineType & neighbor, long offset )
+{
+  // both lines are sorted - move the run which ends first
+  typename LineType::const_iterator lit = line.begin();
+  typename LineType::const_iterator nit = neighbor.begin();
+  while( lit != line.end() && nit != neighbor.end() )
+    {
+    if( nit->First - offset <= lit->Last && nit->Last + offset >= lit->First )
+      {
+      this->LinkLabels( lit->Label, nit->Label );
+      }
+    if( lit->Last < nit->Last )
+      {
+      lit++;
+      }
+    else
+      {
+      nit++;
+      }
+    }
+}
+
+
+template <class TImage>
+unsigned long
+BinaryReconstructionCalculator<TImage>
+::LookupSet( unsigned long label )
+{
+  // find the root, and then compress the path
+  unsigned long root = label;
+  while( m_UnionFind[root] != root )
+    {
+    root = m_UnionFind[root];
+    }
+  while( m_UnionFind[label] != root )
+    {
+    const unsigned long next = m_UnionFind[label];
+    m_UnionFind[label] = root;
+    label = next;
+    }
+  return root;
+}
+
+
+template <class TImage>
+void
+BinaryReconstructionCalculator<TImage>
+::LinkLabels( unsigned long label1, unsigned long label2 )
+{
+  const unsigned long root1 = this->LookupSet( label1 );
+  const unsigned long root2 = this->LookupSet( label2 );
+  if( root1 == root2 )
+    {
+    return;
+    }
+  // the marker flag follows the root
+  const char marked = m_Marked[root1] | m_Marked[root2];
+  if( root1 < root2 )
+    {
+    m_UnionFind[root2] = root1;
+    m_Marked[root1] = marked;
+    }
+  else
+    {
+    m_UnionFind[root1] = root2;
+    m_Marked[root2] = marked;
+    }
+}
+
+
+template <class TImage>
+ITK_THREAD_RETURN_TYPE
+BinaryReconstructionCalculator<TImage>
+::ThreaderCallback( void * arg )
+{
+  int threadId = ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  int threadCount = ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+  Self * self = (Self *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  // split the lines in contiguous parts of the same size
+  const unsigned long numberOfLines = self->m_Lines.size();
+  const unsigned long begin = numberOfLines * threadId / threadCount;
+  const unsigned long end = numberOfLines * ( threadId + 1 ) / threadCount;
+  if( self->m_Step == FIND_RUNS )
+    {
+    self->ThreadedFindRuns( begin, end );
+    }
+  else
+    {
+    self->ThreadedWriteOutput( begin, end );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TImage>
+void
+BinaryReconstructionCalculator<TImage>
+::PrintSelf(std::ostream &os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfThreads: "  << m_NumberOfThreads << std::endl;
+  os << indent << "FullyConnected: "  << m_FullyConnected << std::endl;
+  os << indent << "Negated: "  << m_Negated << std::endl;
+  os << indent << "BorderMarker: "  << m_BorderMarker << std::endl;
+  os << indent << "RemoveMarked: "  << m_RemoveMarked << std::endl;
+  os << indent << "ForegroundValue: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>(m_ForegroundValue) << std::endl;
+  os << indent << "RemovedValue: "
+     << static_cast<typename NumericTraits<PixelType>::PrintType>(m_RemovedValue) << std::endl;
+  os << indent << "MaskImage: "  << m_MaskImage.GetPointer() << std::endl;
+  os << indent << "MarkerImage: "  << m_MarkerImage.GetPointer() << std::endl;
+}
+
+}// end namespace itk
+#endif
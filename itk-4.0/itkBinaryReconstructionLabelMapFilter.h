@@ -19,10 +19,20 @@
 
 #include "itkInPlaceLabelMapFilter.h"
 #include "itkAttributeLabelObject.h"
+#include "itkLabelMapUtilities.h"
 
 namespace itk {
 /** \class BinaryReconstructionLabelMapFilter
- * \brief TODO
+ * \brief Mark the objects which have at least one pixel in a binary marker
+ *
+ * The objects are marked with the accessor - true if they are reconstructed by the
+ * marker, false otherwise. The marker can be given as an image, where the marker
+ * pixels have the value ForegroundValue, or as a label map, with SetMarkerLabelMap(),
+ * where all the objects are in the marker. With a label map, the lines of the marker
+ * are sorted once, and the lines of each object are then searched in them: the cost
+ * of the test is proportional to the number of lines, and not to the number of pixels,
+ * and the marker doesn't have to be converted to an image. When both are given, the
+ * marker label map is used.
  *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
@@ -53,6 +63,9 @@ public:
   typedef typename MarkerImageType::ConstPointer    MarkerImageConstPointer;
   typedef typename MarkerImageType::PixelType       MarkerImagePixelType;
   
+  /** The type of the marker given as a label map */
+  typedef TImage                                    MarkerLabelMapType;
+
   typedef TAttributeAccessor AttributeAccessorType;
 
   /** ImageDimension constants */
@@ -90,6 +103,19 @@ public:
     return static_cast<MarkerImageType*>(const_cast<DataObject *>(this->ProcessObject::GetInput(1)));
     }
 
+  /** Set the marker as a label map. The marker image is not required in that case. */
+  void SetMarkerLabelMap(MarkerLabelMapType *input)
+    {
+    // Process object is not const-correct so the const casting is required.
+    this->SetNthInput( 2, const_cast<MarkerLabelMapType *>(input) );
+    }
+
+  /** Get the marker label map */
+  MarkerLabelMapType * GetMarkerLabelMap()
+    {
+    return static_cast<MarkerLabelMapType*>(const_cast<DataObject *>(this->ProcessObject::GetInput(2)));
+    }
+
    /** Set the input image */
   void SetInput1(TImage *input)
     {
@@ -113,7 +139,11 @@ protected:
   BinaryReconstructionLabelMapFilter();
   ~BinaryReconstructionLabelMapFilter() {};
 
+  virtual void BeforeThreadedGenerateData();
+
   virtual void ThreadedProcessLabelObject( LabelObjectType * labelObject );
+
+  virtual void AfterThreadedGenerateData();
   
   void PrintSelf(std::ostream& os, Indent indent) const;
 
@@ -123,6 +153,9 @@ private:
   
   MarkerImagePixelType m_ForegroundValue;
 
+  typedef LabelMapUtilities::RunIntersectionTester< LabelObjectType > RunIntersectionTesterType;
+  RunIntersectionTesterType m_MarkerRuns;
+
 }; // end of class
 
 } // end namespace itk
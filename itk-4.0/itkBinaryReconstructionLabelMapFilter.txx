@@ -27,11 +27,54 @@ template <class TImage, class TMarkerImage, class TAttributeAccessor>
 BinaryReconstructionLabelMapFilter<TImage, TMarkerImage, TAttributeAccessor>
 ::BinaryReconstructionLabelMapFilter()
 {
-  this->SetNumberOfRequiredInputs(2);
+  // the marker is either the second input, or the third one as a label map
+  this->SetNumberOfRequiredInputs(1);
   m_ForegroundValue = NumericTraits< MarkerImagePixelType >::max();
 }
 
 
+template <class TImage, class TMarkerImage, class TAttributeAccessor>
+void
+BinaryReconstructionLabelMapFilter<TImage, TMarkerImage, TAttributeAccessor>
+::BeforeThreadedGenerateData()
+{
+  MarkerLabelMapType * markerLabelMap = this->GetMarkerLabelMap();
+  if( markerLabelMap == NULL && this->GetMarkerImage() == NULL )
+    {
+    itkExceptionMacro( << "A marker image or a marker label map is required." );
+    }
+
+  // sort the lines of the marker only once for all the objects
+  m_MarkerRuns = RunIntersectionTesterType();
+  if( markerLabelMap != NULL )
+    {
+    typedef typename MarkerLabelMapType::LabelObjectContainerType LabelObjectContainerType;
+    const LabelObjectContainerType & labelObjects = markerLabelMap->GetLabelObjectContainer();
+    for( typename LabelObjectContainerType::const_iterator it = labelObjects.begin();
+      it != labelObjects.end();
+      it++ )
+      {
+      m_MarkerRuns.AddLabelObject( it->second );
+      }
+    m_MarkerRuns.Initialize();
+    }
+
+  Superclass::BeforeThreadedGenerateData();
+}
+
+
+template <class TImage, class TMarkerImage, class TAttributeAccessor>
+void
+BinaryReconstructionLabelMapFilter<TImage, TMarkerImage, TAttributeAccessor>
+::AfterThreadedGenerateData()
+{
+  // release the memory used by the lines of the marker
+  m_MarkerRuns = RunIntersectionTesterType();
+
+  Superclass::AfterThreadedGenerateData();
+}
+
+
 template <class TImage, class TMarkerImage, class TAttributeAccessor>
 void
 BinaryReconstructionLabelMapFilter<TImage, TMarkerImage, TAttributeAccessor>
@@ -39,6 +82,12 @@ BinaryReconstructionLabelMapFilter<TImage, TMarkerImage, TAttributeAccessor>
 {
   AttributeAccessorType accessor;
 
+  if( this->GetMarkerLabelMap() != NULL )
+    {
+    accessor( labelObject, m_MarkerRuns.Intersects( labelObject ) );
+    return;
+    }
+
   const MarkerImageType * maskImage = this->GetMarkerImage();
 
   typename LabelObjectType::LineContainerType::const_iterator lit;
@@ -0,0 +1,204 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkLabelMapPatternSpectrumImageFilter.h,v $
+  Language:  C++
+  Date:      $Date: 2006/03/28 19:59:05 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkLabelMapPatternSpectrumImageFilter_h
+#define __itkLabelMapPatternSpectrumImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkAttributeLabelObject.h"
+#include <utility>
+#include <vector>
+
+namespace itk {
+
+/** \class LabelMapPatternSpectrumImageFilter
+ * \brief Compute the pattern spectrum of a LabelMap, and its attribute openings for several lambdas
+ *
+ * LabelMapPatternSpectrumImageFilter sorts once the label objects of a valuated
+ * LabelMap by attribute value, and computes:
+ *  - the pattern spectrum: the number of pixels of the objects for each attribute
+ *    value. The number of pixels removed by an attribute opening of threshold lambda
+ *    is the sum of the sizes of the values smaller than lambda - or greater than
+ *    lambda with ReverseOrdering. GetRemovedSize() computes that sum.
+ *  - the result of the attribute openings for all the lambdas given with SetLambdas():
+ *    the output n is the label image of the objects kept by the opening of threshold
+ *    lambda n, as AttributeOpeningLabelMapFilter followed by LabelMapToLabelImageFilter
+ *    would produce it. The outputs are written incrementally, from the most selective
+ *    lambda to the least one: each output is a copy of the previous one, where only the
+ *    objects kept by that lambda but not by the previous one are written.
+ *
+ * Without lambda, the single output is the label image of all the objects.
+ *
+ * The label map is neither labeled nor valuated again, so a size distribution can
+ * be computed with a single labeling of the image.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa AttributeOpeningLabelMapFilter, LabelMapToAttributeImageFilter
+ * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
+ */
+template<class TInputImage, class TOutputImage, class TAttributeAccessor=
+    typename Functor::AttributeLabelObjectAccessor< typename TInputImage::LabelObjectType > >
+class ITK_EXPORT LabelMapPatternSpectrumImageFilter :
+    public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef LabelMapPatternSpectrumImageFilter            Self;
+  typedef ImageToImageFilter<TInputImage, TOutputImage> Superclass;
+  typedef SmartPointer<Self>                            Pointer;
+  typedef SmartPointer<const Self>                      ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage                              InputImageType;
+  typedef TOutputImage                             OutputImageType;
+  typedef typename InputImageType::Pointer         InputImagePointer;
+  typedef typename InputImageType::ConstPointer    InputImageConstPointer;
+  typedef typename InputImageType::RegionType      InputImageRegionType;
+  typedef typename InputImageType::PixelType       InputImagePixelType;
+  typedef typename InputImageType::LabelObjectType LabelObjectType;
+  typedef typename OutputImageType::Pointer        OutputImagePointer;
+  typedef typename OutputImageType::ConstPointer   OutputImageConstPointer;
+  typedef typename OutputImageType::RegionType     OutputImageRegionType;
+  typedef typename OutputImageType::PixelType      OutputImagePixelType;
+  typedef typename OutputImageType::IndexType      IndexType;
+
+  typedef TAttributeAccessor                                  AttributeAccessorType;
+  typedef typename AttributeAccessorType::AttributeValueType  AttributeValueType;
+
+  /** The thresholds of the openings */
+  typedef std::vector< AttributeValueType > LambdasType;
+
+  /** An attribute value, and the number of pixels of the objects with that value */
+  typedef std::pair< AttributeValueType, unsigned long > PatternSpectrumValueType;
+  typedef std::vector< PatternSpectrumValueType >        PatternSpectrumType;
+
+  /** ImageDimension constants */
+  itkStaticConstMacro(InputImageDimension, unsigned int,
+                      TInputImage::ImageDimension);
+  itkStaticConstMacro(OutputImageDimension, unsigned int,
+                      TOutputImage::ImageDimension);
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(LabelMapPatternSpectrumImageFilter,
+               ImageToImageFilter);
+
+  /**
+   * Set/Get the value used as "background" in the output images.
+   * Defaults to NumericTraits<PixelType>::NonpositiveMin().
+   */
+  itkSetMacro(BackgroundValue, OutputImagePixelType);
+  itkGetConstMacro(BackgroundValue, OutputImagePixelType);
+
+  /**
+   * Set/Get the ordering of the objects. By default, the objects with
+   * an attribute value smaller than Lamba are removed. Turning ReverseOrdering
+   * to true make this filter remove the object with an attribute value greater
+   * than Lambda instead.
+   */
+  itkGetConstMacro( ReverseOrdering, bool );
+  itkSetMacro( ReverseOrdering, bool );
+  itkBooleanMacro( ReverseOrdering );
+
+  /**
+   * Set/Get the thresholds of the openings. The filter has one output per lambda,
+   * in the same order.
+   */
+  void SetLambdas( const LambdasType & lambdas );
+  const LambdasType & GetLambdas() const
+    {
+    return m_Lambdas;
+    }
+
+  /**
+   * Get the pattern spectrum, sorted by attribute value in the removal order - by
+   * increasing values, or decreasing values with ReverseOrdering. Only the values
+   * of at least one object are in the pattern spectrum.
+   */
+  const PatternSpectrumType & GetPatternSpectrum() const
+    {
+    return m_PatternSpectrum;
+    }
+
+  /**
+   * Return the number of pixels removed by an attribute opening of threshold lambda.
+   */
+  unsigned long GetRemovedSize( const AttributeValueType & lambda ) const;
+
+protected:
+  LabelMapPatternSpectrumImageFilter();
+  ~LabelMapPatternSpectrumImageFilter() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** LabelMapPatternSpectrumImageFilter needs the entire input be
+   * available. Thus, it needs to provide an implementation of
+   * GenerateInputRequestedRegion(). */
+  void GenerateInputRequestedRegion();
+
+  /** LabelMapPatternSpectrumImageFilter will produce the entire outputs. */
+  void EnlargeOutputRequestedRegion(DataObject *output);
+
+  void GenerateData();
+
+  /** Return true if the object of the given attribute value is removed by the
+   * opening of threshold lambda */
+  bool IsRemoved( const AttributeValueType & value, const AttributeValueType & lambda ) const
+    {
+    if( m_ReverseOrdering )
+      {
+      return value > lambda;
+      }
+    return value < lambda;
+    }
+
+private:
+  LabelMapPatternSpectrumImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  /** Sort the pairs by their first member, in the removal order */
+  template< class TPair >
+  class RemovalOrderComparator
+    {
+    public:
+    RemovalOrderComparator( bool reverseOrdering ) : m_ReverseOrdering( reverseOrdering ) {}
+    bool operator()( const TPair & a, const TPair & b ) const
+      {
+      if( m_ReverseOrdering )
+        {
+        return b.first < a.first;
+        }
+      return a.first < b.first;
+      }
+    bool m_ReverseOrdering;
+    };
+
+  OutputImagePixelType m_BackgroundValue;
+  bool                 m_ReverseOrdering;
+  LambdasType          m_Lambdas;
+  PatternSpectrumType  m_PatternSpectrum;
+
+}; // end of class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkLabelMapPatternSpectrumImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,226 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkLabelMapPatternSpectrumImageFilter.txx,v $
+  Language:  C++
+  Date:      $Date: 2005/08/23 15:09:03 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkLabelMapPatternSpectrumImageFilter_txx
+#define __itkLabelMapPatternSpectrumImageFilter_txx
+
+#include "itkLabelMapPatternSpectrumImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include <algorithm>
+
+namespace itk {
+
+template <class TInputImage, class TOutputImage, class TAttributeAccessor>
+LabelMapPatternSpectrumImageFilter<TInputImage, TOutputImage, TAttributeAccessor>
+::LabelMapPatternSpectrumImageFilter()
+{
+  m_BackgroundValue = NumericTraits<OutputImagePixelType>::NonpositiveMin();
+  m_ReverseOrdering = false;
+}
+
+
+template <class TInputImage, class TOutputImage, class TAttributeAccessor>
+void
+LabelMapPatternSpectrumImageFilter<TInputImage, TOutputImage, TAttributeAccessor>
+::SetLambdas( const LambdasType & lambdas )
+{
+  if( m_Lambdas == lambdas )
+    {
+    return;
+    }
+  m_Lambdas = lambdas;
+
+  // one output per lambda - and at least one output
+  const unsigned int numberOfOutputs = std::max( (unsigned int)m_Lambdas.size(), 1u );
+  const unsigned int previousNumberOfOutputs = this->GetNumberOfOutputs();
+  this->SetNumberOfRequiredOutputs( numberOfOutputs );
+  this->SetNumberOfOutputs( numberOfOutputs );
+  for( unsigned int i=previousNumberOfOutputs; i<numberOfOutputs; i++ )
+    {
+    this->SetNthOutput( i, static_cast<TOutputImage*>(this->MakeOutput( i ).GetPointer()) );
+    }
+  this->Modified();
+}
+
+
+template <class TInputImage, class TOutputImage, class TAttributeAccessor>
+unsigned long
+LabelMapPatternSpectrumImageFilter<TInputImage, TOutputImage, TAttributeAccessor>
+::GetRemovedSize( const AttributeValueType & lambda ) const
+{
+  // the pattern spectrum is sorted in the removal order: the values removed
+  // are at its beginning
+  unsigned long size = 0;
+  for( typename PatternSpectrumType::const_iterator it = m_PatternSpectrum.begin();
+    it != m_PatternSpectrum.end() && this->IsRemoved( it->first, lambda );
+    it++ )
+    {
+    size += it->second;
+    }
+  return size;
+}
+
+
+template <class TInputImage, class TOutputImage, class TAttributeAccessor>
+void
+LabelMapPatternSpectrumImageFilter<TInputImage, TOutputImage, TAttributeAccessor>
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  // We need all the input.
+  InputImagePointer input = const_cast<InputImageType *>(this->GetInput());
+  if ( !input )
+    { return; }
+  input->SetRequestedRegion( input->GetLargestPossibleRegion() );
+}
+
+
+template <class TInputImage, class TOutputImage, class TAttributeAccessor>
+void
+LabelMapPatternSpectrumImageFilter<TInputImage, TOutputImage, TAttributeAccessor>
+::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  output->SetRequestedRegionToLargestPossibleRegion();
+}
+
+
+template<class TInputImage, class TOutputImage, class TAttributeAccessor>
+void
+LabelMapPatternSpectrumImageFilter<TInputImage, TOutputImage, TAttributeAccessor>
+::GenerateData()
+{
+  // Allocate the outputs
+  this->AllocateOutputs();
+
+  const InputImageType * input = this->GetInput();
+  AttributeAccessorType accessor;
+
+  // get the label objects with their attribute value in a vector, and sort them
+  // in the removal order: the objects removed by an opening are at the beginning
+  // of the vector, and the objects kept at its end
+  typedef std::pair< AttributeValueType, const LabelObjectType * > ObjectType;
+  typedef std::vector< ObjectType >                                ObjectVectorType;
+  typedef typename InputImageType::LabelObjectContainerType        LabelObjectContainerType;
+  const LabelObjectContainerType & labelObjectContainer = input->GetLabelObjectContainer();
+  ObjectVectorType objects;
+  objects.reserve( labelObjectContainer.size() );
+  for( typename LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+    it != labelObjectContainer.end();
+    it++ )
+    {
+    const LabelObjectType * labelObject = it->second;
+    objects.push_back( ObjectType( accessor( labelObject ), labelObject ) );
+    }
+  std::sort( objects.begin(), objects.end(), RemovalOrderComparator< ObjectType >( m_ReverseOrdering ) );
+
+  // the pattern spectrum: sum the sizes of the objects with the same attribute value
+  typedef typename LabelObjectType::LineContainerType LineContainerType;
+  m_PatternSpectrum.clear();
+  for( typename ObjectVectorType::const_iterator it = objects.begin(); it != objects.end(); it++ )
+    {
+    unsigned long size = 0;
+    const LineContainerType & lineContainer = it->second->GetLineContainer();
+    for( typename LineContainerType::const_iterator lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+      {
+      size += lit->GetLength();
+      }
+    if( !m_PatternSpectrum.empty() && m_PatternSpectrum.back().first == it->first )
+      {
+      m_PatternSpectrum.back().second += size;
+      }
+    else
+      {
+      m_PatternSpectrum.push_back( PatternSpectrumValueType( it->first, size ) );
+      }
+    }
+
+  // the lambdas in the removal order, with the number of their output
+  typedef std::pair< AttributeValueType, unsigned int > LambdaType;
+  typedef std::vector< LambdaType >                     LambdaVectorType;
+  LambdaVectorType lambdas;
+  for( unsigned int i=0; i<m_Lambdas.size(); i++ )
+    {
+    lambdas.push_back( LambdaType( m_Lambdas[i], i ) );
+    }
+  std::sort( lambdas.begin(), lambdas.end(), RemovalOrderComparator< LambdaType >( m_ReverseOrdering ) );
+
+  const long numberOfSteps = std::max( (long)lambdas.size(), 1L );
+  ProgressReporter progress( this, 0, numberOfSteps );
+
+  // the outputs are written from the most selective lambda to the least one: an
+  // output is a copy of the previous one, with the objects kept by its lambda but
+  // not by the previous one. Without lambda, all the objects are kept.
+  typename ObjectVectorType::const_iterator kept = objects.end();
+  const OutputImageType * previous = NULL;
+  for( long l=numberOfSteps-1; l>=0; l-- )
+    {
+    OutputImageType * output = this->GetOutput( lambdas.empty() ? 0 : lambdas[l].second );
+    OutputImagePixelType * buffer = output->GetBufferPointer();
+    if( previous )
+      {
+      std::copy( previous->GetBufferPointer(),
+                 previous->GetBufferPointer() + previous->GetBufferedRegion().GetNumberOfPixels(),
+                 buffer );
+      }
+    else
+      {
+      output->FillBuffer( m_BackgroundValue );
+      }
+
+    typename ObjectVectorType::const_iterator end = kept;
+    while( kept != objects.begin() && ( lambdas.empty() || !this->IsRemoved( (kept-1)->first, lambdas[l].first ) ) )
+      {
+      kept--;
+      }
+    for( typename ObjectVectorType::const_iterator it = kept; it != end; it++ )
+      {
+      const OutputImagePixelType label = static_cast< OutputImagePixelType >( it->second->GetLabel() );
+      const LineContainerType & lineContainer = it->second->GetLineContainer();
+      for( typename LineContainerType::const_iterator lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+        {
+        OutputImagePixelType * begin = buffer + output->ComputeOffset( lit->GetIndex() );
+        std::fill( begin, begin + lit->GetLength(), label );
+        }
+      }
+
+    previous = output;
+    progress.CompletedPixel();
+    }
+}
+
+
+template <class TInputImage, class TOutputImage, class TAttributeAccessor>
+void
+LabelMapPatternSpectrumImageFilter<TInputImage, TOutputImage, TAttributeAccessor>
+::PrintSelf(std::ostream &os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "BackgroundValue: "  << static_cast<typename NumericTraits<OutputImagePixelType>::PrintType>(m_BackgroundValue) << std::endl;
+  os << indent << "ReverseOrdering: "  << m_ReverseOrdering << std::endl;
+  os << indent << "Lambdas: ";
+  for( unsigned int i=0; i<m_Lambdas.size(); i++ )
+    {
+    os << m_Lambdas[i] << " ";
+    }
+  os << std::endl;
+}
+
+}// end namespace itk
+#endif
@@ -22,6 +22,7 @@
 #include "itkBinaryImageToLabelMapFilter.h"
 #include "itkAttributeKeepNObjectsLabelMapFilter.h"
 #include "itkLabelMapToBinaryImageFilter.h"
+#include "itkLabelMapUtilities.h"
 #include "itkAttributeLabelObject.h"
 
 
@@ -38,13 +39,17 @@ namespace itk {
  * Used in combination with AttributeLabelObject, and a specilized attribute valuator,
  * this class is the most efficient way to keep N objects in a binary image.
  *
+ * The objects to keep are selected on the valued label objects, and the output is
+ * written in a single pass: the input is copied, except in the runs of the
+ * removed objects, which are set to BackgroundValue. No label map is binarized.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * \sa AttributeLabelObject, InPlaceLabelMapFilter
  * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
  */
 template<class TInputImage, class TLabelObject, class TLabelObjectValuator, class TAttributeAccessor=
-    typename Functor::AttributeLabelObjectAccessor< typename TImage::LabelObjectType > >
+    typename Functor::AttributeLabelObjectAccessor< TLabelObject > >
 class ITK_EXPORT BinaryAttributeKeepNObjectsImageFilter : 
     public ImageToImageFilter<TInputImage, TInputImage>
 {
@@ -75,14 +80,17 @@ public:
   itkStaticConstMacro(ImageDimension, unsigned int,
                       TInputImage::ImageDimension);
 
-  typedef TLabelObject                                                                             LabelObjectType;
-  typedef typename itk::LabelMap< LabelObjectType >                                                LabelMapType;
-  typedef typename itk::BinaryImageToLabelMapFilter< InputImageType, LabelMapType >                LabelizerType;
-  typedef TLabelObjectValuator                                                                     LabelObjectValuatorType;
-  typedef TAttributeAccessor                                                                       AttributeAccessorType;
-  typedef typename AttributeAccessorType::AttributeValueType                                       AttributeValueType;
+  typedef TLabelObject                                                              LabelObjectType;
+  typedef typename itk::LabelMap< LabelObjectType >                                 LabelMapType;
+  typedef typename itk::BinaryImageToLabelMapFilter< InputImageType, LabelMapType > LabelizerType;
+  typedef TLabelObjectValuator                                                      LabelObjectValuatorType;
+  typedef TAttributeAccessor                                                        AttributeAccessorType;
+  typedef typename AttributeAccessorType::AttributeValueType                        AttributeValueType;
+
+  /** The internal filters used by the previous versions, only kept to reject the
+   * old CustomizeInternalFilters() overrides. */
   typedef typename itk::AttributeKeepNObjectsLabelMapFilter< LabelMapType, AttributeAccessorType > KeepNObjectsType;
-  typedef typename itk::LabelMapToBinaryImageFilter< LabelMapType, OutputImageType >               BinarizerType;
+  typedef typename itk::LabelMapToBinaryImageFilter< LabelMapType, OutputImageType > BinarizerType;
 
   /** Standard New method. */
   itkNewMacro(Self);  
@@ -158,7 +166,58 @@ protected:
    * to GrayscaleGeodesicErodeImageFilter. */
   void GenerateData();
   
-  virtual void CustomizeInternalFilters( LabelizerType *, LabelObjectValuatorType *, KeepNObjectsType *, BinarizerType* ) {};
+  virtual void CustomizeInternalFilters( LabelizerType *, LabelObjectValuatorType * ) {};
+
+  /**
+   * The keep N objects filter and the binarizer are not run anymore, so they
+   * can't be customized. This overload is never called: it only makes the
+   * overrides of the previous signature fail to compile - with a conflicting
+   * return type - instead of being silently ignored. They must override the
+   * method above.
+   */
+  struct InternalFiltersRemoved {};
+  virtual InternalFiltersRemoved CustomizeInternalFilters( LabelizerType *, LabelObjectValuatorType *, KeepNObjectsType *, BinarizerType * )
+    {
+    return InternalFiltersRemoved();
+    }
+
+  /** Sort the objects by increasing or decreasing attribute value, and then by
+   * label - the raster order of their first pixel */
+  class ReverseComparator
+    {
+    public:
+    bool operator()( const LabelObjectType * a, const LabelObjectType * b )
+      {
+      if( accessor( a ) < accessor( b ) )
+        {
+        return true;
+        }
+      if( accessor( a ) > accessor( b ) )
+        {
+        return false;
+        }
+      return a->GetLabel() < b->GetLabel();
+      }
+    AttributeAccessorType accessor;
+    };
+
+  class Comparator
+    {
+    public:
+    bool operator()( const LabelObjectType * a, const LabelObjectType * b )
+      {
+      if( accessor( a ) > accessor( b ) )
+        {
+        return true;
+        }
+      if( accessor( a ) < accessor( b ) )
+        {
+        return false;
+        }
+      return a->GetLabel() < b->GetLabel();
+      }
+    AttributeAccessorType accessor;
+    };
 
 private:
   BinaryAttributeKeepNObjectsImageFilter(const Self&); //purposely not implemented
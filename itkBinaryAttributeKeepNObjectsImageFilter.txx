@@ -19,6 +19,7 @@
 
 #include "itkBinaryAttributeKeepNObjectsImageFilter.h"
 #include "itkProgressAccumulator.h"
+#include <algorithm>
 
 
 namespace itk {
@@ -78,33 +79,57 @@ BinaryAttributeKeepNObjectsImageFilter<TInputImage, TLabelObject, TLabelObjectVa
   labelizer->SetBackgroundValue( m_BackgroundValue );
   labelizer->SetFullyConnected( m_FullyConnected );
   labelizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(labelizer, .3f);
+  progress->RegisterInternalFilter(labelizer, .5f);
   
   typename LabelObjectValuatorType::Pointer valuator = LabelObjectValuatorType::New();
   valuator->SetInput( labelizer->GetOutput() );
   valuator->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(valuator, .3f);
+  progress->RegisterInternalFilter(valuator, .5f);
   
-  typename KeepNObjectsType::Pointer opening = KeepNObjectsType::New();
-  opening->SetInput( valuator->GetOutput() );
-  opening->SetNumberOfObjects( m_NumberOfObjects );
-  opening->SetReverseOrdering( m_ReverseOrdering );
-  opening->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(opening, .2f);
-  
-  typename BinarizerType::Pointer binarizer = BinarizerType::New();
-  binarizer->SetInput( opening->GetOutput() );
-  binarizer->SetForegroundValue( m_ForegroundValue );
-  binarizer->SetBackgroundValue( m_BackgroundValue );
-  binarizer->SetBackgroundImage( this->GetInput() );
-  binarizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(binarizer, .2f);  
-
-  this->CustomizeInternalFilters( labelizer, valuator, opening, binarizer );
-
-  binarizer->GraftOutput( this->GetOutput() );
-  binarizer->Update();
-  this->GraftOutput( binarizer->GetOutput() );
+  this->CustomizeInternalFilters( labelizer, valuator );
+
+  valuator->Update();
+  LabelMapType * labelMap = valuator->GetOutput();
+
+  typedef LabelMapUtilities::RemovedRunsWriter< LabelObjectType, OutputImageType > WriterType;
+  WriterType writer;
+
+  // get the label objects in a vector, so they can be sorted
+  typedef typename LabelMapType::LabelObjectContainerType LabelObjectContainerType;
+  const LabelObjectContainerType & labelObjectContainer = labelMap->GetLabelObjectContainer();
+  typedef typename std::vector< LabelObjectType * > VectorType;
+  VectorType labelObjects;
+  labelObjects.reserve( labelObjectContainer.size() );
+  for( typename LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+    it != labelObjectContainer.end();
+    it++ )
+    {
+    labelObjects.push_back( it->second );
+    }
+
+  // only the objects after the first N ones once sorted are removed
+  if( m_NumberOfObjects < labelObjects.size() )
+    {
+    typename VectorType::iterator end = labelObjects.begin() + m_NumberOfObjects;
+    if( m_ReverseOrdering )
+      {
+      ReverseComparator comparator;
+      std::nth_element( labelObjects.begin(), end, labelObjects.end(), comparator );
+      }
+    else
+      {
+      Comparator comparator;
+      std::nth_element( labelObjects.begin(), end, labelObjects.end(), comparator );
+      }
+    for( typename VectorType::const_iterator it = end; it != labelObjects.end(); it++ )
+      {
+      writer.AddLabelObject( *it );
+      }
+    }
+
+  // the output is the input, with the removed objects set to the background value.
+  // The kept objects are already in the input with the foreground value.
+  writer.Write( this->GetInput(), this->GetOutput(), m_BackgroundValue, this->GetNumberOfThreads() );
 }
 
 
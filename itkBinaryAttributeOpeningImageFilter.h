@@ -22,6 +22,7 @@
 #include "itkBinaryImageToLabelMapFilter.h"
 #include "itkAttributeOpeningLabelMapFilter.h"
 #include "itkLabelMapToBinaryImageFilter.h"
+#include "itkLabelMapUtilities.h"
 #include "itkAttributeLabelObject.h"
 
 
@@ -39,13 +40,17 @@ namespace itk {
  * this class is the most efficient way to perform an attribute opening in a binary
  * image.
  *
+ * The opening decision is made on the valued label objects, and the output is
+ * written in a single pass: the input is copied, except in the runs of the
+ * removed objects, which are set to BackgroundValue. No label map is binarized.
+ *
  * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
  *
  * \sa AttributeLabelObject, InPlaceLabelMapFilter
  * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
  */
 template<class TInputImage, class TLabelObject, class TLabelObjectValuator, class TAttributeAccessor=
-    typename Functor::AttributeLabelObjectAccessor< typename TImage::LabelObjectType > >
+    typename Functor::AttributeLabelObjectAccessor< TLabelObject > >
 class ITK_EXPORT BinaryAttributeOpeningImageFilter : 
     public ImageToImageFilter<TInputImage, TInputImage>
 {
@@ -76,14 +81,17 @@ public:
   itkStaticConstMacro(ImageDimension, unsigned int,
                       TInputImage::ImageDimension);
 
-  typedef TLabelObject                                                                        LabelObjectType;
-  typedef typename itk::LabelMap< LabelObjectType >                                           LabelMapType;
-  typedef typename itk::BinaryImageToLabelMapFilter< InputImageType, LabelMapType >           LabelizerType;
-  typedef TLabelObjectValuator                                                                LabelObjectValuatorType;
-  typedef TAttributeAccessor                                                                  AttributeAccessorType;
-  typedef typename AttributeAccessorType::AttributeValueType                                  AttributeValueType;
+  typedef TLabelObject                                                              LabelObjectType;
+  typedef typename itk::LabelMap< LabelObjectType >                                 LabelMapType;
+  typedef typename itk::BinaryImageToLabelMapFilter< InputImageType, LabelMapType > LabelizerType;
+  typedef TLabelObjectValuator                                                      LabelObjectValuatorType;
+  typedef TAttributeAccessor                                                        AttributeAccessorType;
+  typedef typename AttributeAccessorType::AttributeValueType                        AttributeValueType;
+
+  /** The internal filters used by the previous versions, only kept to reject the
+   * old CustomizeInternalFilters() overrides. */
   typedef typename itk::AttributeOpeningLabelMapFilter< LabelMapType, AttributeAccessorType > OpeningType;
-  typedef typename itk::LabelMapToBinaryImageFilter< LabelMapType, OutputImageType >          BinarizerType;
+  typedef typename itk::LabelMapToBinaryImageFilter< LabelMapType, OutputImageType > BinarizerType;
 
   /** Standard New method. */
   itkNewMacro(Self);  
@@ -160,7 +168,19 @@ protected:
    * to GrayscaleGeodesicErodeImageFilter. */
   void GenerateData();
   
-  virtual void CustomizeInternalFilters( LabelizerType *, LabelObjectValuatorType *, OpeningType *, BinarizerType* ) {};
+  virtual void CustomizeInternalFilters( LabelizerType *, LabelObjectValuatorType * ) {};
+
+  /**
+   * The opening and the binarizer are not run anymore, so they can't be customized.
+   * This overload is never called: it only makes the overrides of the previous
+   * signature fail to compile - with a conflicting return type - instead of
+   * being silently ignored. They must override the method above.
+   */
+  struct InternalFiltersRemoved {};
+  virtual InternalFiltersRemoved CustomizeInternalFilters( LabelizerType *, LabelObjectValuatorType *, OpeningType *, BinarizerType * )
+    {
+    return InternalFiltersRemoved();
+    }
 
 
 private:
@@ -78,33 +78,39 @@ BinaryAttributeOpeningImageFilter<TInputImage, TLabelObject, TLabelObjectValuato
   labelizer->SetBackgroundValue( m_BackgroundValue );
   labelizer->SetFullyConnected( m_FullyConnected );
   labelizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(labelizer, .3f);
+  progress->RegisterInternalFilter(labelizer, .5f);
   
   typename LabelObjectValuatorType::Pointer valuator = LabelObjectValuatorType::New();
   valuator->SetInput( labelizer->GetOutput() );
   valuator->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(valuator, .3f);
+  progress->RegisterInternalFilter(valuator, .5f);
   
-  typename OpeningType::Pointer opening = OpeningType::New();
-  opening->SetInput( valuator->GetOutput() );
-  opening->SetLambda( m_Lambda );
-  opening->SetReverseOrdering( m_ReverseOrdering );
-  opening->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(opening, .2f);
-  
-  typename BinarizerType::Pointer binarizer = BinarizerType::New();
-  binarizer->SetInput( opening->GetOutput() );
-  binarizer->SetForegroundValue( m_ForegroundValue );
-  binarizer->SetBackgroundValue( m_BackgroundValue );
-  binarizer->SetBackgroundImage( this->GetInput() );
-  binarizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(binarizer, .2f);  
-
-  this->CustomizeInternalFilters( labelizer, valuator, opening, binarizer );
-
-  binarizer->GraftOutput( this->GetOutput() );
-  binarizer->Update();
-  this->GraftOutput( binarizer->GetOutput() );
+  this->CustomizeInternalFilters( labelizer, valuator );
+
+  valuator->Update();
+  LabelMapType * labelMap = valuator->GetOutput();
+
+  typedef LabelMapUtilities::RemovedRunsWriter< LabelObjectType, OutputImageType > WriterType;
+  WriterType writer;
+
+  // remove the objects with an attribute value smaller (or greater) than lambda
+  AttributeAccessorType accessor;
+  const typename LabelMapType::LabelObjectContainerType & labelObjectContainer = labelMap->GetLabelObjectContainer();
+  for( typename LabelMapType::LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+    it != labelObjectContainer.end();
+    it++ )
+    {
+    const LabelObjectType * labelObject = it->second;
+    if( ( !m_ReverseOrdering && accessor( labelObject ) < m_Lambda )
+      || ( m_ReverseOrdering && accessor( labelObject ) > m_Lambda ) )
+      {
+      writer.AddLabelObject( labelObject );
+      }
+    }
+
+  // the output is the input, with the removed objects set to the background value.
+  // The kept objects are already in the input with the foreground value.
+  writer.Write( this->GetInput(), this->GetOutput(), m_BackgroundValue, this->GetNumberOfThreads() );
 }
 
 
@@ -0,0 +1,124 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkFeatureRangeImageCalculator.h,v $
+  Language:  C++
+  Date:      $Date: 2005/08/23 15:09:03 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkFeatureRangeImageCalculator_h
+#define __itkFeatureRangeImageCalculator_h
+
+#include "itkObject.h"
+#include "itkMultiThreader.h"
+#include <vector>
+
+namespace itk {
+
+/** \class FeatureRangeImageCalculator
+ * \brief Compute the minimum and the maximum of the buffer of an image, in parallel
+ *
+ * FeatureRangeImageCalculator does the same job as MinimumMaximumImageCalculator
+ * on the whole buffered region of the image, but reads the buffer directly and
+ * splits it between several threads.
+ *
+ * The result is kept until the image, or its content, is modified: calling Compute()
+ * again on an image which has not been modified since the last computation doesn't
+ * read the image again. The valuators keep their calculator between two updates, so
+ * the range of the feature image is only computed when the feature image changes.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa MinimumMaximumImageCalculator, StatisticsLabelMapFilter, WeightedHistogramLabelMapFilter
+ */
+template<class TInputImage>
+class ITK_EXPORT FeatureRangeImageCalculator :
+    public Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef FeatureRangeImageCalculator Self;
+  typedef Object                      Superclass;
+  typedef SmartPointer<Self>          Pointer;
+  typedef SmartPointer<const Self>    ConstPointer;
+
+  /** Some convenient typedefs. */
+  typedef TInputImage                             InputImageType;
+  typedef typename InputImageType::ConstPointer   InputImageConstPointer;
+  typedef typename InputImageType::PixelType      InputImagePixelType;
+
+  /** Standard New method. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(FeatureRangeImageCalculator,
+               Object);
+
+  /**
+   * Set/Get the number of threads used to compute the range.
+   * It defaults to the global default number of threads.
+   */
+  itkSetClampMacro(NumberOfThreads, int, 1, ITK_MAX_THREADS);
+  itkGetConstReferenceMacro(NumberOfThreads, int);
+
+  /** Set/Get the image */
+  itkSetConstObjectMacro(Image, InputImageType);
+  itkGetConstObjectMacro(Image, InputImageType);
+
+  /** Compute the minimum and the maximum of the image, if they are not up to date */
+  void Compute();
+
+  /** Return whether the range must be computed again for the current image */
+  bool IsRangeOutOfDate() const;
+
+  /** Return the minimum and the maximum found by the last computation */
+  itkGetConstReferenceMacro(Minimum, InputImagePixelType);
+  itkGetConstReferenceMacro(Maximum, InputImagePixelType);
+
+protected:
+  FeatureRangeImageCalculator();
+  ~FeatureRangeImageCalculator() {};
+  void PrintSelf(std::ostream& os, Indent indent) const;
+
+  /** Compute the range of a part of the buffer */
+  void ThreadedCompute( unsigned long begin, unsigned long end, int threadId );
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+private:
+  FeatureRangeImageCalculator(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  int m_NumberOfThreads;
+
+  InputImageConstPointer m_Image;
+
+  InputImagePixelType m_Minimum;
+  InputImagePixelType m_Maximum;
+
+  /** The range found by each thread */
+  std::vector< InputImagePixelType > m_ThreadMinimum;
+  std::vector< InputImagePixelType > m_ThreadMaximum;
+
+  /** The image used for the last computation, and the time of that computation */
+  const InputImageType * m_ComputedImage;
+  TimeStamp              m_ComputeTime;
+
+}; // end of class
+
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#include "itkFeatureRangeImageCalculator.txx"
+#endif
+
+#endif
@@ -0,0 +1,159 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkFeatureRangeImageCalculator.txx,v $
+  Language:  C++
+  Date:      $Date: 2005/08/23 15:09:03 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkFeatureRangeImageCalculator_txx
+#define __itkFeatureRangeImageCalculator_txx
+
+#include "itkFeatureRangeImageCalculator.h"
+#include "itkNumericTraits.h"
+#include <algorithm>
+
+namespace itk {
+
+template <class TInputImage>
+FeatureRangeImageCalculator<TInputImage>
+::FeatureRangeImageCalculator()
+{
+  m_NumberOfThreads = MultiThreader::GetGlobalDefaultNumberOfThreads();
+  m_Image = NULL;
+  m_ComputedImage = NULL;
+  m_Minimum = NumericTraits< InputImagePixelType >::max();
+  m_Maximum = NumericTraits< InputImagePixelType >::NonpositiveMin();
+}
+
+
+template<class TInputImage>
+bool
+FeatureRangeImageCalculator<TInputImage>
+::IsRangeOutOfDate() const
+{
+  const InputImageType * image = m_Image;
+  if( image == NULL || image != m_ComputedImage )
+    {
+    return true;
+    }
+  // the modification time of the image is not updated when a new content is
+  // generated by the pipeline, so the update time is checked too
+  const unsigned long computeTime = m_ComputeTime.GetMTime();
+  return image->GetMTime() > computeTime
+    || image->GetUpdateMTime() > computeTime
+    || this->GetMTime() > computeTime;
+}
+
+
+template<class TInputImage>
+void
+FeatureRangeImageCalculator<TInputImage>
+::Compute()
+{
+  if( !this->IsRangeOutOfDate() )
+    {
+    return;
+    }
+
+  if( m_Image.IsNull() )
+    {
+    itkExceptionMacro( << "No image set." );
+    }
+
+  m_ThreadMinimum.clear();
+  m_ThreadMinimum.resize( m_NumberOfThreads, NumericTraits< InputImagePixelType >::max() );
+  m_ThreadMaximum.clear();
+  m_ThreadMaximum.resize( m_NumberOfThreads, NumericTraits< InputImagePixelType >::NonpositiveMin() );
+
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( m_NumberOfThreads );
+  threader->SetSingleMethod( this->ThreaderCallback, this );
+  threader->SingleMethodExecute();
+
+  // reduce the ranges of all the threads
+  m_Minimum = NumericTraits< InputImagePixelType >::max();
+  m_Maximum = NumericTraits< InputImagePixelType >::NonpositiveMin();
+  for( int i=0; i<m_NumberOfThreads; i++ )
+    {
+    m_Minimum = std::min( m_Minimum, m_ThreadMinimum[i] );
+    m_Maximum = std::max( m_Maximum, m_ThreadMaximum[i] );
+    }
+  m_ThreadMinimum.clear();
+  m_ThreadMaximum.clear();
+
+  m_ComputedImage = m_Image;
+  m_ComputeTime.Modified();
+}
+
+
+template<class TInputImage>
+void
+FeatureRangeImageCalculator<TInputImage>
+::ThreadedCompute( unsigned long begin, unsigned long end, int threadId )
+{
+  const InputImagePixelType * buffer = m_Image->GetBufferPointer();
+
+  // two independent accumulators without branch, so the loop can be vectorized
+  // by the compiler
+  InputImagePixelType min = buffer[begin];
+  InputImagePixelType max = buffer[begin];
+  for( unsigned long i=begin+1; i<end; i++ )
+    {
+    min = std::min( min, buffer[i] );
+    max = std::max( max, buffer[i] );
+    }
+
+  m_ThreadMinimum[ threadId ] = min;
+  m_ThreadMaximum[ threadId ] = max;
+}
+
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+FeatureRangeImageCalculator<TInputImage>
+::ThreaderCallback( void * arg )
+{
+  int threadId = ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  int threadCount = ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+  Self * self = (Self *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  // split the buffer in contiguous parts of the same size
+  const unsigned long numberOfPixels = self->m_Image->GetBufferedRegion().GetNumberOfPixels();
+  const unsigned long pixelsPerThread = ( numberOfPixels + threadCount - 1 ) / threadCount;
+  const unsigned long begin = threadId * pixelsPerThread;
+  const unsigned long end = std::min( begin + pixelsPerThread, numberOfPixels );
+  if( begin < end )
+    {
+    self->ThreadedCompute( begin, end, threadId );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template<class TInputImage>
+void
+FeatureRangeImageCalculator<TInputImage>
+::PrintSelf(std::ostream &os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfThreads: "  << m_NumberOfThreads << std::endl;
+  os << indent << "Image: "  << m_Image.GetPointer() << std::endl;
+  os << indent << "Minimum: "
+     << static_cast<typename NumericTraits<InputImagePixelType>::PrintType>(m_Minimum) << std::endl;
+  os << indent << "Maximum: "
+     << static_cast<typename NumericTraits<InputImagePixelType>::PrintType>(m_Maximum) << std::endl;
+}
+
+}// end namespace itk
+#endif
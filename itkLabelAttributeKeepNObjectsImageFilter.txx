@@ -87,6 +87,8 @@ LabelAttributeKeepNObjectsImageFilter<TInputImage, TLabelObject, TLabelObjectVal
   opening->SetNumberOfObjects( m_NumberOfObjects );
   opening->SetReverseOrdering( m_ReverseOrdering );
   opening->SetNumberOfThreads( this->GetNumberOfThreads() );
+  // only the kept objects are used
+  opening->SetStoreRemovedObjects( false );
   progress->RegisterInternalFilter(opening, .2f);
   
   typename BinarizerType::Pointer binarizer = BinarizerType::New();
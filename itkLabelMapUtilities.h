@@ -17,6 +17,11 @@
 #ifndef __itkLabelMapUtilities_h
 #define __itkLabelMapUtilities_h
 
+#include "itkImageRegion.h"
+#include "itkMultiThreader.h"
+#include <map>
+#include <vector>
+
 namespace itk {
 namespace LabelMapUtilities {
 
@@ -59,6 +64,385 @@ class LineOfLabelObjectComparator
   };
 
 
+/** \class LabelObjectRowIndex
+ * Index the lines of a label object by row - a row being the set of the
+ * indexes with the same position in all the dimensions but the dimension 0.
+ * The lines of a row are sorted and the touching or overlapping lines are
+ * merged, so the runs of a row are always disjoint.
+ * This class makes it possible to get the neighbor lines of a line, and thus to
+ * work on the contour of an object, without rasterizing the label object in an
+ * image: the memory usage stays proportional to the number of lines.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ */
+template<class TLabelObject >
+class LabelObjectRowIndex
+  {
+  public:
+    typedef TLabelObject                       LabelObjectType;
+    typedef typename LabelObjectType::IndexType IndexType;
+    itkStaticConstMacro(ImageDimension, unsigned int, TLabelObject::ImageDimension);
+    typedef ImageRegion< TLabelObject::ImageDimension > RegionType;
+
+    /** A run is stored as the first and the last index of the run in the dimension 0 */
+    typedef std::pair< long, long > RunType;
+    typedef std::vector< RunType >  RunVectorType;
+
+    /** Compare the rows - the dimension 0 is ignored */
+    class RowComparator
+      {
+      public:
+        bool operator()( const IndexType & a, const IndexType & b ) const
+          {
+          for( int i=ImageDimension-1; i>0; i-- )
+            {
+            if( a[i] < b[i] )
+              {
+              return true;
+              }
+            else if( a[i] > b[i] )
+              {
+              return false;
+              }
+            }
+          return false;
+          }
+      };
+    typedef std::map< IndexType, RunVectorType, RowComparator > RowMapType;
+
+    LabelObjectRowIndex( const LabelObjectType * labelObject );
+
+    /** Return all the rows of the object */
+    const RowMapType & GetRows() const
+      {
+      return m_Rows;
+      }
+
+    /** Return the runs of the row which contains idx, or NULL if the object
+     * has no line in that row. idx[0] is ignored. */
+    const RunVectorType * GetRuns( const IndexType & idx ) const
+      {
+      typename RowMapType::const_iterator it = m_Rows.find( idx );
+      if( it == m_Rows.end() )
+        {
+        return NULL;
+        }
+      return &it->second;
+      }
+
+    /** Push in indexes all the pixels of the object which have at least one
+     * neighbor, in the fully connected neighborhood, which is not in the object.
+     * The pixels on the border of the region are considered to be on the border
+     * of the object. */
+    template< class TIndexContainer >
+    void GetBorderIndexes( const RegionType & region, TIndexContainer & indexes ) const;
+
+    /** Remove one pixel at both ends of the runs, and drop the runs which become
+     * empty. A pixel is kept in the output only if its 2 neighbors in the dimension 0
+     * are in the input runs. */
+    static void ErodeRuns( const RunVectorType & runs, RunVectorType & out );
+
+    /** Store in out the intersection of the sorted and disjoint runs a and b */
+    static void IntersectRuns( const RunVectorType & a, const RunVectorType & b, RunVectorType & out );
+
+  private:
+    RowMapType m_Rows;
+  };
+
+
+/** \class RunIntersectionTester
+ * Test if a label object intersects a set of lines, without rasterizing them
+ * in an image. The lines are sorted by row and the touching or overlapping
+ * lines are merged, so the lines of a label object are found with a binary
+ * search, after a rejection of the objects outside of the bounding box of the
+ * lines. The cost of a test is proportional to the number of lines of the
+ * tested object, and not to its number of pixels.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ */
+template<class TLabelObject >
+class RunIntersectionTester
+  {
+  public:
+    typedef TLabelObject                        LabelObjectType;
+    typedef typename LabelObjectType::IndexType IndexType;
+    itkStaticConstMacro(ImageDimension, unsigned int, TLabelObject::ImageDimension);
+
+    /** Add the lines of a label object to the set of lines */
+    void AddLabelObject( const LabelObjectType * labelObject );
+
+    /** Sort and merge the lines. Must be called after the last AddLabelObject(),
+     * and before Intersects(). */
+    void Initialize();
+
+    bool IsEmpty() const
+      {
+      return m_Runs.empty();
+      }
+
+    /** Return true if at least one pixel of the label object is in the set of lines */
+    bool Intersects( const LabelObjectType * labelObject ) const;
+
+  private:
+    /** A run - the index of its first pixel, and the position of its last pixel in
+     * the dimension 0 */
+    struct RunType
+      {
+      IndexType Index;
+      long      End;
+      };
+    typedef std::vector< RunType > RunVectorType;
+
+    /** Sort the runs by row, and then by position of their last pixel in the row.
+     * The runs of a row are disjoint, so it is also the order of their first pixels. */
+    class RunComparator
+      {
+      public:
+        bool operator()( const RunType & a, const RunType & b ) const
+          {
+          for( int i=ImageDimension-1; i>0; i-- )
+            {
+            if( a.Index[i] < b.Index[i] )
+              {
+              return true;
+              }
+            else if( a.Index[i] > b.Index[i] )
+              {
+              return false;
+              }
+            }
+          return a.End < b.End;
+          }
+      };
+
+    /** Sort the runs by row, and then by position of their first pixel in the row */
+    class StartComparator
+      {
+      public:
+        bool operator()( const RunType & a, const RunType & b ) const
+          {
+          for( int i=ImageDimension-1; i>=0; i-- )
+            {
+            if( a.Index[i] < b.Index[i] )
+              {
+              return true;
+              }
+            else if( a.Index[i] > b.Index[i] )
+              {
+              return false;
+              }
+            }
+          return false;
+          }
+      };
+
+    static bool IsSameRow( const IndexType & a, const IndexType & b )
+      {
+      for( int i=1; i<ImageDimension; i++ )
+        {
+        if( a[i] != b[i] )
+          {
+          return false;
+          }
+        }
+      return true;
+      }
+
+    RunVectorType m_Runs;
+    IndexType     m_Minimum;
+    IndexType     m_Maximum;
+  };
+
+
+/** \class UniqueLinesResolver
+ * Remove the overlaps between the lines of several label objects: a pixel in
+ * several objects is only kept in the object with the highest rank.
+ * The lines can only overlap in the same row, so the lines are bucketed by row,
+ * and the rows where the lines overlap are detected with a single sweep on
+ * their sorted lines. Only the objects with a line in one of those rows need a
+ * rank, and only their lines in those rows are modified: the rows are
+ * processed in parallel, and the lines kept are put back in their objects.
+ * The other objects and the other lines are left untouched.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ */
+template<class TLabelObject >
+class UniqueLinesResolver
+  {
+  public:
+    typedef TLabelObject                        LabelObjectType;
+    typedef typename LabelObjectType::IndexType IndexType;
+    itkStaticConstMacro(ImageDimension, unsigned int, TLabelObject::ImageDimension);
+
+    /** Add the lines of the object in the resolver. The objects are numbered in
+     * the order they are added, starting from 0. */
+    void AddLabelObject( LabelObjectType * labelObject );
+
+    /** Detect the rows where some lines overlap, and return true if there is
+     * at least one. Only the lines of those rows are kept in the resolver. */
+    bool FindOverlaps();
+
+    /** The numbers of the objects with at least one line in a row with
+     * overlaps. They are the only ones which require a rank. */
+    const std::vector< unsigned long > & GetOverlappingObjects() const
+      {
+      return m_OverlappingObjects;
+      }
+
+    /** Set the rank of an object. Where the objects overlap, the pixels are
+     * kept in the object with the highest rank. */
+    void SetRank( unsigned long object, unsigned long rank )
+      {
+      m_Ranks[ object ] = rank;
+      }
+
+    /** Remove the overlaps found by FindOverlaps() in the objects */
+    void Resolve( int numberOfThreads );
+
+  private:
+    /** A run of an object - the index of its first pixel, and the position of its
+     * last pixel in the dimension 0 */
+    struct RunType
+      {
+      IndexType     Index;
+      long          End;
+      unsigned long Object;
+      };
+    typedef std::vector< RunType > RunVectorType;
+
+    /** Sort the runs by row, and then by position in the row */
+    class RunComparator
+      {
+      public:
+        bool operator()( const RunType & a, const RunType & b ) const
+          {
+          for( int i=ImageDimension-1; i>=0; i-- )
+            {
+            if( a.Index[i] < b.Index[i] )
+              {
+              return true;
+              }
+            else if( a.Index[i] > b.Index[i] )
+              {
+              return false;
+              }
+            }
+          return false;
+          }
+      };
+
+    /** Compare the rows of the runs only */
+    class RowComparator
+      {
+      public:
+        bool operator()( const RunType & a, const RunType & b ) const
+          {
+          for( int i=ImageDimension-1; i>0; i-- )
+            {
+            if( a.Index[i] < b.Index[i] )
+              {
+              return true;
+              }
+            else if( a.Index[i] > b.Index[i] )
+              {
+              return false;
+              }
+            }
+          return false;
+          }
+      };
+
+    /** The runs of the sweep, sorted by rank */
+    typedef std::pair< unsigned long, const RunType * > ActiveRunType;
+
+    void ResolveRows( unsigned long beginRow, unsigned long endRow, RunVectorType & out ) const;
+
+    static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+    std::vector< LabelObjectType * > m_LabelObjects;
+    std::vector< unsigned long >     m_Ranks;
+    std::vector< unsigned long >     m_OverlappingObjects;
+    /** The runs of the rows with overlaps, once FindOverlaps() is called */
+    RunVectorType                    m_Runs;
+    /** The position of the first run of each row in m_Runs */
+    std::vector< unsigned long >     m_RowStarts;
+    std::vector< RunVectorType >     m_ThreadRuns;
+  };
+
+
+/** \class RemovedRunsWriter
+ * Write an image where the pixels of the removed label objects are replaced by
+ * a value, and where the other pixels are copied from an input image.
+ * The runs of the removed objects are bucketed by row, and each row of the
+ * output is written once and in order: the input is copied between the removed
+ * runs, and the value is written in the removed runs. The rows are written in
+ * parallel, by contiguous bands.
+ * The input and the output must be fully buffered on their largest possible region.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ */
+template<class TLabelObject, class TImage >
+class RemovedRunsWriter
+  {
+  public:
+    typedef TLabelObject                    LabelObjectType;
+    typedef TImage                          ImageType;
+    typedef typename ImageType::PixelType   PixelType;
+    typedef typename ImageType::IndexType   IndexType;
+    typedef typename ImageType::SizeType    SizeType;
+    typedef typename ImageType::RegionType  RegionType;
+    itkStaticConstMacro(ImageDimension, unsigned int, TImage::ImageDimension);
+
+    /** Add a removed label object */
+    void AddLabelObject( const LabelObjectType * labelObject )
+      {
+      m_LabelObjects.push_back( labelObject );
+      }
+
+    /** Write the output, and forget the removed label objects */
+    void Write( const ImageType * input, ImageType * output, const PixelType & value, int numberOfThreads );
+
+  private:
+    /** A run of a removed object - the number of its row in the region, and the
+     * position of its first and last pixels in the row */
+    struct RunType
+      {
+      unsigned long Row;
+      long          First;
+      long          Last;
+      };
+    typedef std::vector< RunType > RunVectorType;
+
+    /** Sort the runs by row, and then by position in the row */
+    class RunComparator
+      {
+      public:
+        bool operator()( const RunType & a, const RunType & b ) const
+          {
+          return a.Row < b.Row || ( a.Row == b.Row && a.First < b.First );
+          }
+      };
+
+    void WriteRows( unsigned long beginRow, unsigned long endRow ) const;
+
+    static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
+
+    std::vector< const LabelObjectType * > m_LabelObjects;
+    RunVectorType                          m_Runs;
+    const ImageType *                      m_Input;
+    ImageType *                            m_Output;
+    PixelType                              m_Value;
+    RegionType                             m_Region;
+    unsigned long                          m_NumberOfRows;
+  };
+
+
+/**
+ * Remove the overlaps between the objects of the label map, and then the empty
+ * objects. Only the objects with some lines in the rows where the objects
+ * overlap are modified and optimized - the lines of the other objects are kept
+ * as they are.
+ */
 template<class TFilter, class TAttributeAccessor>
 void UniqueGenerateData( TFilter * self, typename TFilter::ImageType * labelMap, bool reverseOrder );
 
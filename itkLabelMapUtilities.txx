@@ -17,222 +17,778 @@
 #ifndef __itkLabelMapUtilities_txx
 #define __itkLabelMapUtilities_txx
 
-#include <queue>
+#include <algorithm>
 
 namespace itk {
 
 namespace LabelMapUtilities {
 
-template <class TFilter, class TAttributeAccessor>
-void UniqueGenerateData( TFilter * self, typename TFilter::ImageType * labelMap, bool reverseOrder )
+template <class TLabelObject>
+LabelObjectRowIndex<TLabelObject>
+::LabelObjectRowIndex( const LabelObjectType * labelObject )
 {
-  typedef typename TFilter::ImageType                         ImageType;
-  typedef typename TFilter::IndexType                         IndexType;
-  typedef typename TFilter::LabelObjectType                   LabelObjectType;
-  typedef typename LabelObjectType::LineType                  LineType;
-  typedef TAttributeAccessor                                  AttributeAccessorType;
-  typedef typename AttributeAccessorType::AttributeValueType  AttributeValueType;
-  typedef LineOfLabelObject< LabelObjectType >                LineOfLabelObjectType;
-  
-  int const ImageDimension = TFilter::ImageDimension;
+  typedef typename LabelObjectType::LineContainerType LineContainerType;
+  const LineContainerType & lineContainer = labelObject->GetLineContainer();
 
-  // Allocate the output
-  // self->AllocateOutputs();
+  // dispatch the lines in their row
+  for( typename LineContainerType::const_iterator lit = lineContainer.begin();
+    lit != lineContainer.end();
+    lit++ )
+    {
+    const IndexType & idx = lit->GetIndex();
+    m_Rows[ idx ].push_back( RunType( idx[0], idx[0] + (long)lit->GetLength() - 1 ) );
+    }
 
-  // the priority queue to store all the lines of all the objects sorted
-  typedef typename std::priority_queue< LineOfLabelObjectType, typename std::vector<LineOfLabelObjectType>, LineOfLabelObjectComparator< LabelObjectType > > PriorityQueueType;
-  PriorityQueueType pq;
+  // sort the runs of all the rows and merge the ones which are touching or
+  // overlapping
+  for( typename RowMapType::iterator it = m_Rows.begin(); it != m_Rows.end(); it++ )
+    {
+    RunVectorType & runs = it->second;
+    std::sort( runs.begin(), runs.end() );
+    typename RunVectorType::iterator last = runs.begin();
+    for( typename RunVectorType::iterator rit = runs.begin() + 1; rit != runs.end(); rit++ )
+      {
+      if( rit->first <= last->second + 1 )
+        {
+        last->second = std::max( last->second, rit->second );
+        }
+      else
+        {
+        last++;
+        *last = *rit;
+        }
+      }
+    runs.erase( last + 1, runs.end() );
+    }
+}
 
-  ProgressReporter progress( self, 0, 1 );
-  // TODO: really report the progress
-  
-  typedef typename ImageType::LabelObjectContainerType LabelObjectContainerType;
 
-  const LabelObjectContainerType & labelObjects = labelMap->GetLabelObjectContainer();
-  for( typename LabelObjectContainerType::const_iterator it2 = labelObjects.begin();
-    it2 != labelObjects.end();
-    it2++ )
+template <class TLabelObject>
+void
+LabelObjectRowIndex<TLabelObject>
+::ErodeRuns( const RunVectorType & runs, RunVectorType & out )
+{
+  out.clear();
+  for( typename RunVectorType::const_iterator it = runs.begin(); it != runs.end(); it++ )
     {
-    LabelObjectType * lo = it2->second;
-    
-    // may reduce the number of lines to proceed
-    lo->Optimize();
-    
-    typename LabelObjectType::LineContainerType::const_iterator lit;
-    typename LabelObjectType::LineContainerType & lineContainer = lo->GetLineContainer();
-  
-    for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+    if( it->first + 1 <= it->second - 1 )
       {
-      pq.push( LineOfLabelObjectType( *lit, lo ) );
+      out.push_back( RunType( it->first + 1, it->second - 1 ) );
       }
-    
-    // clear the lines to readd them later
-    lineContainer.clear();
-    
-    // go to the next label
-    // progress.CompletedPixel();
     }
-    
-  if( pq.empty() )
+}
+
+
+template <class TLabelObject>
+void
+LabelObjectRowIndex<TLabelObject>
+::IntersectRuns( const RunVectorType & a, const RunVectorType & b, RunVectorType & out )
+{
+  out.clear();
+  typename RunVectorType::const_iterator ait = a.begin();
+  typename RunVectorType::const_iterator bit = b.begin();
+  while( ait != a.end() && bit != b.end() )
     {
-    // nothing to do
-    return;
+    long first = std::max( ait->first, bit->first );
+    long last = std::min( ait->second, bit->second );
+    if( first <= last )
+      {
+      out.push_back( RunType( first, last ) );
+      }
+    // move the run which ends first
+    if( ait->second < bit->second )
+      {
+      ait++;
+      }
+    else
+      {
+      bit++;
+      }
     }
-    
-  AttributeAccessorType accessor;
+}
 
-  typedef typename std::deque<LineOfLabelObjectType> LinesType;
-  LinesType lines;
 
-  lines.push_back( pq.top() );
-  LineOfLabelObjectType prev = lines.back();
-  IndexType prevIdx = prev.line.GetIndex();
-  pq.pop();
-  
-  while( !pq.empty() )
+template <class TLabelObject>
+template <class TIndexContainer>
+void
+LabelObjectRowIndex<TLabelObject>
+::GetBorderIndexes( const RegionType & region, TIndexContainer & indexes ) const
+{
+  IndexType regionMin = region.GetIndex();
+  IndexType regionMax = regionMin;
+  for( int i=0; i<ImageDimension; i++ )
+    {
+    regionMax[i] += region.GetSize()[i] - 1;
+    }
+
+  // the offsets to the neighbor rows: all the combinations of -1, 0 and 1 on the
+  // dimensions 1 to ImageDimension-1, except the row itself which is processed
+  // with the erosion in the dimension 0.
+  typedef std::vector< IndexType > OffsetVectorType;
+  OffsetVectorType rowOffsets;
+  IndexType offset;
+  offset.Fill( -1 );
+  offset[0] = 0;
+  bool done = ( ImageDimension < 2 );
+  while( !done )
     {
-    LineOfLabelObjectType l = pq.top();
-    IndexType idx = l.line.GetIndex();
-    pq.pop();
-    
-    bool newMainLine = false;
-    // don't check dim 0!
+    bool isCenter = true;
     for( int i=1; i<ImageDimension; i++ )
       {
-      if( idx[i] != prevIdx[i] )
+      if( offset[i] != 0 )
         {
-        newMainLine = true;
+        isCenter = false;
         }
       }
-    
-    if( newMainLine )
+    if( !isCenter )
       {
-      // just push the line
-      lines.push_back( l );      
+      rowOffsets.push_back( offset );
       }
-    else
+    // next offset
+    done = true;
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      if( offset[i] < 1 )
+        {
+        offset[i]++;
+        done = false;
+        break;
+        }
+      offset[i] = -1;
+      }
+    }
+
+  // the clipping run, used to put the pixels on the border of the region on
+  // the border of the object
+  RunVectorType clip;
+  if( regionMin[0] + 1 <= regionMax[0] - 1 )
+    {
+    clip.push_back( RunType( regionMin[0] + 1, regionMax[0] - 1 ) );
+    }
+
+  RunVectorType interior;
+  RunVectorType eroded;
+  RunVectorType tmp;
+  for( typename RowMapType::const_iterator it = m_Rows.begin(); it != m_Rows.end(); it++ )
+    {
+    const IndexType & rowIdx = it->first;
+    const RunVectorType & runs = it->second;
+
+    // a row on the border of the region has all its pixels on the border
+    bool onRegionBorder = false;
+    for( int i=1; i<ImageDimension; i++ )
+      {
+      if( rowIdx[i] <= regionMin[i] || rowIdx[i] >= regionMax[i] )
+        {
+        onRegionBorder = true;
+        }
+      }
+
+    // compute the interior pixels: the ones with all their neighbors in the object
+    interior.clear();
+    if( !onRegionBorder )
       {
-      unsigned long prevLength = prev.line.GetLength();
-      unsigned long length = l.line.GetLength();
-      
-      if( prevIdx[0] + (long)prevLength >= idx[0] )
+      ErodeRuns( runs, eroded );
+      IntersectRuns( eroded, clip, interior );
+      for( typename OffsetVectorType::const_iterator oit = rowOffsets.begin();
+        oit != rowOffsets.end() && !interior.empty();
+        oit++ )
         {
-        // the lines are overlapping. We need to choose which line to keep.
-        // the label, the only "attribute" to be guarenteed to be unique, is used to choose
-        // which line to keep. This is necessary to avoid the case where a part of a label is over
-        // a second label, and below in another part of the image.
-        bool keepCurrent = true;
-        AttributeValueType prevAttr = accessor( prev.labelObject );
-        AttributeValueType attr = accessor( l.labelObject );
-        // self may be changed to a single boolean expression, but may become quite difficult to read
-        if( attr == prevAttr  )
+        IndexType neighborIdx = rowIdx;
+        for( int i=1; i<ImageDimension; i++ )
           {
-          if( l.labelObject->GetLabel() > prev.labelObject->GetLabel() )
-            {
-            keepCurrent = !reverseOrder;
-            }
-          else
-            {
-            keepCurrent = reverseOrder;
-            }
+          neighborIdx[i] += (*oit)[i];
+          }
+        const RunVectorType * neighborRuns = this->GetRuns( neighborIdx );
+        if( neighborRuns == NULL )
+          {
+          interior.clear();
           }
         else
           {
-          if( attr > prevAttr )
-            {
-            keepCurrent = !reverseOrder;
-            }
-          else
-            {
-            keepCurrent = reverseOrder;
-            }
+          ErodeRuns( *neighborRuns, eroded );
+          IntersectRuns( interior, eroded, tmp );
+          interior.swap( tmp );
           }
-        
-        if( keepCurrent )
+        }
+      }
+
+    // the border pixels are the pixels of the runs which are not interior pixels.
+    // The interior runs are sorted and included in the runs of the row.
+    typename RunVectorType::const_iterator iit = interior.begin();
+    for( typename RunVectorType::const_iterator rit = runs.begin(); rit != runs.end(); rit++ )
+      {
+      IndexType idx = rowIdx;
+      idx[0] = rit->first;
+      while( iit != interior.end() && iit->second <= rit->second )
+        {
+        for( ; idx[0] < iit->first; idx[0]++ )
           {
-          // keep the current one. We must truncate the previous one to remove the
-          // overlap, and take care of the end of the previous line if it extends
-          // after the current one.
-          if( prevIdx[0] + prevLength > idx[0] + length )
-            {
-            // the previous line is longer than the current one. Lets take its tail and
-            // add it to the priority queue
-            IndexType newIdx = idx;
-            newIdx[0] = idx[0] + length;
-            unsigned long newLength = prevIdx[0] + prevLength - newIdx[0];
-            pq.push( LineOfLabelObjectType( LineType( newIdx, newLength ), prev.labelObject ) );
-            }
-          // truncate the previous line to let some place for the current one
-          prevLength = idx[0] - prevIdx[0];
-          if( prevLength != 0 )
-            {
-            lines.back().line.SetLength( idx[0] - prevIdx[0] );
-            }
-          else
-            {
-            // length is 0 - no need to keep that line
-            lines.pop_back();
-            }
-          // and push the current one
-          lines.push_back( l );
+          indexes.push_back( idx );
           }
-        else
+        idx[0] = iit->second + 1;
+        iit++;
+        }
+      for( ; idx[0] <= rit->second; idx[0]++ )
+        {
+        indexes.push_back( idx );
+        }
+      }
+    }
+}
+
+
+template <class TLabelObject>
+void
+RunIntersectionTester<TLabelObject>
+::AddLabelObject( const LabelObjectType * labelObject )
+{
+  typedef typename LabelObjectType::LineContainerType LineContainerType;
+  const LineContainerType & lineContainer = labelObject->GetLineContainer();
+  for( typename LineContainerType::const_iterator lit = lineContainer.begin();
+    lit != lineContainer.end();
+    lit++ )
+    {
+    RunType run;
+    run.Index = lit->GetIndex();
+    run.End = run.Index[0] + (long)lit->GetLength() - 1;
+    m_Runs.push_back( run );
+    }
+}
+
+
+template <class TLabelObject>
+void
+RunIntersectionTester<TLabelObject>
+::Initialize()
+{
+  if( m_Runs.empty() )
+    {
+    return;
+    }
+
+  // sort the runs with their first pixel, and merge the ones which are touching
+  // or overlapping
+  std::sort( m_Runs.begin(), m_Runs.end(), StartComparator() );
+  typename RunVectorType::iterator last = m_Runs.begin();
+  m_Minimum = last->Index;
+  m_Maximum = last->Index;
+  m_Maximum[0] = last->End;
+  for( typename RunVectorType::iterator it = m_Runs.begin() + 1; it != m_Runs.end(); it++ )
+    {
+    for( int i=0; i<ImageDimension; i++ )
+      {
+      m_Minimum[i] = std::min( m_Minimum[i], it->Index[i] );
+      m_Maximum[i] = std::max( m_Maximum[i], it->Index[i] );
+      }
+    m_Maximum[0] = std::max( m_Maximum[0], it->End );
+
+    if( IsSameRow( last->Index, it->Index ) && it->Index[0] <= last->End + 1 )
+      {
+      last->End = std::max( last->End, it->End );
+      }
+    else
+      {
+      last++;
+      *last = *it;
+      }
+    }
+  m_Runs.erase( last + 1, m_Runs.end() );
+}
+
+
+template <class TLabelObject>
+bool
+RunIntersectionTester<TLabelObject>
+::Intersects( const LabelObjectType * labelObject ) const
+{
+  if( m_Runs.empty() )
+    {
+    return false;
+    }
+
+  typedef typename LabelObjectType::LineContainerType LineContainerType;
+  const LineContainerType & lineContainer = labelObject->GetLineContainer();
+
+  // the lines outside of the bounding box of the runs are rejected without any
+  // search. For the other ones, search the first run of the row which ends after
+  // the start of the line: the line intersects the runs only if that run starts
+  // before the end of the line.
+  for( typename LineContainerType::const_iterator lit = lineContainer.begin();
+    lit != lineContainer.end();
+    lit++ )
+    {
+    RunType run;
+    run.Index = lit->GetIndex();
+    run.End = run.Index[0] + (long)lit->GetLength() - 1;
+    bool inside = run.Index[0] <= m_Maximum[0] && run.End >= m_Minimum[0];
+    for( int i=1; i<ImageDimension && inside; i++ )
+      {
+      inside = run.Index[i] >= m_Minimum[i] && run.Index[i] <= m_Maximum[i];
+      }
+    if( !inside )
+      {
+      continue;
+      }
+
+    const long lineEnd = run.End;
+    run.End = run.Index[0];
+    typename RunVectorType::const_iterator it = std::lower_bound( m_Runs.begin(), m_Runs.end(), run, RunComparator() );
+    if( it != m_Runs.end() && IsSameRow( it->Index, run.Index ) && it->Index[0] <= lineEnd )
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+
+template <class TLabelObject>
+void
+UniqueLinesResolver<TLabelObject>
+::AddLabelObject( LabelObjectType * labelObject )
+{
+  const unsigned long object = m_LabelObjects.size();
+  m_LabelObjects.push_back( labelObject );
+  m_Ranks.push_back( 0 );
+
+  const typename LabelObjectType::LineContainerType & lineContainer = labelObject->GetLineContainer();
+  for( typename LabelObjectType::LineContainerType::const_iterator lit = lineContainer.begin();
+    lit != lineContainer.end();
+    lit++ )
+    {
+    RunType run;
+    run.Index = lit->GetIndex();
+    run.End = run.Index[0] + (long)lit->GetLength() - 1;
+    run.Object = object;
+    m_Runs.push_back( run );
+    }
+}
+
+
+template <class TLabelObject>
+bool
+UniqueLinesResolver<TLabelObject>
+::FindOverlaps()
+{
+  // bucket the runs by row
+  std::sort( m_Runs.begin(), m_Runs.end(), RunComparator() );
+
+  // keep only the rows where a run starts before the end of a previous run. The
+  // runs of the same object are compared as well, so the objects don't have to
+  // be optimized first.
+  std::vector< bool > overlapping( m_LabelObjects.size(), false );
+  m_OverlappingObjects.clear();
+  m_RowStarts.clear();
+  unsigned long kept = 0;
+  unsigned long rowBegin = 0;
+  while( rowBegin < m_Runs.size() )
+    {
+    unsigned long rowEnd = rowBegin + 1;
+    bool overlap = false;
+    long end = m_Runs[rowBegin].End;
+    while( rowEnd < m_Runs.size() && !RowComparator()( m_Runs[rowBegin], m_Runs[rowEnd] ) )
+      {
+      overlap = overlap || m_Runs[rowEnd].Index[0] <= end;
+      end = std::max( end, m_Runs[rowEnd].End );
+      rowEnd++;
+      }
+    if( overlap )
+      {
+      m_RowStarts.push_back( kept );
+      for( unsigned long i=rowBegin; i<rowEnd; i++ )
+        {
+        const unsigned long object = m_Runs[i].Object;
+        if( !overlapping[ object ] )
           {
-          // keep the previous one. If the previous line fully overlap the current one,
-          // the current one is fully discarded.
-          if( prevIdx[0] + prevLength > idx[0] + length )
-            {
-            // discarding the current line - just do nothing
-            }
-          else
-            {
-            IndexType newIdx = idx;
-            newIdx[0] = prevIdx[0] + prevLength;
-            unsigned long newLength = idx[0] + length - newIdx[0];
-            l.line.SetIndex( newIdx );
-            l.line.SetLength( newLength );
-            lines.push_back( l );
-            }
-          
+          overlapping[ object ] = true;
+          m_OverlappingObjects.push_back( object );
           }
+        m_Runs[ kept++ ] = m_Runs[i];
+        }
+      }
+    rowBegin = rowEnd;
+    }
+  m_Runs.resize( kept );
+  m_RowStarts.push_back( kept );
+  std::sort( m_OverlappingObjects.begin(), m_OverlappingObjects.end() );
+
+  return !m_OverlappingObjects.empty();
+}
+
+
+template <class TLabelObject>
+void
+UniqueLinesResolver<TLabelObject>
+::Resolve( int numberOfThreads )
+{
+  if( m_RowStarts.size() < 2 )
+    {
+    m_LabelObjects.clear();
+    m_Ranks.clear();
+    m_OverlappingObjects.clear();
+    m_Runs.clear();
+    m_RowStarts.clear();
+    return;
+    }
+
+  // remove the lines of the rows with overlaps from their objects - they are
+  // put back once resolved
+  typedef typename LabelObjectType::LineContainerType LineContainerType;
+  for( typename std::vector< unsigned long >::const_iterator oit = m_OverlappingObjects.begin();
+    oit != m_OverlappingObjects.end();
+    oit++ )
+    {
+    LineContainerType & lineContainer = m_LabelObjects[ *oit ]->GetLineContainer();
+    typename LineContainerType::iterator last = lineContainer.begin();
+    for( typename LineContainerType::iterator lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+      {
+      RunType run;
+      run.Index = lit->GetIndex();
+      if( !std::binary_search( m_Runs.begin(), m_Runs.end(), run, RowComparator() ) )
+        {
+        *last = *lit;
+        last++;
+        }
+      }
+    lineContainer.erase( last, lineContainer.end() );
+    }
+
+  // the rows are independent - process them in parallel
+  const unsigned long numberOfRows = m_RowStarts.size() - 1;
+  numberOfThreads = std::max( 1, (int)std::min( (unsigned long)numberOfThreads, numberOfRows ) );
+  m_ThreadRuns.clear();
+  m_ThreadRuns.resize( numberOfThreads );
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( this->ThreaderCallback, this );
+  threader->SingleMethodExecute();
+
+  // put the lines kept back in their objects
+  for( unsigned int t=0; t<m_ThreadRuns.size(); t++ )
+    {
+    const RunVectorType & runs = m_ThreadRuns[t];
+    for( typename RunVectorType::const_iterator it = runs.begin(); it != runs.end(); it++ )
+      {
+      m_LabelObjects[ it->Object ]->AddLine( it->Index, it->End - it->Index[0] + 1 );
+      }
+    }
+
+  // the resolved lines are appended to the untouched ones - sort them again
+  for( typename std::vector< unsigned long >::const_iterator oit = m_OverlappingObjects.begin();
+    oit != m_OverlappingObjects.end();
+    oit++ )
+    {
+    m_LabelObjects[ *oit ]->Optimize();
+    }
+
+  m_LabelObjects.clear();
+  m_Ranks.clear();
+  m_OverlappingObjects.clear();
+  m_Runs.clear();
+  m_RowStarts.clear();
+  m_ThreadRuns.clear();
+}
+
+
+template <class TLabelObject>
+void
+UniqueLinesResolver<TLabelObject>
+::ResolveRows( unsigned long beginRow, unsigned long endRow, RunVectorType & out ) const
+{
+  // the runs which contain the current position, in a heap with the run of
+  // the object of highest rank on top. The runs which end before the current
+  // position are only removed when they reach the top.
+  std::vector< ActiveRunType > active;
+
+  for( unsigned long row=beginRow; row<endRow; row++ )
+    {
+    const RunType * runs = &m_Runs[ m_RowStarts[row] ];
+    const unsigned long numberOfRuns = m_RowStarts[row+1] - m_RowStarts[row];
+    const unsigned long rowBegin = out.size();
+    active.clear();
+
+    unsigned long i = 0;
+    long pos = runs[0].Index[0];
+    while( i < numberOfRuns || !active.empty() )
+      {
+      if( active.empty() )
+        {
+        pos = std::max( pos, runs[i].Index[0] );
+        }
+      // the runs starting at the current position
+      while( i < numberOfRuns && runs[i].Index[0] <= pos )
+        {
+        active.push_back( ActiveRunType( m_Ranks[ runs[i].Object ], &runs[i] ) );
+        std::push_heap( active.begin(), active.end() );
+        i++;
+        }
+      // the runs already finished
+      while( !active.empty() && active.front().second->End < pos )
+        {
+        std::pop_heap( active.begin(), active.end() );
+        active.pop_back();
+        }
+      if( active.empty() )
+        {
+        continue;
+        }
+
+      // the object of highest rank keeps the pixels up to the end of its run, or
+      // up to the start of the next run, which may have a higher rank
+      const RunType * top = active.front().second;
+      long end = top->End;
+      if( i < numberOfRuns )
+        {
+        end = std::min( end, runs[i].Index[0] - 1 );
+        }
+      if( out.size() > rowBegin && out.back().Object == top->Object && out.back().End + 1 == pos )
+        {
+        out.back().End = end;
         }
       else
         {
-        // no overlap - things are just fine already
-        lines.push_back( l );
+        RunType run;
+        run.Index = top->Index;
+        run.Index[0] = pos;
+        run.End = end;
+        run.Object = top->Object;
+        out.push_back( run );
         }
+      pos = end + 1;
       }
-    
-    // store the current line as the previous one, and go to the next one.
-    prev = lines.back();
-    prevIdx = prev.line.GetIndex();
     }
+}
+
+
+template <class TLabelObject>
+ITK_THREAD_RETURN_TYPE
+UniqueLinesResolver<TLabelObject>
+::ThreaderCallback( void * arg )
+{
+  int threadId = ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  int threadCount = ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+  UniqueLinesResolver * self = (UniqueLinesResolver *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  // split the rows in contiguous parts with about the same number of runs
+  const unsigned long numberOfRuns = self->m_Runs.size();
+  typename std::vector< unsigned long >::const_iterator rowsBegin = self->m_RowStarts.begin();
+  typename std::vector< unsigned long >::const_iterator rowsEnd = self->m_RowStarts.end() - 1;
+  const unsigned long beginRow = std::lower_bound( rowsBegin, rowsEnd, numberOfRuns * threadId / threadCount ) - rowsBegin;
+  const unsigned long endRow = std::lower_bound( rowsBegin, rowsEnd, numberOfRuns * ( threadId + 1 ) / threadCount ) - rowsBegin;
+  self->ResolveRows( beginRow, endRow, self->m_ThreadRuns[ threadId ] );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+template <class TLabelObject, class TImage>
+void
+RemovedRunsWriter<TLabelObject, TImage>
+::Write( const ImageType * input, ImageType * output, const PixelType & value, int numberOfThreads )
+{
+  m_Input = input;
+  m_Output = output;
+  m_Value = value;
+  m_Region = output->GetLargestPossibleRegion();
+  if( m_Region.GetNumberOfPixels() == 0 )
+    {
+    m_LabelObjects.clear();
+    return;
+    }
+  const IndexType & start = m_Region.GetIndex();
+  const SizeType & size = m_Region.GetSize();
+  m_NumberOfRows = m_Region.GetNumberOfPixels() / size[0];
+
+  // bucket the runs of the removed objects by row
+  m_Runs.clear();
+  for( typename std::vector< const LabelObjectType * >::const_iterator oit = m_LabelObjects.begin();
+    oit != m_LabelObjects.end();
+    oit++ )
+    {
+    const typename LabelObjectType::LineContainerType & lineContainer = (*oit)->GetLineContainer();
+    for( typename LabelObjectType::LineContainerType::const_iterator lit = lineContainer.begin();
+      lit != lineContainer.end();
+      lit++ )
+      {
+      const IndexType & idx = lit->GetIndex();
+      RunType run;
+      run.Row = 0;
+      for( int i=ImageDimension-1; i>0; i-- )
+        {
+        run.Row = run.Row * size[i] + ( idx[i] - start[i] );
+        }
+      run.First = idx[0] - start[0];
+      run.Last = run.First + (long)lit->GetLength() - 1;
+      m_Runs.push_back( run );
+      }
+    }
+  std::sort( m_Runs.begin(), m_Runs.end(), RunComparator() );
+
+  numberOfThreads = std::max( 1, (int)std::min( (unsigned long)numberOfThreads, m_NumberOfRows ) );
+  MultiThreader::Pointer threader = MultiThreader::New();
+  threader->SetNumberOfThreads( numberOfThreads );
+  threader->SetSingleMethod( this->ThreaderCallback, this );
+  threader->SingleMethodExecute();
+
+  m_LabelObjects.clear();
+  m_Runs.clear();
+}
+
+
+template <class TLabelObject, class TImage>
+void
+RemovedRunsWriter<TLabelObject, TImage>
+::WriteRows( unsigned long beginRow, unsigned long endRow ) const
+{
+  const long length = m_Region.GetSize()[0];
+  const PixelType * in = m_Input->GetBufferPointer() + m_Input->ComputeOffset( m_Region.GetIndex() ) + beginRow * length;
+  PixelType * out = m_Output->GetBufferPointer() + m_Output->ComputeOffset( m_Region.GetIndex() ) + beginRow * length;
+
+  RunType first;
+  first.Row = beginRow;
+  first.First = -1;
+  typename RunVectorType::const_iterator it = std::lower_bound( m_Runs.begin(), m_Runs.end(), first, RunComparator() );
+
+  for( unsigned long row=beginRow; row<endRow; row++ )
+    {
+    // copy the input up to the next removed run, and clear the removed run
+    long pos = 0;
+    for( ; it != m_Runs.end() && it->Row == row; it++ )
+      {
+      if( it->First > pos )
+        {
+        std::copy( in + pos, in + it->First, out + pos );
+        }
+      std::fill( out + it->First, out + it->Last + 1, m_Value );
+      pos = std::max( pos, it->Last + 1 );
+      }
+    std::copy( in + pos, in + length, out + pos );
+    in += length;
+    out += length;
+    }
+}
+
+
+template <class TLabelObject, class TImage>
+ITK_THREAD_RETURN_TYPE
+RemovedRunsWriter<TLabelObject, TImage>
+::ThreaderCallback( void * arg )
+{
+  int threadId = ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  int threadCount = ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+  RemovedRunsWriter * self = (RemovedRunsWriter *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  // split the rows in contiguous bands of the same size
+  const unsigned long numberOfRows = self->m_NumberOfRows;
+  self->WriteRows( numberOfRows * threadId / threadCount, numberOfRows * ( threadId + 1 ) / threadCount );
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+
+/** Sort the objects by attribute value, and then by label */
+template <class TLabelObject, class TAttributeValue>
+class AttributeRankComparator
+  {
+  public:
+    AttributeRankComparator( const std::vector< TLabelObject * > & labelObjects,
+                             const std::vector< TAttributeValue > & attributes,
+                             bool reverseOrder )
+      : m_LabelObjects( labelObjects ), m_Attributes( attributes ), m_ReverseOrder( reverseOrder ) {}
+
+    bool operator()( unsigned long a, unsigned long b ) const
+      {
+      if( m_ReverseOrder )
+        {
+        std::swap( a, b );
+        }
+      if( m_Attributes[a] == m_Attributes[b] )
+        {
+        return m_LabelObjects[b]->GetLabel() > m_LabelObjects[a]->GetLabel();
+        }
+      return m_Attributes[b] > m_Attributes[a];
+      }
+
+  private:
+    const std::vector< TLabelObject * > & m_LabelObjects;
+    const std::vector< TAttributeValue > & m_Attributes;
+    bool                                   m_ReverseOrder;
+  };
+
+
+template <class TFilter, class TAttributeAccessor>
+void UniqueGenerateData( TFilter * self, typename TFilter::ImageType * labelMap, bool reverseOrder )
+{
+  typedef typename TFilter::ImageType                         ImageType;
+  typedef typename TFilter::LabelObjectType                   LabelObjectType;
+  typedef TAttributeAccessor                                  AttributeAccessorType;
+  typedef typename AttributeAccessorType::AttributeValueType  AttributeValueType;
+
+  // Allocate the output
+  // self->AllocateOutputs();
+
+  ProgressReporter progress( self, 0, 1 );
+  // TODO: really report the progress
   
-  // put the lines in their object
-  for( unsigned int i=0; i<lines.size(); i++ )
+  typedef typename ImageType::LabelObjectContainerType LabelObjectContainerType;
+
+  // find the rows where the objects overlap. Most of the time, only a few
+  // objects have some lines in those rows, and the other ones are not modified.
+  UniqueLinesResolver< LabelObjectType > resolver;
+  std::vector< LabelObjectType * > labelObjectVector;
+  const LabelObjectContainerType & labelObjects = labelMap->GetLabelObjectContainer();
+  for( typename LabelObjectContainerType::const_iterator it2 = labelObjects.begin();
+    it2 != labelObjects.end();
+    it2++ )
     {
-    LineOfLabelObjectType & l = lines[i];
-    l.labelObject->AddLine( l.line );
+    labelObjectVector.push_back( it2->second );
+    resolver.AddLabelObject( it2->second );
+    }
+  if( resolver.FindOverlaps() )
+    {
+    const std::vector< unsigned long > & overlappingObjects = resolver.GetOverlappingObjects();
+
+    // read the attributes only once, and before the threads: reading them may
+    // trigger their lazy evaluation. Only the objects which overlap are read.
+    AttributeAccessorType accessor;
+    std::vector< AttributeValueType > attributes( labelObjectVector.size() );
+    for( unsigned long i=0; i<overlappingObjects.size(); i++ )
+      {
+      attributes[ overlappingObjects[i] ] = accessor( labelObjectVector[ overlappingObjects[i] ] );
+      }
+
+    // the rank of the objects. Where the objects overlap, the pixels are kept in the
+    // object with the highest attribute - or the lowest with reverseOrder. The label,
+    // the only "attribute" to be guarenteed to be unique, is used to choose between
+    // the objects with the same attribute value. This is necessary to avoid the case
+    // where a part of a label is over a second label, and below in another part of
+    // the image.
+    std::vector< unsigned long > order( overlappingObjects.begin(), overlappingObjects.end() );
+    std::sort( order.begin(), order.end(),
+      AttributeRankComparator< LabelObjectType, AttributeValueType >( labelObjectVector, attributes, reverseOrder ) );
+    for( unsigned long i=0; i<order.size(); i++ )
+      {
+      resolver.SetRank( order[i], i );
+      }
+    resolver.Resolve( self->GetNumberOfThreads() );
     }
 
-  // remove objects without lines
+  // remove the objects without lines - the ones emptied above, and the ones
+  // which were already empty. The other objects are left untouched: unlike the
+  // objects with overlaps, their lines are not optimized.
   typename LabelObjectContainerType::const_iterator it = labelObjects.begin();
   while( it != labelObjects.end() )
     {
     typename LabelObjectType::LabelType label = it->first;
     LabelObjectType * labelObject = it->second;
 
+    // must increment the iterator before removing the object to avoid invalidating the iterator
+    it++;
     if( labelObject->Empty() )
       {
-      // must increment the iterator before removing the object to avoid invalidating the iterator
-      it++;
       labelMap->RemoveLabel( label );
       }
-    else
-      {
-      it++;
-      }
-
     }
 }
 
@@ -18,13 +18,9 @@
 #define __itkLabelReconstructionByDilationImageFilter_h
 
 #include "itkImageToImageFilter.h"
-#include "itkAttributeLabelObject.h"
-#include "itkLabelMap.h"
-#include "itkLabelImageToLabelMapFilter.h"
-#include "itkLabelReconstructionLabelMapFilter.h"
-#include "itkAttributeOpeningLabelMapFilter.h"
-#include "itkLabelMapToLabelImageFilter.h"
-
+#include "itkMultiThreader.h"
+#include <set>
+#include <vector>
 
 namespace itk {
 
@@ -77,13 +73,6 @@ public:
   itkStaticConstMacro(ImageDimension, unsigned int,
                       TInputImage::ImageDimension);
 
-  typedef AttributeLabelObject<unsigned long, ImageDimension, bool> LabelObjectType;
-  typedef typename itk::LabelMap< LabelObjectType > LabelMapType;
-  typedef typename itk::LabelImageToLabelMapFilter< InputImageType, LabelMapType > LabelizerType;
-  typedef typename itk::LabelReconstructionLabelMapFilter< LabelMapType, InputImageType > ReconstructionType;
-  typedef typename itk::AttributeOpeningLabelMapFilter< LabelMapType > OpeningType;
-  typedef typename itk::LabelMapToLabelImageFilter< LabelMapType, OutputImageType > BinarizerType;
-
   /** Standard New method. */
   itkNewMacro(Self);  
 
@@ -149,9 +138,19 @@ protected:
   /** LabelReconstructionByDilationImageFilter will produce the entire output. */
   void EnlargeOutputRequestedRegion(DataObject *itkNotUsed(output));
   
-  /** Single-threaded version of GenerateData.  This filter delegates
-   * to GrayscaleGeodesicErodeImageFilter. */
+  /** The labels of the mask which have a pixel with the same label in the marker
+   * are found in a first pass on the images, and the output is written in a second
+   * pass. Both passes are run in parallel, without any intermediate label map. */
   void GenerateData();
+
+  /** Find the labels with a marker in a part of the buffer */
+  void ThreadedFindMarkedLabels( unsigned long begin, unsigned long end, int threadId );
+
+  /** Write a part of the output */
+  void ThreadedWriteOutput( unsigned long begin, unsigned long end );
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback( void * arg );
   
 
 private:
@@ -159,7 +158,16 @@ private:
   void operator=(const Self&); //purposely not implemented
 
   OutputImagePixelType m_BackgroundValue;
-  
+
+  typedef std::set< InputImagePixelType > LabelSetType;
+
+  /** The labels with a marker found by each thread, and all of them */
+  std::vector< LabelSetType > m_ThreadMarkedLabels;
+  LabelSetType                m_MarkedLabels;
+
+  /** Whether the threads write the output, or search the marked labels */
+  bool m_WriteOutput;
+
 }; // end of class
 
 } // end namespace itk
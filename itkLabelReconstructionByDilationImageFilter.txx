@@ -18,7 +18,8 @@
 #define __itkLabelReconstructionByDilationImageFilter_txx
 
 #include "itkLabelReconstructionByDilationImageFilter.h"
-#include "itkProgressAccumulator.h"
+#include "itkProgressReporter.h"
+#include <algorithm>
 
 
 namespace itk {
@@ -28,6 +29,7 @@ LabelReconstructionByDilationImageFilter<TInputImage>
 ::LabelReconstructionByDilationImageFilter()
 {
   m_BackgroundValue = NumericTraits<OutputImagePixelType>::NonpositiveMin();
+  m_WriteOutput = false;
   this->SetNumberOfRequiredInputs(2);
 }
 
@@ -69,39 +71,102 @@ void
 LabelReconstructionByDilationImageFilter<TInputImage>
 ::GenerateData()
 {
-  // Create a process accumulator for tracking the progress of this minipipeline
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-  progress->SetMiniPipelineFilter(this);
+  ProgressReporter progress( this, 0, 2 );
 
   // Allocate the output
   this->AllocateOutputs();
-  
-  typename LabelizerType::Pointer labelizer = LabelizerType::New();
-  labelizer->SetInput( this->GetMaskImage() );
-  labelizer->SetBackgroundValue( m_BackgroundValue );
-  labelizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(labelizer, .25f);
-  
-  typename ReconstructionType::Pointer reconstruction = ReconstructionType::New();
-  reconstruction->SetInput( labelizer->GetOutput() );
-  reconstruction->SetMarkerImage( this->GetMarkerImage() );
-  reconstruction->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(reconstruction, .25f);
-  
-  typename OpeningType::Pointer opening = OpeningType::New();
-  opening->SetInput( reconstruction->GetOutput() );
-  opening->SetLambda( true );
-  opening->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(opening, .25f);
-
-  typename BinarizerType::Pointer binarizer = BinarizerType::New();
-  binarizer->SetInput( opening->GetOutput() );
-  binarizer->SetNumberOfThreads( this->GetNumberOfThreads() );
-  progress->RegisterInternalFilter(binarizer, .5f);  
-
-  binarizer->GraftOutput( this->GetOutput() );
-  binarizer->Update();
-  this->GraftOutput( binarizer->GetOutput() );
+
+  const int numberOfThreads = this->GetNumberOfThreads();
+  this->GetMultiThreader()->SetNumberOfThreads( numberOfThreads );
+  this->GetMultiThreader()->SetSingleMethod( this->ThreaderCallback, this );
+
+  // find the labels with a marker
+  m_ThreadMarkedLabels.clear();
+  m_ThreadMarkedLabels.resize( numberOfThreads );
+  m_WriteOutput = false;
+  this->GetMultiThreader()->SingleMethodExecute();
+  m_MarkedLabels.clear();
+  for( int i=0; i<numberOfThreads; i++ )
+    {
+    m_MarkedLabels.insert( m_ThreadMarkedLabels[i].begin(), m_ThreadMarkedLabels[i].end() );
+    }
+  m_ThreadMarkedLabels.clear();
+  progress.CompletedPixel();
+
+  // keep only the objects of those labels
+  m_WriteOutput = true;
+  this->GetMultiThreader()->SingleMethodExecute();
+  m_MarkedLabels.clear();
+  progress.CompletedPixel();
+}
+
+
+template<class TInputImage>
+void
+LabelReconstructionByDilationImageFilter<TInputImage>
+::ThreadedFindMarkedLabels( unsigned long begin, unsigned long end, int threadId )
+{
+  const InputImagePixelType * mask = this->GetMaskImage()->GetBufferPointer();
+  const InputImagePixelType * marker = this->GetMarkerImage()->GetBufferPointer();
+  LabelSetType & labels = m_ThreadMarkedLabels[ threadId ];
+
+  for( unsigned long i=begin; i<end; i++ )
+    {
+    if( mask[i] == marker[i] && mask[i] != m_BackgroundValue )
+      {
+      labels.insert( mask[i] );
+      }
+    }
+}
+
+
+template<class TInputImage>
+void
+LabelReconstructionByDilationImageFilter<TInputImage>
+::ThreadedWriteOutput( unsigned long begin, unsigned long end )
+{
+  const InputImagePixelType * mask = this->GetMaskImage()->GetBufferPointer();
+  OutputImagePixelType * output = this->GetOutput()->GetBufferPointer();
+
+  // the labels come in runs - only search a label when it changes
+  InputImagePixelType label = m_BackgroundValue;
+  bool marked = false;
+  for( unsigned long i=begin; i<end; i++ )
+    {
+    if( mask[i] != label )
+      {
+      label = mask[i];
+      marked = label != m_BackgroundValue && m_MarkedLabels.find( label ) != m_MarkedLabels.end();
+      }
+    output[i] = marked ? label : m_BackgroundValue;
+    }
+}
+
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+LabelReconstructionByDilationImageFilter<TInputImage>
+::ThreaderCallback( void * arg )
+{
+  int threadId = ((MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  int threadCount = ((MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+  Self * self = (Self *)(((MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  // split the buffer in contiguous parts of the same size - the mask, the marker
+  // and the output have the same buffered region
+  const unsigned long numberOfPixels = self->GetMaskImage()->GetBufferedRegion().GetNumberOfPixels();
+  const unsigned long begin = numberOfPixels * threadId / threadCount;
+  const unsigned long end = numberOfPixels * ( threadId + 1 ) / threadCount;
+  if( self->m_WriteOutput )
+    {
+    self->ThreadedWriteOutput( begin, end );
+    }
+  else
+    {
+    self->ThreadedFindMarkedLabels( begin, end, threadId );
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 
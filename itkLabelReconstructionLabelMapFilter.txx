@@ -27,7 +27,22 @@ template <class TImage, class TMarkerImage, class TAttributeAccessor>
 LabelReconstructionLabelMapFilter<TImage, TMarkerImage, TAttributeAccessor>
 ::LabelReconstructionLabelMapFilter()
 {
-  this->SetNumberOfRequiredInputs(2);
+  // the marker is either the second input, or the third one as a label map
+  this->SetNumberOfRequiredInputs(1);
+}
+
+
+template <class TImage, class TMarkerImage, class TAttributeAccessor>
+void
+LabelReconstructionLabelMapFilter<TImage, TMarkerImage, TAttributeAccessor>
+::BeforeThreadedGenerateData()
+{
+  if( this->GetMarkerLabelMap() == NULL && this->GetMarkerImage() == NULL )
+    {
+    itkExceptionMacro( << "A marker image or a marker label map is required." );
+    }
+
+  Superclass::BeforeThreadedGenerateData();
 }
 
 
@@ -38,6 +53,23 @@ LabelReconstructionLabelMapFilter<TImage, TMarkerImage, TAttributeAccessor>
 {
   AttributeAccessorType accessor;
 
+  MarkerLabelMapType * markerLabelMap = this->GetMarkerLabelMap();
+  if( markerLabelMap != NULL )
+    {
+    // compare the lines of the object to the ones of the marker object with the same
+    // label
+    bool keep = false;
+    if( markerLabelMap->HasLabel( labelObject->GetLabel() ) )
+      {
+      LabelMapUtilities::RunIntersectionTester< LabelObjectType > markerRuns;
+      markerRuns.AddLabelObject( markerLabelMap->GetLabelObject( labelObject->GetLabel() ) );
+      markerRuns.Initialize();
+      keep = markerRuns.Intersects( labelObject );
+      }
+    accessor( labelObject, keep );
+    return;
+    }
+
   const MarkerImageType * maskImage = this->GetMarkerImage();
   const PixelType & label = labelObject->GetLabel();
 
@@ -0,0 +1,313 @@
+/*=========================================================================
+
+  Program:   Insight Segmentation & Registration Toolkit
+  Module:    $RCSfile: itkPrincipalMomentsCalculator.h,v $
+  Language:  C++
+  Date:      $Date: 2005/08/23 15:09:03 $
+  Version:   $Revision: 1.6 $
+
+  Copyright (c) Insight Software Consortium. All rights reserved.
+  See ITKCopyright.txt or http://www.itk.org/HTML/Copyright.htm for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __itkPrincipalMomentsCalculator_h
+#define __itkPrincipalMomentsCalculator_h
+
+#include "itkMatrix.h"
+#include "itkVector.h"
+#include "vnl/algo/vnl_symmetric_eigensystem.h"
+#include "vnl/algo/vnl_determinant.h"
+#include <algorithm>
+#include <cmath>
+
+namespace itk {
+
+/** \class PrincipalMomentsCalculator
+ * \brief Compute the principal moments and axes of a symmetric matrix of second order moments
+ *
+ * The principal moments are the eigen values of the matrix, sorted in ascending
+ * order, and the principal axes are the matching eigen vectors, stored in the rows of
+ * the axes matrix. The axes are a proper rotation: the last axis is reversed if
+ * needed, so the determinant of the axes matrix is always 1.
+ *
+ * In 2D and 3D, the eigen system is solved in closed form, without any memory
+ * allocation. In the other dimensions, vnl_symmetric_eigensystem is used.
+ * The eigen values are the same as the ones found by vnl_symmetric_eigensystem, up to
+ * the rounding errors. The eigen vectors may only differ by their sign, and
+ * by the choice of a basis for the repeated eigen values.
+ *
+ * \author Gaetan Lehmann. Biologie du Developpement et de la Reproduction, INRA de Jouy-en-Josas, France.
+ *
+ * \sa ShapeLabelObjectAttributesEvaluator, StatisticsLabelMapFilter
+ */
+template< unsigned int VDimension >
+class PrincipalMomentsCalculator
+{
+public:
+  typedef Matrix< double, VDimension, VDimension > MatrixType;
+  typedef Vector< double, VDimension >             VectorType;
+
+  /** Compute the principal moments and axes of the matrix of moments */
+  static void Compute( const MatrixType & moments, VectorType & principalMoments, MatrixType & principalAxes )
+    {
+    vnl_symmetric_eigensystem<double> eigen( moments.GetVnlMatrix() );
+    for( unsigned int i=0; i<VDimension; i++ )
+      {
+      principalMoments[i] = eigen.D(i,i);
+      }
+    principalAxes = eigen.V.transpose();
+    MakeProperRotation( principalAxes, vnl_determinant( principalAxes.GetVnlMatrix() ) );
+    }
+
+  /** Reverse the last axis if the determinant of the axes is negative */
+  static void MakeProperRotation( MatrixType & principalAxes, double determinant )
+    {
+    if( determinant < 0 )
+      {
+      for( unsigned int i=0; i<VDimension; i++ )
+        {
+        principalAxes[ VDimension-1 ][i] = -principalAxes[ VDimension-1 ][i];
+        }
+      }
+    }
+};
+
+
+/** Closed form solution in 2D */
+template<>
+class PrincipalMomentsCalculator< 2 >
+{
+public:
+  typedef Matrix< double, 2, 2 > MatrixType;
+  typedef Vector< double, 2 >    VectorType;
+
+  static void Compute( const MatrixType & moments, VectorType & principalMoments, MatrixType & principalAxes )
+    {
+    const double a = moments[0][0];
+    const double b = ( moments[0][1] + moments[1][0] ) / 2.0;
+    const double c = moments[1][1];
+
+    // the eigen values
+    const double halfTrace = ( a + c ) / 2.0;
+    const double halfDiff = ( a - c ) / 2.0;
+    const double d = vcl_sqrt( halfDiff * halfDiff + b * b );
+    principalMoments[0] = halfTrace - d;
+    principalMoments[1] = halfTrace + d;
+
+    // the largest eigen value is in the direction theta, and the smallest one in
+    // the orthogonal direction. The axes built that way are a proper rotation.
+    const double theta = 0.5 * vcl_atan2( 2.0 * b, a - c );
+    const double cosTheta = vcl_cos( theta );
+    const double sinTheta = vcl_sin( theta );
+    principalAxes[0][0] = sinTheta;
+    principalAxes[0][1] = -cosTheta;
+    principalAxes[1][0] = cosTheta;
+    principalAxes[1][1] = sinTheta;
+    }
+};
+
+
+/** Closed form solution in 3D */
+template<>
+class PrincipalMomentsCalculator< 3 >
+{
+public:
+  typedef Matrix< double, 3, 3 > MatrixType;
+  typedef Vector< double, 3 >    VectorType;
+
+  static void Compute( const MatrixType & moments, VectorType & principalMoments, MatrixType & principalAxes )
+    {
+    // work on a symmetric copy
+    double m[3][3];
+    for( unsigned int i=0; i<3; i++ )
+      {
+      for( unsigned int j=0; j<3; j++ )
+        {
+        m[i][j] = ( moments[i][j] + moments[j][i] ) / 2.0;
+        }
+      }
+
+    // the eigen values, with the trigonometric solution of the characteristic
+    // polynomial
+    const double p1 = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+    const double q = ( m[0][0] + m[1][1] + m[2][2] ) / 3.0;
+    const double d0 = m[0][0] - q;
+    const double d1 = m[1][1] - q;
+    const double d2 = m[2][2] - q;
+    const double p2 = d0 * d0 + d1 * d1 + d2 * d2 + 2.0 * p1;
+    if( p2 == 0 )
+      {
+      // all the eigen values are the same - any basis is fine
+      principalMoments.Fill( q );
+      principalAxes.SetIdentity();
+      return;
+      }
+    const double p = vcl_sqrt( p2 / 6.0 );
+    // r = det( ( m - q I ) / p ) / 2
+    const double detB = d0 * ( d1 * d2 - m[1][2] * m[1][2] )
+      - m[0][1] * ( m[0][1] * d2 - m[1][2] * m[0][2] )
+      + m[0][2] * ( m[0][1] * m[1][2] - d1 * m[0][2] );
+    const double r = std::max( -1.0, std::min( detB / ( 2.0 * p * p * p ), 1.0 ) );
+    const double phi = vcl_acos( r ) / 3.0;
+    const double twoPiOverThree = 2.0943951023931954923;
+    const double largest = q + 2.0 * p * vcl_cos( phi );
+    const double smallest = q + 2.0 * p * vcl_cos( phi + twoPiOverThree );
+    const double middle = 3.0 * q - largest - smallest;
+
+    // the eigen vector of the most isolated eigen value is computed first. It is
+    // well defined even when the two other eigen values are the same.
+    double isolatedValue;
+    unsigned int isolatedRank;
+    if( middle - smallest > largest - middle )
+      {
+      isolatedValue = smallest;
+      isolatedRank = 0;
+      }
+    else
+      {
+      isolatedValue = largest;
+      isolatedRank = 2;
+      }
+    double u[3];
+    EigenVector( m, isolatedValue, u );
+
+    // the two other eigen vectors are found with the 2D solution, in the plane
+    // orthogonal to the first one
+    double e1[3];
+    double e2[3];
+    OrthogonalBasis( u, e1, e2 );
+    double me1[3];
+    double me2[3];
+    for( unsigned int i=0; i<3; i++ )
+      {
+      me1[i] = m[i][0] * e1[0] + m[i][1] * e1[1] + m[i][2] * e1[2];
+      me2[i] = m[i][0] * e2[0] + m[i][1] * e2[1] + m[i][2] * e2[2];
+      }
+    PrincipalMomentsCalculator< 2 >::MatrixType planeMoments;
+    planeMoments[0][0] = Dot( e1, me1 );
+    planeMoments[0][1] = Dot( e1, me2 );
+    planeMoments[1][0] = planeMoments[0][1];
+    planeMoments[1][1] = Dot( e2, me2 );
+    PrincipalMomentsCalculator< 2 >::VectorType planePrincipalMoments;
+    PrincipalMomentsCalculator< 2 >::MatrixType planePrincipalAxes;
+    PrincipalMomentsCalculator< 2 >::Compute( planeMoments, planePrincipalMoments, planePrincipalAxes );
+
+    // put everything in ascending order
+    unsigned int planeRank = ( isolatedRank == 0 ) ? 1 : 0;
+    principalMoments[isolatedRank] = isolatedValue;
+    for( unsigned int i=0; i<3; i++ )
+      {
+      principalAxes[isolatedRank][i] = u[i];
+      }
+    for( unsigned int k=0; k<2; k++ )
+      {
+      principalMoments[planeRank+k] = planePrincipalMoments[k];
+      for( unsigned int i=0; i<3; i++ )
+        {
+        principalAxes[planeRank+k][i] = planePrincipalAxes[k][0] * e1[i] + planePrincipalAxes[k][1] * e2[i];
+        }
+      }
+
+    // make it a proper rotation
+    const double det = principalAxes[0][0] * ( principalAxes[1][1] * principalAxes[2][2] - principalAxes[1][2] * principalAxes[2][1] )
+      - principalAxes[0][1] * ( principalAxes[1][0] * principalAxes[2][2] - principalAxes[1][2] * principalAxes[2][0] )
+      + principalAxes[0][2] * ( principalAxes[1][0] * principalAxes[2][1] - principalAxes[1][1] * principalAxes[2][0] );
+    if( det < 0 )
+      {
+      for( unsigned int i=0; i<3; i++ )
+        {
+        principalAxes[2][i] = -principalAxes[2][i];
+        }
+      }
+    }
+
+private:
+  static double Dot( const double * a, const double * b )
+    {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+  static void Cross( const double * a, const double * b, double * c )
+    {
+    c[0] = a[1] * b[2] - a[2] * b[1];
+    c[1] = a[2] * b[0] - a[0] * b[2];
+    c[2] = a[0] * b[1] - a[1] * b[0];
+    }
+
+  /** The eigen vector of a simple eigen value is orthogonal to the rows of m - lambda I:
+   * it is the largest cross product of two of those rows */
+  static void EigenVector( const double m[3][3], double lambda, double * v )
+    {
+    double rows[3][3];
+    for( unsigned int i=0; i<3; i++ )
+      {
+      for( unsigned int j=0; j<3; j++ )
+        {
+        rows[i][j] = m[i][j];
+        }
+      rows[i][i] -= lambda;
+      }
+    double c[3][3];
+    Cross( rows[0], rows[1], c[0] );
+    Cross( rows[0], rows[2], c[1] );
+    Cross( rows[1], rows[2], c[2] );
+    unsigned int best = 0;
+    double bestNorm2 = Dot( c[0], c[0] );
+    for( unsigned int i=1; i<3; i++ )
+      {
+      double n2 = Dot( c[i], c[i] );
+      if( n2 > bestNorm2 )
+        {
+        best = i;
+        bestNorm2 = n2;
+        }
+      }
+    if( bestNorm2 == 0 )
+      {
+      // m - lambda I has a rank lower than 2 - any vector is an eigen vector
+      v[0] = 1;
+      v[1] = 0;
+      v[2] = 0;
+      return;
+      }
+    const double norm = vcl_sqrt( bestNorm2 );
+    for( unsigned int i=0; i<3; i++ )
+      {
+      v[i] = c[best][i] / norm;
+      }
+    }
+
+  /** Build two unit vectors e1 and e2 such as ( u, e1, e2 ) is an orthonormal basis */
+  static void OrthogonalBasis( const double * u, double * e1, double * e2 )
+    {
+    // use the axis the less aligned with u to build e1
+    double a[3] = { 0, 0, 0 };
+    if( vcl_abs( u[0] ) <= vcl_abs( u[1] ) && vcl_abs( u[0] ) <= vcl_abs( u[2] ) )
+      {
+      a[0] = 1;
+      }
+    else if( vcl_abs( u[1] ) <= vcl_abs( u[2] ) )
+      {
+      a[1] = 1;
+      }
+    else
+      {
+      a[2] = 1;
+      }
+    Cross( u, a, e1 );
+    const double norm = vcl_sqrt( Dot( e1, e1 ) );
+    for( unsigned int i=0; i<3; i++ )
+      {
+      e1[i] /= norm;
+      }
+    Cross( u, e1, e2 );
+    }
+};
+
+} // end namespace itk
+
+#endif
@@ -19,6 +19,9 @@
 
 #include "itkInPlaceLabelMapFilter.h"
 #include "itkStatisticsLabelObjectAccessors.h"
+#include "itkFeatureRangeImageCalculator.h"
+#include <utility>
+#include <vector>
 
 namespace itk {
 /** \class WeightedHistogramLabelMapFilter
@@ -67,6 +70,7 @@ public:
   typedef typename WeightImageType::PixelType       WeightImagePixelType;
   
   typedef THistogramAccessor                        HistogramAccessorType;
+  typedef typename LabelObjectType::HistogramType   HistogramType;
 
   /** ImageDimension constants */
   itkStaticConstMacro(ImageDimension, unsigned int,
@@ -142,6 +146,82 @@ public:
   itkSetMacro(NumberOfBins, unsigned int);
   itkGetConstReferenceMacro(NumberOfBins, unsigned int);
 
+  /**
+   * Set/Get whether the range of the histograms is the range of the values in the
+   * feature image. The range of the feature image is computed in parallel, and only
+   * when the feature image is modified. When this option is off, the range given
+   * with SetFeatureMinimum() and SetFeatureMaximum() is used instead, and the
+   * feature image is not read to find its range. The values out of the range go in
+   * the bins at the ends of the histograms. This option defaults to `true`.
+   */
+  itkSetMacro(ComputeFeatureRange, bool);
+  itkGetConstReferenceMacro(ComputeFeatureRange, bool);
+  itkBooleanMacro(ComputeFeatureRange);
+
+  /**
+   * Set/Get the range of the histograms, used when ComputeFeatureRange is off.
+   * The default is the full range of the pixel type. It must be set for the real
+   * pixel types, for which that range can't be divided in bins.
+   */
+  itkSetMacro(FeatureMinimum, FeatureImagePixelType);
+  itkGetConstReferenceMacro(FeatureMinimum, FeatureImagePixelType);
+  itkSetMacro(FeatureMaximum, FeatureImagePixelType);
+  itkGetConstReferenceMacro(FeatureMaximum, FeatureImagePixelType);
+
+  /**
+   * Set/Get whether the histograms are sparse. A sparse histogram only has bins for
+   * the values found in its object: one bin per distinct value when the object
+   * has at most NumberOfBins distinct values, or else NumberOfBins bins with the same
+   * number of consecutive distinct values. A bin goes from its first value to its
+   * last value - or to the next integer with the integer features - so the bins are
+   * not uniform, the histogram has no empty bin, and its size is bounded by the
+   * number of distinct values of the object instead of the range of the feature
+   * image. The distinct values are counted in an array indexed by value when their
+   * range is not larger than the object, and sorted otherwise. The range of the
+   * feature image is not computed in that mode.
+   * This option defaults to `false`.
+   */
+  itkSetMacro(SparseHistogram, bool);
+  itkGetConstReferenceMacro(SparseHistogram, bool);
+  itkBooleanMacro(SparseHistogram);
+
+  /**
+   * Set/Get whether the weighted median of the feature values is computed and
+   * stored as the median of the label object. The weighted median is exact: it is
+   * computed from the values of the pixels, not from the histogram. It is also
+   * computed when some quantiles are given.
+   * This option defaults to `false`.
+   */
+  itkSetMacro(ComputeWeightedMedian, bool);
+  itkGetConstReferenceMacro(ComputeWeightedMedian, bool);
+  itkBooleanMacro(ComputeWeightedMedian);
+
+  typedef typename LabelObjectType::QuantilesType QuantilesType;
+
+  /**
+   * Set/Get the probabilities, in the range [0, 1], of the weighted quantiles stored
+   * in the label objects with their median. The quantiles are exact, like the
+   * weighted median. The default is to compute no quantile.
+   */
+  itkSetMacro(Quantiles, QuantilesType);
+  itkGetConstReferenceMacro(Quantiles, QuantilesType);
+
+  /** A feature value and its weight */
+  typedef std::pair< FeatureImagePixelType, double > WeightedValueType;
+  typedef std::vector< WeightedValueType >            WeightedValuesType;
+
+  /**
+   * Sort the weighted values and merge the weights of the equal values.
+   */
+  static void SortWeightedValues( WeightedValuesType & values );
+
+  /**
+   * Compute the weighted quantiles of the given probabilities in the sorted weighted
+   * values. The quantile of probability p is the smallest value such as the sum of
+   * the weights of the lower or equal values is at least p times the total weight.
+   */
+  static void ComputeWeightedQuantiles( const WeightedValuesType & values, const QuantilesType & probabilities, QuantilesType & quantiles );
+
 
 protected:
   WeightedHistogramLabelMapFilter();
@@ -150,6 +230,9 @@ protected:
   virtual void ThreadedProcessLabelObject( LabelObjectType * labelObject );
   
   virtual void BeforeThreadedGenerateData();
+
+  /** Put the distinct values of the object, sorted, and their weights in values */
+  void GetSortedWeightedValues( const LabelObjectType * labelObject, WeightedValuesType & values ) const;
   
   void PrintSelf(std::ostream& os, Indent indent) const;
 
@@ -160,6 +243,17 @@ private:
   FeatureImagePixelType m_Minimum;
   FeatureImagePixelType m_Maximum;
   unsigned int          m_NumberOfBins;
+  bool                  m_ComputeFeatureRange;
+  FeatureImagePixelType m_FeatureMinimum;
+  FeatureImagePixelType m_FeatureMaximum;
+  bool                  m_SparseHistogram;
+  bool                  m_ComputeWeightedMedian;
+  QuantilesType         m_Quantiles;
+
+  // kept between the updates, to compute the range of the feature image only
+  // when it is modified
+  typedef FeatureRangeImageCalculator< FeatureImageType > FeatureRangeCalculatorType;
+  typename FeatureRangeCalculatorType::Pointer m_FeatureRangeCalculator;
 
 }; // end of class
 
@@ -18,10 +18,10 @@
 #define __itkWeightedHistogramLabelMapFilter_txx
 
 #include "itkWeightedHistogramLabelMapFilter.h"
-#include "itkMinimumMaximumImageCalculator.h"
 #include "itkProgressReporter.h"
 #include "vnl/algo/vnl_real_eigensystem.h"
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
+#include <algorithm>
 
 
 namespace itk {
@@ -31,6 +31,12 @@ WeightedHistogramLabelMapFilter<TImage, TFeatureImage, TWeightImage, THistogramA
 ::WeightedHistogramLabelMapFilter()
 {
   m_NumberOfBins = 128;
+  m_ComputeFeatureRange = true;
+  m_FeatureMinimum = NumericTraits< FeatureImagePixelType >::NonpositiveMin();
+  m_FeatureMaximum = NumericTraits< FeatureImagePixelType >::max();
+  m_FeatureRangeCalculator = FeatureRangeCalculatorType::New();
+  m_SparseHistogram = false;
+  m_ComputeWeightedMedian = false;
   this->SetNumberOfRequiredInputs(3);
 }
 
@@ -42,16 +48,40 @@ WeightedHistogramLabelMapFilter<TImage, TFeatureImage, TWeightImage, THistogramA
 {
   Superclass::BeforeThreadedGenerateData();
 
-  // get the min and max of the feature image, to use those value as the bounds of our
-  // histograms
-  typedef MinimumMaximumImageCalculator< FeatureImageType > MinMaxCalculatorType;
-  typename MinMaxCalculatorType::Pointer minMax = MinMaxCalculatorType::New();
-  minMax->SetImage( this->GetFeatureImage() );
-  minMax->Compute();
-
-  m_Minimum = minMax->GetMinimum();
-  m_Maximum = minMax->GetMaximum();
+  // the sparse histograms use the range of the values of their object
+  if( m_SparseHistogram )
+    {
+    return;
+    }
 
+  // get the min and max of the feature image, to use those value as the bounds of our
+  // histograms. The range is only computed again if the feature image has been
+  // modified since the last update.
+  if( m_ComputeFeatureRange )
+    {
+    m_FeatureRangeCalculator->SetImage( this->GetFeatureImage() );
+    m_FeatureRangeCalculator->SetNumberOfThreads( this->GetNumberOfThreads() );
+    m_FeatureRangeCalculator->Compute();
+    m_Minimum = m_FeatureRangeCalculator->GetMinimum();
+    m_Maximum = m_FeatureRangeCalculator->GetMaximum();
+    }
+  else
+    {
+    if( m_FeatureMinimum > m_FeatureMaximum )
+      {
+      itkExceptionMacro( << "The feature minimum must be lower than the feature maximum." );
+      }
+    // the default range is the full range of the pixel type, which can't be
+    // divided in bins for the real types
+    if( !NumericTraits< FeatureImagePixelType >::is_integer
+      && m_FeatureMinimum == NumericTraits< FeatureImagePixelType >::NonpositiveMin()
+      && m_FeatureMaximum == NumericTraits< FeatureImagePixelType >::max() )
+      {
+      itkExceptionMacro( << "The feature minimum and maximum must be set when ComputeFeatureRange is off." );
+      }
+    m_Minimum = m_FeatureMinimum;
+    m_Maximum = m_FeatureMaximum;
+    }
 }
 
 
@@ -65,56 +95,274 @@ WeightedHistogramLabelMapFilter<TImage, TFeatureImage, TWeightImage, THistogramA
   const FeatureImageType * featureImage = this->GetFeatureImage();
   const WeightImageType * weightImage = this->GetWeightImage();
 
-  typedef typename LabelObjectType::HistogramType HistogramType;
+  // the lines are read directly in the buffers of the feature and weight images
+  const FeatureImagePixelType * featureBuffer = featureImage->GetBufferPointer();
+  const WeightImagePixelType * weightBuffer = weightImage->GetBufferPointer();
+
+  typename LabelObjectType::LineContainerType::const_iterator lit;
+  typename LabelObjectType::LineContainerType & lineContainer = labelObject->GetLineContainer();
+
+  typename HistogramType::MeasurementVectorType mv;
+#ifdef ITK_USE_REVIEW_STATISTICS
+  mv.SetSize(1);
+#endif
 
   typename HistogramType::SizeType histogramSize;
 #ifdef ITK_USE_REVIEW_STATISTICS
   histogramSize.SetSize(1);
 #endif
-  histogramSize.Fill( m_NumberOfBins );
 
   typename HistogramType::MeasurementVectorType featureImageMin;
 #ifdef ITK_USE_REVIEW_STATISTICS
   featureImageMin.SetSize(1);
 #endif
-  featureImageMin.Fill( m_Minimum );
 
   typename HistogramType::MeasurementVectorType featureImageMax;
 #ifdef ITK_USE_REVIEW_STATISTICS
   featureImageMax.SetSize(1);
 #endif
-  featureImageMax.Fill( m_Maximum );
 
   typename HistogramType::Pointer histogram = HistogramType::New();
 #ifdef ITK_USE_REVIEW_STATISTICS
   histogram->SetMeasurementVectorSize(1);
 #endif
   histogram->SetClipBinsAtEnds( false );
-  histogram->Initialize( histogramSize, featureImageMin, featureImageMax );
 
+  // the weighted values are needed for the sparse histograms, the weighted median
+  // and the weighted quantiles
+  const bool computeQuantiles = m_ComputeWeightedMedian || !m_Quantiles.empty();
+  WeightedValuesType values;
+
+  if( !m_SparseHistogram )
+    {
+    // the dense histograms cover the range of the feature image
+    histogramSize.Fill( m_NumberOfBins );
+    featureImageMin.Fill( m_Minimum );
+    featureImageMax.Fill( m_Maximum );
+    histogram->Initialize( histogramSize, featureImageMin, featureImageMax );
+
+    for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+      {
+      const IndexType & firstIdx = lit->GetIndex();
+      const long length = lit->GetLength();
+      const FeatureImagePixelType * f = featureBuffer + featureImage->ComputeOffset( firstIdx );
+      const WeightImagePixelType * w = weightBuffer + weightImage->ComputeOffset( firstIdx );
+
+      for( long i=0; i<length; i++ )
+        {
+        mv[0] = f[i];
+        histogram->IncreaseFrequencyOfMeasurement( mv, w[i] );
+        }
+      if( computeQuantiles )
+        {
+        for( long i=0; i<length; i++ )
+          {
+          values.push_back( WeightedValueType( f[i], w[i] ) );
+          }
+        }
+      }
+    if( computeQuantiles )
+      {
+      SortWeightedValues( values );
+      }
+    }
+  else
+    {
+    // the sparse histograms only have bins for the values found in the object.
+    // The distinct values and their weights are found first, sorted.
+    this->GetSortedWeightedValues( labelObject, values );
+
+    // one bin per distinct value if there are not more than NumberOfBins of them,
+    // or else the same number of consecutive distinct values in each bin. A bin goes
+    // from its first value to its last value - or to the next integer with the integer
+    // features. The bins are not uniform and there is no empty bin.
+    const unsigned long numberOfValues = values.size();
+    const unsigned long numberOfBins = std::max( 1UL, std::min( (unsigned long)m_NumberOfBins, numberOfValues ) );
+    histogramSize.Fill( numberOfBins );
+    histogram->Initialize( histogramSize );
+    for( unsigned long b=0; b<numberOfBins; b++ )
+      {
+      const unsigned long first = b * numberOfValues / numberOfBins;
+      const unsigned long last = ( b + 1 ) * numberOfValues / numberOfBins;
+      double lower = 0;
+      double upper = 1;
+      double frequency = 0;
+      if( first < last )
+        {
+        lower = values[first].first;
+        upper = values[last - 1].first;
+        if( NumericTraits< FeatureImagePixelType >::is_integer )
+          {
+          upper += 1;
+          }
+        for( unsigned long i=first; i<last; i++ )
+          {
+          frequency += values[i].second;
+          }
+        }
+      histogram->SetBinMin( 0, b, lower );
+      histogram->SetBinMax( 0, b, upper );
+      histogram->IncreaseFrequency( b, frequency );
+      }
+    }
+
+  labelObject->SetHistogram( histogram );
+
+  // the weighted median and quantiles are exact: they are computed from the
+  // sorted weighted values, not from the bins
+  if( computeQuantiles )
+    {
+    QuantilesType probabilities = m_Quantiles;
+    probabilities.push_back( 0.5 );
+    QuantilesType quantiles;
+    ComputeWeightedQuantiles( values, probabilities, quantiles );
+    labelObject->SetMedian( quantiles.back() );
+    quantiles.pop_back();
+    labelObject->SetQuantiles( m_Quantiles, quantiles );
+    }
+}
+
+
+template <class TImage, class TFeatureImage, class TWeightImage, class THistogramAccessor>
+void
+WeightedHistogramLabelMapFilter<TImage, TFeatureImage, TWeightImage, THistogramAccessor>
+::GetSortedWeightedValues( const LabelObjectType * labelObject, WeightedValuesType & values ) const
+{
+  const FeatureImageType * featureImage = this->GetFeatureImage();
+  const WeightImageType * weightImage = this->GetWeightImage();
+  const FeatureImagePixelType * featureBuffer = featureImage->GetBufferPointer();
+  const WeightImagePixelType * weightBuffer = weightImage->GetBufferPointer();
+  const typename LabelObjectType::LineContainerType & lineContainer = labelObject->GetLineContainer();
   typename LabelObjectType::LineContainerType::const_iterator lit;
-  typename LabelObjectType::LineContainerType & lineContainer = labelObject->GetLineContainer();
 
-  // iterate over all the lines
+  // find the range and the size of the object
+  FeatureImagePixelType min = NumericTraits< FeatureImagePixelType >::max();
+  FeatureImagePixelType max = NumericTraits< FeatureImagePixelType >::NonpositiveMin();
+  unsigned long size = 0;
   for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
     {
-    const IndexType & firstIdx = lit->GetIndex();
-    unsigned long length = lit->GetLength();
+    const long length = lit->GetLength();
+    const FeatureImagePixelType * f = featureBuffer + featureImage->ComputeOffset( lit->GetIndex() );
+    for( long i=0; i<length; i++ )
+      {
+      min = std::min( min, f[i] );
+      max = std::max( max, f[i] );
+      }
+    size += length;
+    }
 
-    typename HistogramType::MeasurementVectorType mv;
-#ifdef ITK_USE_REVIEW_STATISTICS
-    mv.SetSize(1);
-#endif
-    long endIdx0 = firstIdx[0] + length;
-    for( IndexType idx = firstIdx; idx[0]<endIdx0; idx[0]++)
+  values.clear();
+  if( size == 0 )
+    {
+    return;
+    }
+
+  if( NumericTraits< FeatureImagePixelType >::is_integer
+    && (double)max - (double)min < (double)size )
+    {
+    // the range of the integer values is not larger than the object: count the
+    // values in an array indexed by value, without sorting them
+    const unsigned long range = (unsigned long)( (double)max - (double)min ) + 1;
+    std::vector< double > weights( range, 0.0 );
+    std::vector< bool > found( range, false );
+    for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+      {
+      const IndexType & firstIdx = lit->GetIndex();
+      const long length = lit->GetLength();
+      const FeatureImagePixelType * f = featureBuffer + featureImage->ComputeOffset( firstIdx );
+      const WeightImagePixelType * w = weightBuffer + weightImage->ComputeOffset( firstIdx );
+      for( long i=0; i<length; i++ )
+        {
+        const unsigned long v = (unsigned long)( (double)f[i] - (double)min );
+        weights[v] += w[i];
+        found[v] = true;
+        }
+      }
+    for( unsigned long v=0; v<range; v++ )
       {
-      const FeatureImagePixelType & v = featureImage->GetPixel( idx );
-      const WeightImagePixelType & w = weightImage->GetPixel( idx );
-      mv[0] = v;
-      histogram->IncreaseFrequencyOfMeasurement( mv, w );
+      if( found[v] )
+        {
+        values.push_back( WeightedValueType( static_cast< FeatureImagePixelType >( min + v ), weights[v] ) );
+        }
       }
     }
-  labelObject->SetHistogram( histogram );
+  else
+    {
+    values.reserve( size );
+    for( lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+      {
+      const IndexType & firstIdx = lit->GetIndex();
+      const long length = lit->GetLength();
+      const FeatureImagePixelType * f = featureBuffer + featureImage->ComputeOffset( firstIdx );
+      const WeightImagePixelType * w = weightBuffer + weightImage->ComputeOffset( firstIdx );
+      for( long i=0; i<length; i++ )
+        {
+        values.push_back( WeightedValueType( f[i], w[i] ) );
+        }
+      }
+    SortWeightedValues( values );
+    }
+}
+
+
+template <class TImage, class TFeatureImage, class TWeightImage, class THistogramAccessor>
+void
+WeightedHistogramLabelMapFilter<TImage, TFeatureImage, TWeightImage, THistogramAccessor>
+::SortWeightedValues( WeightedValuesType & values )
+{
+  std::sort( values.begin(), values.end() );
+
+  // merge the weights of the equal values
+  typename WeightedValuesType::iterator out = values.begin();
+  for( typename WeightedValuesType::const_iterator it = values.begin(); it != values.end(); it++ )
+    {
+    if( out != values.begin() && ( out - 1 )->first == it->first )
+      {
+      ( out - 1 )->second += it->second;
+      }
+    else
+      {
+      *out = *it;
+      out++;
+      }
+    }
+  values.erase( out, values.end() );
+}
+
+
+template <class TImage, class TFeatureImage, class TWeightImage, class THistogramAccessor>
+void
+WeightedHistogramLabelMapFilter<TImage, TFeatureImage, TWeightImage, THistogramAccessor>
+::ComputeWeightedQuantiles( const WeightedValuesType & values, const QuantilesType & probabilities, QuantilesType & quantiles )
+{
+  quantiles.clear();
+  quantiles.resize( probabilities.size(), 0.0 );
+  if( values.empty() )
+    {
+    return;
+    }
+
+  // the cumulated weights
+  std::vector< double > cumulatedWeights( values.size() );
+  double total = 0;
+  for( unsigned long i=0; i<values.size(); i++ )
+    {
+    total += values[i].second;
+    cumulatedWeights[i] = total;
+    }
+
+  for( unsigned int i=0; i<probabilities.size(); i++ )
+    {
+    const double target = std::max( 0.0, std::min( probabilities[i], 1.0 ) ) * total;
+    // skip the values without weight at the beginning
+    unsigned long j = std::lower_bound( cumulatedWeights.begin(), cumulatedWeights.end(), target ) - cumulatedWeights.begin();
+    while( j < values.size() - 1 && cumulatedWeights[j] <= 0 )
+      {
+      j++;
+      }
+    j = std::min( j, (unsigned long)values.size() - 1 );
+    quantiles[i] = values[j].first;
+    }
 }
 
 
@@ -126,6 +374,19 @@ WeightedHistogramLabelMapFilter<TImage, TFeatureImage, TWeightImage, THistogramA
   Superclass::PrintSelf(os,indent);
   
   os << indent << "NumberOfBins: " << m_NumberOfBins << std::endl;
+  os << indent << "ComputeFeatureRange: " << m_ComputeFeatureRange << std::endl;
+  os << indent << "FeatureMinimum: "
+     << static_cast<typename NumericTraits<FeatureImagePixelType>::PrintType>(m_FeatureMinimum) << std::endl;
+  os << indent << "FeatureMaximum: "
+     << static_cast<typename NumericTraits<FeatureImagePixelType>::PrintType>(m_FeatureMaximum) << std::endl;
+  os << indent << "SparseHistogram: " << m_SparseHistogram << std::endl;
+  os << indent << "ComputeWeightedMedian: " << m_ComputeWeightedMedian << std::endl;
+  os << indent << "Quantiles:";
+  for( unsigned int i=0; i<m_Quantiles.size(); i++ )
+    {
+    os << " " << m_Quantiles[i];
+    }
+  os << std::endl;
 }
 
 
@@ -0,0 +1,105 @@
+#include "itkImageFileReader.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkAttributeLabelObject.h"
+#include "itkLabelMap.h"
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkLabelReconstructionLabelMapFilter.h"
+
+
+int main(int argc, char * argv[])
+{
+
+  if( argc != 3 )
+    {
+    std::cerr << "usage: " << argv[0] << " label bg" << std::endl;
+    // std::cerr << "  : " << std::endl;
+    exit(1);
+    }
+
+  const int dim = 2;
+  typedef unsigned char PType;
+  typedef itk::Image< PType, dim > IType;
+
+  typedef itk::AttributeLabelObject< unsigned long, dim, bool > LabelObjectType;
+  typedef itk::LabelMap< LabelObjectType > LabelMapType;
+
+  typedef itk::ImageFileReader< IType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  reader->Update();
+
+  // the marker: the objects of the label image, in the left half of the image only
+  IType::Pointer marker = IType::New();
+  marker->CopyInformation( reader->GetOutput() );
+  marker->SetRegions( reader->GetOutput()->GetLargestPossibleRegion() );
+  marker->Allocate();
+  const long half = reader->GetOutput()->GetLargestPossibleRegion().GetSize()[0] / 2;
+  itk::ImageRegionIteratorWithIndex< IType > mit( marker, marker->GetLargestPossibleRegion() );
+  for( mit.GoToBegin(); !mit.IsAtEnd(); ++mit )
+    {
+    const PType v = reader->GetOutput()->GetPixel( mit.GetIndex() );
+    mit.Set( mit.GetIndex()[0] < half ? v : atoi(argv[2]) );
+    }
+
+  typedef itk::LabelImageToLabelMapFilter< IType, LabelMapType > I2LType;
+  I2LType::Pointer i2l = I2LType::New();
+  i2l->SetInput( reader->GetOutput() );
+  i2l->SetBackgroundValue( atoi(argv[2]) );
+  i2l->Update();
+
+  I2LType::Pointer i2l2 = I2LType::New();
+  i2l2->SetInput( reader->GetOutput() );
+  i2l2->SetBackgroundValue( atoi(argv[2]) );
+  i2l2->Update();
+
+  I2LType::Pointer markerI2L = I2LType::New();
+  markerI2L->SetInput( marker );
+  markerI2L->SetBackgroundValue( atoi(argv[2]) );
+  markerI2L->Update();
+
+  // the marker as a label map
+  typedef itk::LabelReconstructionLabelMapFilter< LabelMapType, IType > ReconstructionType;
+  ReconstructionType::Pointer reconstruction = ReconstructionType::New();
+  reconstruction->SetInput( i2l->GetOutput() );
+  reconstruction->SetMarkerLabelMap( markerI2L->GetOutput() );
+  itk::SimpleFilterWatcher watcher(reconstruction, "filter");
+  reconstruction->Update();
+
+  // the marker as an image
+  ReconstructionType::Pointer reconstruction2 = ReconstructionType::New();
+  reconstruction2->SetInput( i2l2->GetOutput() );
+  reconstruction2->SetMarkerImage( marker );
+  reconstruction2->Update();
+
+  // an object is reconstructed if it has a pixel in the left half of the image
+  int errors = 0;
+  const LabelMapType::LabelObjectContainerType & labelObjectContainer = reconstruction->GetOutput()->GetLabelObjectContainer();
+  for( LabelMapType::LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+    it != labelObjectContainer.end();
+    it++ )
+    {
+    const LabelObjectType * labelObject = it->second;
+    bool expected = false;
+    const LabelObjectType::LineContainerType & lineContainer = labelObject->GetLineContainer();
+    for( LabelObjectType::LineContainerType::const_iterator lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+      {
+      expected = expected || lit->GetIndex()[0] < half;
+      }
+    const bool fromImage = reconstruction2->GetOutput()->GetLabelObject( it->first )->GetAttribute();
+    if( labelObject->GetAttribute() != expected || fromImage != expected )
+      {
+      std::cerr << "label " << (int)it->first << ": expected " << expected
+                << ", got " << labelObject->GetAttribute() << " with the marker label map and "
+                << fromImage << " with the marker image" << std::endl;
+      errors++;
+      }
+    }
+
+  if( errors != 0 )
+    {
+    return 1;
+    }
+  return 0;
+}
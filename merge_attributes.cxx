@@ -0,0 +1,237 @@
+#include "itkImageFileReader.h"
+#include "itkSimpleFilterWatcher.h"
+#include "itkLabelMap.h"
+#include "itkStatisticsLabelObject.h"
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkStatisticsLabelMapFilter.h"
+#include "itkChangeLabelLabelMapFilter.h"
+#include "itkMergeLabelMapFilter.h"
+#include "itkLabelMapToLabelImageFilter.h"
+#include <map>
+
+const int dim = 2;
+typedef unsigned char PixelType;
+typedef itk::Image< PixelType, dim > ImageType;
+typedef itk::StatisticsLabelObject< PixelType, dim > LabelObjectType;
+typedef itk::LabelMap< LabelObjectType > LabelMapType;
+typedef itk::StatisticsLabelMapFilter< LabelMapType, ImageType > ValuatorType;
+
+bool check( const char * name, unsigned long label, double value, double expected )
+{
+  if( vnl_math_abs( value - expected ) > 1e-6 * std::max( 1.0, vnl_math_abs( expected ) ) )
+    {
+    std::cerr << "label " << label << ": " << name << " is " << value
+              << " instead of " << expected << std::endl;
+    return false;
+    }
+  return true;
+}
+
+bool checkThrow( const char * name, unsigned long label, bool thrown )
+{
+  if( !thrown )
+    {
+    std::cerr << "label " << label << ": " << name << " should not be available" << std::endl;
+    }
+  return thrown;
+}
+
+ValuatorType::Pointer Valuate( const LabelMapType * labelMap, const ImageType * feature, bool reuse )
+{
+  ValuatorType::Pointer valuator = ValuatorType::New();
+  valuator->SetInput( labelMap );
+  valuator->SetFeatureImage( feature );
+  valuator->SetInPlace( false );
+  valuator->SetComputePerimeter( true );
+  valuator->SetComputeHistogram( true );
+  valuator->SetComputeMedian( true );
+  valuator->SetReuseEvaluatedAttributes( reuse );
+  valuator->Update();
+  return valuator;
+}
+
+// compare the attributes of lo with the ones of ref, computed from scratch. The
+// statistics which can't be merged are only compared if all is true.
+bool Compare( const LabelObjectType * lo, const LabelObjectType * ref, bool all )
+{
+  const unsigned long label = ref->GetLabel();
+  bool ok = true;
+
+  // the shape attributes
+  ok = check( "size", label, lo->GetSize(), ref->GetSize() ) && ok;
+  ok = check( "physical size", label, lo->GetPhysicalSize(), ref->GetPhysicalSize() ) && ok;
+  for( unsigned int i=0; i<dim; i++ )
+    {
+    ok = check( "centroid", label, lo->GetCentroid()[i], ref->GetCentroid()[i] ) && ok;
+    ok = check( "region index", label, lo->GetRegion().GetIndex()[i], ref->GetRegion().GetIndex()[i] ) && ok;
+    ok = check( "region size", label, lo->GetRegion().GetSize()[i], ref->GetRegion().GetSize()[i] ) && ok;
+    }
+  ok = check( "perimeter", label, lo->GetPerimeter(), ref->GetPerimeter() ) && ok;
+
+  // the intensity attributes and the histogram are merged
+  ok = check( "minimum", label, lo->GetMinimum(), ref->GetMinimum() ) && ok;
+  ok = check( "maximum", label, lo->GetMaximum(), ref->GetMaximum() ) && ok;
+  ok = check( "sum", label, lo->GetSum(), ref->GetSum() ) && ok;
+  ok = check( "mean", label, lo->GetMean(), ref->GetMean() ) && ok;
+  ok = check( "variance", label, lo->GetVariance(), ref->GetVariance() ) && ok;
+  ok = check( "sigma", label, lo->GetSigma(), ref->GetSigma() ) && ok;
+  // several pixels may have the extreme values - only check that the index is
+  // in the object and has the right value
+  ok = check( "object at minimum index", label, lo->HasIndex( lo->GetMinimumIndex() ), true ) && ok;
+  ok = check( "object at maximum index", label, lo->HasIndex( lo->GetMaximumIndex() ), true ) && ok;
+  if( lo->GetHistogram() == NULL || ref->GetHistogram() == NULL )
+    {
+    std::cerr << "label " << label << ": no histogram" << std::endl;
+    ok = false;
+    }
+  else
+    {
+    ok = check( "number of bins", label, lo->GetHistogram()->Size(), ref->GetHistogram()->Size() ) && ok;
+    for( unsigned long b=0; b<ref->GetHistogram()->Size(); b++ )
+      {
+      ok = check( "histogram count", label, lo->GetHistogramCount( b ), ref->GetHistogramCount( b ) ) && ok;
+      }
+    }
+
+  if( all )
+    {
+    ok = check( "median", label, lo->GetMedian(), ref->GetMedian() ) && ok;
+    ok = check( "skewness", label, lo->GetSkewness(), ref->GetSkewness() ) && ok;
+    ok = check( "kurtosis", label, lo->GetKurtosis(), ref->GetKurtosis() ) && ok;
+    ok = check( "elongation", label, lo->GetElongation(), ref->GetElongation() ) && ok;
+    for( unsigned int i=0; i<dim; i++ )
+      {
+      ok = check( "center of gravity", label, lo->GetCenterOfGravity()[i], ref->GetCenterOfGravity()[i] ) && ok;
+      ok = check( "principal moments", label, lo->GetPrincipalMoments()[i], ref->GetPrincipalMoments()[i] ) && ok;
+      }
+    }
+  return ok;
+}
+
+// the statistics which can't be merged must not be readable
+bool CheckInvalidated( const LabelObjectType * lo )
+{
+  const unsigned long label = lo->GetLabel();
+  bool ok = true;
+  bool thrown = false;
+  try { lo->GetSkewness(); } catch( itk::ExceptionObject & ) { thrown = true; }
+  ok = checkThrow( "skewness", label, thrown ) && ok;
+  thrown = false;
+  try { lo->GetMedian(); } catch( itk::ExceptionObject & ) { thrown = true; }
+  ok = checkThrow( "median", label, thrown ) && ok;
+  thrown = false;
+  try { lo->GetCenterOfGravity(); } catch( itk::ExceptionObject & ) { thrown = true; }
+  ok = checkThrow( "center of gravity", label, thrown ) && ok;
+  return ok;
+}
+
+int main(int argc, char * argv[])
+{
+  if( argc != 3 )
+    {
+    std::cerr << "usage: " << argv[0] << " labelImage featureImg" << std::endl;
+    // std::cerr << "  : " << std::endl;
+    exit(1);
+    }
+
+  // read the input images
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  ReaderType::Pointer reader2 = ReaderType::New();
+  reader2->SetFileName( argv[2] );
+  reader2->Update();
+  const ImageType * feature = reader2->GetOutput();
+
+  // convert the image in a collection of objects and valuate them
+  typedef itk::LabelImageToLabelMapFilter< ImageType, LabelMapType > ConverterType;
+  ConverterType::Pointer converter = ConverterType::New();
+  converter->SetInput( reader->GetOutput() );
+  converter->SetBackgroundValue( 0 );
+  converter->Update();
+  ValuatorType::Pointer valuator = Valuate( converter->GetOutput(), feature, false );
+  const LabelMapType * labelMap = valuator->GetOutput();
+
+  // merge the objects by pairs
+  typedef itk::ChangeLabelLabelMapFilter< LabelMapType > ChangeType;
+  ChangeType::Pointer change = ChangeType::New();
+  change->SetInput( labelMap );
+  change->SetInPlace( false );
+  std::map< PixelType, unsigned int > numberOfMergedObjects;
+  const LabelMapType::LabelObjectContainerType & labelObjectContainer = labelMap->GetLabelObjectContainer();
+  for( LabelMapType::LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+    it != labelObjectContainer.end();
+    it++ )
+    {
+    const PixelType label = ( it->first + 1 ) / 2;
+    change->SetChange( it->first, label );
+    numberOfMergedObjects[ label ]++;
+    }
+  itk::SimpleFilterWatcher watcher(change, "filter");
+  change->Update();
+  const LabelMapType * merged = change->GetOutput();
+
+  // the reference: the merged objects valuated from scratch
+  typedef itk::LabelMapToLabelImageFilter< LabelMapType, ImageType > L2IType;
+  L2IType::Pointer l2i = L2IType::New();
+  l2i->SetInput( merged );
+  ConverterType::Pointer converter2 = ConverterType::New();
+  converter2->SetInput( l2i->GetOutput() );
+  converter2->SetBackgroundValue( 0 );
+  converter2->Update();
+  ValuatorType::Pointer reference = Valuate( converter2->GetOutput(), feature, false );
+
+  // and the merged objects valuated again, only where needed
+  ValuatorType::Pointer revaluator = Valuate( merged, feature, true );
+
+  bool ok = true;
+  const LabelMapType::LabelObjectContainerType & referenceContainer = reference->GetOutput()->GetLabelObjectContainer();
+  ok = check( "number of objects", 0, merged->GetNumberOfLabelObjects(), referenceContainer.size() ) && ok;
+  for( LabelMapType::LabelObjectContainerType::const_iterator it = referenceContainer.begin();
+    it != referenceContainer.end();
+    it++ )
+    {
+    const LabelObjectType * ref = it->second;
+    const LabelObjectType * lo = merged->GetLabelObject( it->first );
+    ok = Compare( lo, ref, numberOfMergedObjects[ it->first ] == 1 ) && ok;
+    if( numberOfMergedObjects[ it->first ] > 1 )
+      {
+      ok = CheckInvalidated( lo ) && ok;
+      }
+    ok = Compare( revaluator->GetOutput()->GetLabelObject( it->first ), ref, true ) && ok;
+    }
+
+  // aggregate the label map with itself: all the objects overlap, so none of
+  // their statistics can be kept
+  typedef itk::MergeLabelMapFilter< LabelMapType > MergeType;
+  MergeType::Pointer merge = MergeType::New();
+  merge->SetInput( labelMap );
+  merge->SetInput( 1, labelMap );
+  merge->SetInPlace( false );
+  merge->SetMethod( MergeType::AGGREGATE );
+  merge->Update();
+  ValuatorType::Pointer revaluator2 = Valuate( merge->GetOutput(), feature, true );
+
+  for( LabelMapType::LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+    it != labelObjectContainer.end();
+    it++ )
+    {
+    const LabelObjectType * lo = merge->GetOutput()->GetLabelObject( it->first );
+    ok = CheckInvalidated( lo ) && ok;
+    bool thrown = false;
+    try { lo->GetMean(); } catch( itk::ExceptionObject & ) { thrown = true; }
+    ok = checkThrow( "mean", it->first, thrown ) && ok;
+    if( lo->GetHistogram() != NULL )
+      {
+      std::cerr << "label " << (int)it->first << ": histogram should not be available" << std::endl;
+      ok = false;
+      }
+    ok = Compare( revaluator2->GetOutput()->GetLabelObject( it->first ), it->second, true ) && ok;
+    }
+
+  if( !ok )
+    {
+    return 1;
+    }
+  return 0;
+}
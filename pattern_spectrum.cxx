@@ -0,0 +1,114 @@
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkSimpleFilterWatcher.h"
+#include "itkShapeLabelObject.h"
+#include "itkLabelMap.h"
+#include "itkBinaryImageToShapeLabelMapFilter.h"
+#include "itkLabelMapPatternSpectrumImageFilter.h"
+
+int main(int argc, char * argv[])
+{
+  const int dim = 2;
+  typedef unsigned char PixelType;
+  typedef itk::Image< PixelType, dim >    ImageType;
+
+  if( argc < 6 || argc % 2 != 0 )
+    {
+    std::cerr << "usage: " << argv[0] << " input foreground background reverseOrdering connectivity [lambda output]..." << std::endl;
+    // std::cerr << "  : " << std::endl;
+    exit(1);
+    }
+
+  // read the input image
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+  reader->Update();
+  const PixelType foreground = atoi(argv[2]);
+  const PixelType background = atoi(argv[3]);
+
+  // label and valuate the image only once
+  typedef unsigned long LabelType;
+  typedef itk::ShapeLabelObject< LabelType, dim > LabelObjectType;
+  typedef itk::LabelMap< LabelObjectType > LabelMapType;
+
+  typedef itk::BinaryImageToShapeLabelMapFilter< ImageType, LabelMapType > ConverterType;
+  ConverterType::Pointer converter = ConverterType::New();
+  converter->SetInput( reader->GetOutput() );
+  converter->SetInputForegroundValue( foreground );
+  converter->SetFullyConnected( atoi(argv[5]) );
+
+  // compute the size distribution, and the openings for all the lambdas given
+  typedef itk::Image< unsigned short, dim > LabelImageType;
+  typedef itk::LabelMapPatternSpectrumImageFilter< LabelMapType, LabelImageType,
+    itk::Functor::SizeLabelObjectAccessor< LabelObjectType > > SpectrumType;
+  SpectrumType::Pointer spectrum = SpectrumType::New();
+  spectrum->SetInput( converter->GetOutput() );
+  spectrum->SetBackgroundValue( 0 );
+  spectrum->SetReverseOrdering( atoi(argv[4]) );
+  SpectrumType::LambdasType lambdas;
+  for( int i=6; i<argc; i+=2 )
+    {
+    lambdas.push_back( atoi(argv[i]) );
+    }
+  spectrum->SetLambdas( lambdas );
+  itk::SimpleFilterWatcher watcher(spectrum, "filter");
+  spectrum->Update();
+
+  const SpectrumType::PatternSpectrumType & ps = spectrum->GetPatternSpectrum();
+  for( unsigned int i=0; i<ps.size(); i++ )
+    {
+    std::cout << ps[i].first << "\t" << ps[i].second << "\t" << spectrum->GetRemovedSize( ps[i].first + 1 ) << std::endl;
+    }
+
+  // write the openings as BinaryShapeOpeningImageFilter does: the pixels of the
+  // removed objects are set to the background value, and the other ones are copied
+  // from the input. The number of pixels removed must be the one given by the
+  // pattern spectrum.
+  int errors = 0;
+  typedef itk::ImageFileWriter< ImageType > WriterType;
+  for( unsigned int i=0; i<lambdas.size(); i++ )
+    {
+    ImageType::Pointer opening = ImageType::New();
+    opening->CopyInformation( reader->GetOutput() );
+    opening->SetRegions( reader->GetOutput()->GetLargestPossibleRegion() );
+    opening->Allocate();
+
+    unsigned long removed = 0;
+    itk::ImageRegionConstIterator< ImageType > iit( reader->GetOutput(), reader->GetOutput()->GetLargestPossibleRegion() );
+    itk::ImageRegionConstIterator< LabelImageType > lit( spectrum->GetOutput( i ), spectrum->GetOutput( i )->GetLargestPossibleRegion() );
+    itk::ImageRegionIterator< ImageType > oit( opening, opening->GetLargestPossibleRegion() );
+    for( iit.GoToBegin(), lit.GoToBegin(), oit.GoToBegin(); !iit.IsAtEnd(); ++iit, ++lit, ++oit )
+      {
+      if( iit.Get() == foreground && lit.Get() == 0 )
+        {
+        oit.Set( background );
+        removed++;
+        }
+      else
+        {
+        oit.Set( iit.Get() );
+        }
+      }
+
+    if( removed != spectrum->GetRemovedSize( lambdas[i] ) )
+      {
+      std::cerr << "lambda " << lambdas[i] << ": " << removed << " pixels removed, but "
+                << spectrum->GetRemovedSize( lambdas[i] ) << " in the pattern spectrum" << std::endl;
+      errors++;
+      }
+
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetInput( opening );
+    writer->SetFileName( argv[7+2*i] );
+    writer->Update();
+    }
+
+  if( errors != 0 )
+    {
+    return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,216 @@
+#include "itkPrincipalMomentsCalculator.h"
+#include "vnl/vnl_math.h"
+#include "vnl/vnl_random.h"
+#include "vnl/algo/vnl_symmetric_eigensystem.h"
+#include "vnl/algo/vnl_determinant.h"
+#include <iostream>
+
+// compare the principal moments and axes with the ones of vnl_symmetric_eigensystem.
+// The moments must be the same and in the same order. The axes may only differ by
+// their sign, or by the choice of a basis for the repeated moments, so the spaces
+// spanned by the axes of each distinct moment are compared instead of the axes.
+template< unsigned int VDimension >
+bool CheckPrincipalMoments( const char * name, const itk::Matrix< double, VDimension, VDimension > & moments )
+{
+  typedef itk::PrincipalMomentsCalculator< VDimension > CalculatorType;
+  typename CalculatorType::VectorType principalMoments;
+  typename CalculatorType::MatrixType principalAxes;
+  CalculatorType::Compute( moments, principalMoments, principalAxes );
+
+  vnl_symmetric_eigensystem< double > eigen( moments.GetVnlMatrix() );
+
+  double scale = 1e-300;
+  for( unsigned int i=0; i<VDimension; i++ )
+    {
+    for( unsigned int j=0; j<VDimension; j++ )
+      {
+      scale = std::max( scale, vnl_math_abs( moments[i][j] ) );
+      }
+    }
+  const double tolerance = 1e-9 * scale;
+
+  bool ok = true;
+  for( unsigned int i=0; i<VDimension; i++ )
+    {
+    if( vnl_math_abs( principalMoments[i] - eigen.D(i, i) ) > tolerance )
+      {
+      std::cerr << name << ": principal moment " << i << " is " << principalMoments[i]
+                << " instead of " << eigen.D(i, i) << std::endl;
+      ok = false;
+      }
+    }
+
+  unsigned int begin = 0;
+  while( begin < VDimension )
+    {
+    // the moments equal to the one at begin
+    unsigned int end = begin + 1;
+    while( end < VDimension && eigen.D(end, end) - eigen.D(end - 1, end - 1) <= 10 * tolerance )
+      {
+      end++;
+      }
+    // compare the projections on the spaces spanned by their axes
+    for( unsigned int r=0; r<VDimension; r++ )
+      {
+      for( unsigned int c=0; c<VDimension; c++ )
+        {
+        double p = 0;
+        double q = 0;
+        for( unsigned int k=begin; k<end; k++ )
+          {
+          p += principalAxes[k][r] * principalAxes[k][c];
+          q += eigen.V(r, k) * eigen.V(c, k);
+          }
+        if( vnl_math_abs( p - q ) > 1e-6 )
+          {
+          std::cerr << name << ": the principal axes " << begin << " to " << end - 1
+                    << " don't span the same space as the eigen vectors" << std::endl;
+          ok = false;
+          r = c = VDimension;
+          }
+        }
+      }
+    begin = end;
+    }
+
+  const double det = vnl_determinant( principalAxes.GetVnlMatrix() );
+  if( vnl_math_abs( det - 1 ) > 1e-9 )
+    {
+    std::cerr << name << ": the determinant of the principal axes is " << det << std::endl;
+    ok = false;
+    }
+
+  return ok;
+}
+
+// a symmetric matrix with the given eigen values, in a random basis
+template< unsigned int VDimension >
+itk::Matrix< double, VDimension, VDimension > RotatedDiagonal( vnl_random & random, const double * values )
+{
+  double q[VDimension][VDimension];
+  for( unsigned int i=0; i<VDimension; i++ )
+    {
+    for( unsigned int j=0; j<VDimension; j++ )
+      {
+      q[i][j] = random.normal();
+      }
+    // make it orthogonal to the previous rows
+    for( unsigned int k=0; k<i; k++ )
+      {
+      double dot = 0;
+      for( unsigned int j=0; j<VDimension; j++ )
+        {
+        dot += q[i][j] * q[k][j];
+        }
+      for( unsigned int j=0; j<VDimension; j++ )
+        {
+        q[i][j] -= dot * q[k][j];
+        }
+      }
+    double norm = 0;
+    for( unsigned int j=0; j<VDimension; j++ )
+      {
+      norm += q[i][j] * q[i][j];
+      }
+    norm = vcl_sqrt( norm );
+    for( unsigned int j=0; j<VDimension; j++ )
+      {
+      q[i][j] /= norm;
+      }
+    }
+
+  itk::Matrix< double, VDimension, VDimension > m;
+  for( unsigned int i=0; i<VDimension; i++ )
+    {
+    for( unsigned int j=0; j<VDimension; j++ )
+      {
+      m[i][j] = 0;
+      for( unsigned int k=0; k<VDimension; k++ )
+        {
+        m[i][j] += q[k][i] * values[k] * q[k][j];
+        }
+      }
+    }
+  return m;
+}
+
+template< unsigned int VDimension >
+bool CheckDimension( vnl_random & random )
+{
+  typedef itk::Matrix< double, VDimension, VDimension > MatrixType;
+  bool ok = true;
+
+  for( unsigned int t=0; t<1000; t++ )
+    {
+    // random symmetric matrix
+    MatrixType m;
+    for( unsigned int i=0; i<VDimension; i++ )
+      {
+      for( unsigned int j=i; j<VDimension; j++ )
+        {
+        m[i][j] = m[j][i] = random.normal();
+        }
+      }
+    ok = CheckPrincipalMoments< VDimension >( "random", m ) && ok;
+
+    // diagonal matrix, not sorted
+    MatrixType d;
+    d.Fill( 0 );
+    for( unsigned int i=0; i<VDimension; i++ )
+      {
+      d[i][i] = random.normal();
+      }
+    ok = CheckPrincipalMoments< VDimension >( "diagonal", d ) && ok;
+
+    // repeated eigen values: the first ones, the last ones, and all of them
+    double values[VDimension];
+    for( unsigned int i=0; i<VDimension; i++ )
+      {
+      values[i] = random.normal();
+      }
+    values[1] = values[0];
+    ok = CheckPrincipalMoments< VDimension >( "repeated first", RotatedDiagonal< VDimension >( random, values ) ) && ok;
+    for( unsigned int i=0; i<VDimension; i++ )
+      {
+      values[i] = random.normal();
+      }
+    values[VDimension - 2] = values[VDimension - 1];
+    ok = CheckPrincipalMoments< VDimension >( "repeated last", RotatedDiagonal< VDimension >( random, values ) ) && ok;
+    for( unsigned int i=0; i<VDimension; i++ )
+      {
+      values[i] = values[0];
+      }
+    ok = CheckPrincipalMoments< VDimension >( "isotropic", RotatedDiagonal< VDimension >( random, values ) ) && ok;
+
+    // rank deficient: a line, a plane, and a point
+    for( unsigned int i=0; i<VDimension; i++ )
+      {
+      values[i] = 0;
+      }
+    values[0] = vnl_math_abs( random.normal() );
+    ok = CheckPrincipalMoments< VDimension >( "line", RotatedDiagonal< VDimension >( random, values ) ) && ok;
+    values[1] = vnl_math_abs( random.normal() );
+    ok = CheckPrincipalMoments< VDimension >( "plane", RotatedDiagonal< VDimension >( random, values ) ) && ok;
+    MatrixType z;
+    z.Fill( 0 );
+    ok = CheckPrincipalMoments< VDimension >( "point", z ) && ok;
+    }
+
+  return ok;
+}
+
+int main(int, char * [])
+{
+  vnl_random random( 1234 );
+
+  bool ok = CheckDimension< 2 >( random );
+  ok = CheckDimension< 3 >( random ) && ok;
+  // the generic implementation
+  ok = CheckDimension< 4 >( random ) && ok;
+
+  if( !ok )
+    {
+    return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,161 @@
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkSimpleFilterWatcher.h"
+#include "itkRGBPixel.h"
+#include "itkLabelMap.h"
+#include "itkVectorStatisticsLabelObject.h"
+#include "itkStatisticsLabelObject.h"
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkVectorStatisticsLabelMapFilter.h"
+#include "itkStatisticsLabelMapFilter.h"
+
+bool check( const char * name, unsigned long label, unsigned int c, double value, double expected )
+{
+  if( vnl_math_abs( value - expected ) > 1e-6 * std::max( 1.0, vnl_math_abs( expected ) ) )
+    {
+    std::cerr << "label " << label << ", channel " << c << ": " << name << " is " << value
+              << " instead of " << expected << std::endl;
+    return false;
+    }
+  return true;
+}
+
+int main(int argc, char * argv[])
+{
+  const int dim = 2;
+  typedef unsigned char PixelType;
+  typedef itk::Image< PixelType, dim >    ImageType;
+  typedef itk::RGBPixel< unsigned char > RGBPixelType;
+  typedef itk::Image< RGBPixelType, dim > RGBImageType;
+
+  if( argc != 4)
+    {
+    std::cerr << "usage: " << argv[0] << " input featureImg background" << std::endl;
+    // std::cerr << "  : " << std::endl;
+    exit(1);
+    }
+
+  // read the input image
+  typedef itk::ImageFileReader< ImageType > ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName( argv[1] );
+
+  typedef itk::ImageFileReader< RGBImageType > RGBReaderType;
+  RGBReaderType::Pointer reader2 = RGBReaderType::New();
+  reader2->SetFileName( argv[2] );
+  reader2->Update();
+
+  // convert the image in a collection of objects
+  typedef itk::VectorStatisticsLabelObject< PixelType, dim > LabelObjectType;
+  typedef itk::LabelMap< LabelObjectType > LabelMapType;
+  typedef itk::LabelImageToLabelMapFilter< ImageType, LabelMapType > ConverterType;
+  ConverterType::Pointer converter = ConverterType::New();
+  converter->SetInput( reader->GetOutput() );
+  converter->SetBackgroundValue( atoi(argv[3]) );
+
+  // and valuate the statistics of the three channels in a single pass
+  typedef itk::VectorStatisticsLabelMapFilter< LabelMapType, RGBImageType > ValuatorType;
+  ValuatorType::Pointer valuator = ValuatorType::New();
+  valuator->SetInput( converter->GetOutput() );
+  valuator->SetFeatureImage( reader2->GetOutput() );
+  itk::SimpleFilterWatcher watcher(valuator, "filter");
+
+  valuator->Update();
+
+  valuator->GetOutput()->PrintLabelObjects();
+
+  // the statistics of each channel must be the ones computed on that channel
+  // alone by the scalar valuator
+  typedef itk::StatisticsLabelObject< PixelType, dim > ScalarLabelObjectType;
+  typedef itk::LabelMap< ScalarLabelObjectType > ScalarLabelMapType;
+  typedef itk::LabelImageToLabelMapFilter< ImageType, ScalarLabelMapType > ScalarConverterType;
+  typedef itk::StatisticsLabelMapFilter< ScalarLabelMapType, ImageType > ScalarValuatorType;
+
+  const RGBImageType * feature = reader2->GetOutput();
+  const LabelMapType * labelMap = valuator->GetOutput();
+  const unsigned int numberOfChannels = 3;
+  bool ok = true;
+
+  for( unsigned int c=0; c<numberOfChannels; c++ )
+    {
+    ImageType::Pointer channel = ImageType::New();
+    channel->CopyInformation( feature );
+    channel->SetRegions( feature->GetLargestPossibleRegion() );
+    channel->Allocate();
+    itk::ImageRegionConstIterator< RGBImageType > fit( feature, feature->GetLargestPossibleRegion() );
+    itk::ImageRegionIterator< ImageType > cit( channel, channel->GetLargestPossibleRegion() );
+    for( fit.GoToBegin(), cit.GoToBegin(); !fit.IsAtEnd(); ++fit, ++cit )
+      {
+      cit.Set( fit.Get()[c] );
+      }
+
+    ScalarConverterType::Pointer scalarConverter = ScalarConverterType::New();
+    scalarConverter->SetInput( reader->GetOutput() );
+    scalarConverter->SetBackgroundValue( atoi(argv[3]) );
+    ScalarValuatorType::Pointer scalarValuator = ScalarValuatorType::New();
+    scalarValuator->SetInput( scalarConverter->GetOutput() );
+    scalarValuator->SetFeatureImage( channel );
+    scalarValuator->Update();
+
+    const LabelMapType::LabelObjectContainerType & labelObjectContainer = labelMap->GetLabelObjectContainer();
+    for( LabelMapType::LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+      it != labelObjectContainer.end();
+      it++ )
+      {
+      const unsigned long label = it->first;
+      const LabelObjectType * lo = it->second;
+      const ScalarLabelObjectType * slo = scalarValuator->GetOutput()->GetLabelObject( it->first );
+      ok = check( "minimum", label, c, lo->GetChannelMinimum()[c], slo->GetMinimum() ) && ok;
+      ok = check( "maximum", label, c, lo->GetChannelMaximum()[c], slo->GetMaximum() ) && ok;
+      ok = check( "sum", label, c, lo->GetChannelSum()[c], slo->GetSum() ) && ok;
+      ok = check( "mean", label, c, lo->GetChannelMean()[c], slo->GetMean() ) && ok;
+      if( lo->Size() > 1 )
+        {
+        ok = check( "sigma", label, c, lo->GetChannelSigma()[c], slo->GetSigma() ) && ok;
+        ok = check( "variance", label, c, lo->GetChannelVariance()[c], slo->GetVariance() ) && ok;
+        ok = check( "covariance", label, c, lo->GetChannelCovariance()( c, c ), slo->GetVariance() ) && ok;
+        }
+      }
+    }
+
+  // the covariance of the different channels, computed on the pixels of the objects
+  const LabelMapType::LabelObjectContainerType & labelObjectContainer = labelMap->GetLabelObjectContainer();
+  for( LabelMapType::LabelObjectContainerType::const_iterator it = labelObjectContainer.begin();
+    it != labelObjectContainer.end();
+    it++ )
+    {
+    const LabelObjectType * lo = it->second;
+    const double n = lo->Size();
+    if( n < 2 )
+      {
+      continue;
+      }
+    for( unsigned int c=0; c<numberOfChannels; c++ )
+      {
+      for( unsigned int e=c+1; e<numberOfChannels; e++ )
+        {
+        double sum = 0;
+        const LabelObjectType::LineContainerType & lineContainer = lo->GetLineContainer();
+        for( LabelObjectType::LineContainerType::const_iterator lit = lineContainer.begin(); lit != lineContainer.end(); lit++ )
+          {
+          LabelObjectType::IndexType idx = lit->GetIndex();
+          for( unsigned long i=0; i<lit->GetLength(); i++ )
+            {
+            const RGBPixelType & p = feature->GetPixel( idx );
+            sum += ( p[c] - lo->GetChannelMean()[c] ) * ( p[e] - lo->GetChannelMean()[e] );
+            idx[0]++;
+            }
+          }
+        ok = check( "covariance with the next channels", it->first, c, lo->GetChannelCovariance()( c, e ), sum / ( n - 1 ) ) && ok;
+        ok = check( "covariance with the previous channels", it->first, e, lo->GetChannelCovariance()( e, c ), sum / ( n - 1 ) ) && ok;
+        }
+      }
+    }
+
+  if( !ok )
+    {
+    return 1;
+    }
+  return 0;
+}